@@ -70,6 +70,10 @@ class AutoGain : public PluginBase {
   double loudness = 0.0;
 
  private:
+  void pack_meters(std::span<double> values) override;
+
+  void emit_meters(std::span<const double> values) override;
+
   bool ebur128_ready = false;
 
   uint old_rate = 0U;
@@ -47,4 +47,11 @@ class BassEnhancer : public PluginBase {
   double harmonics_port_value = 0.0;
 
  private:
+  // control port indices resolved in the constructor
+  uint meter_drive_port = lv2::Lv2Wrapper::invalid_port_index;
+
+  void pack_meters(std::span<double> values) override;
+
+  void emit_meters(std::span<const double> values) override;
+
 };
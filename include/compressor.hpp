@@ -54,8 +54,23 @@ class Compressor : public PluginBase {
   float envelope_port_value = 0.0F;
 
  private:
+  void pack_meters(std::span<double> values) override;
+
+  void emit_meters(std::span<const double> values) override;
+
   uint latency_n_frames = 0U;
 
+  // control port indices resolved in the constructor
+  uint out_latency_port = lv2::Lv2Wrapper::invalid_port_index;
+  uint rlm_l_port = lv2::Lv2Wrapper::invalid_port_index;
+  uint rlm_r_port = lv2::Lv2Wrapper::invalid_port_index;
+  uint slm_l_port = lv2::Lv2Wrapper::invalid_port_index;
+  uint slm_r_port = lv2::Lv2Wrapper::invalid_port_index;
+  uint clm_l_port = lv2::Lv2Wrapper::invalid_port_index;
+  uint clm_r_port = lv2::Lv2Wrapper::invalid_port_index;
+  uint elm_l_port = lv2::Lv2Wrapper::invalid_port_index;
+  uint elm_r_port = lv2::Lv2Wrapper::invalid_port_index;
+
   std::vector<pw_proxy*> list_proxies;
 
   void update_sidechain_links(const std::string& key);
@@ -19,8 +19,11 @@
 
 #pragma once
 
-#include <zita-convolver.h>
-#include <deque>
+#include <condition_variable>
+#include <numbers>
+#include <thread>
+#include "ir_cache.hpp"
+#include "partitioned_convolver.hpp"
 #include "plugin_base.hpp"
 
 class Convolver : public PluginBase {
@@ -44,63 +47,93 @@ class Convolver : public PluginBase {
 
   auto get_latency_seconds() -> float override;
 
-  bool do_autogain = false;
+  [[nodiscard]] auto is_silence_stable() const -> bool override;
+
+  auto get_tail_seconds() -> float override;
+
+  void wait_for_setup() override;
+
+  void dispatch_notifications() override;
+
+  std::atomic<bool> do_autogain = false;
+
+  // kernel size before and after the trimming. Read by the interface
+
+  std::atomic<uint> original_taps = 0U, used_taps = 0U;
+
+  sigc::signal<void(const uint original_taps, const uint used_taps)> kernel_taps;
 
  private:
-  bool kernel_is_initialized = false;
-  bool n_samples_is_power_of_2 = true;
-  bool zita_ready = false;
-  bool ready = false;
-  bool notify_latency = false;
+  std::atomic<bool> trim_ir = false;
+  std::atomic<bool> minimum_phase = false;
+  std::atomic<bool> kernel_taps_changed = false;
+
+  std::atomic<float> trim_threshold = -80.0F;
+
+  std::atomic<uint> ir_width = 100U;
+  std::atomic<uint> kernel_rate = 0U;  // rate of the last engine handed over
+  uint tail_n_frames = 0U;
+  uint crossfade_n_frames = 0U;
+  uint crossfade_position = 0U;
+
+  static constexpr float crossfade_ms = 50.0F;
 
-  uint blocksize = 512U;
-  uint ir_width = 100U;
-  uint latency_n_frames = 0U;
+  std::shared_ptr<const ir_cache::Kernel> original_kernel;  // before the width and the autogain are applied
 
   std::vector<float> kernel_L, kernel_R;
-  std::vector<float> original_kernel_L, original_kernel_R;
-  std::vector<float> data_L, data_R;
+  std::vector<float> fading_L, fading_R;
 
-  std::deque<float> deque_out_L, deque_out_R;
+  /*
+    New engines are built by worker threads and handed over to the realtime thread through incoming. It adopts them at
+    the start of process() and the previous one keeps running in fading_engine during the crossfade. Then it goes back
+    through outgoing to be deleted by a worker. So process() never waits for a lock or frees memory. An engine without
+    a kernel passes the input through. engine and fading_engine are only touched by the realtime thread.
+  */
 
-  Convproc* conv = nullptr;
+  std::unique_ptr<PartitionedConvolver> engine, fading_engine;
 
-  std::vector<std::thread> mythreads;
+  std::atomic<PartitionedConvolver*> incoming = nullptr, outgoing = nullptr;
 
-  void read_kernel_file();
+  std::atomic<bool> crossfading = false;
+
+  std::atomic<uint> kernel_request = 0U, installed_request = 0U;
+
+  /*
+    A single worker builds the engines during the whole life of the plugin. prepare_kernel() stores the request under
+    worker_mutex and wakes it up through worker_cv.
+  */
+
+  std::thread kernel_worker;
+
+  std::mutex worker_mutex;
+
+  std::condition_variable worker_cv;
+
+  bool worker_running = true;
+
+  std::string requested_path;
+
+  uint requested_rate = 0U;
+
+  void clear_state() override;
 
   void apply_kernel_autogain();
 
   void set_kernel_stereo_width();
 
-  void setup_zita();
+  void make_kernel_minimum_phase();
 
-  auto get_zita_buffer_size() -> uint;
+  void trim_kernel();
 
   void prepare_kernel();
 
-  template <typename T1>
-  void do_convolution(T1& data_left, T1& data_right) {
-    std::span conv_left_in(conv->inpdata(0), get_zita_buffer_size());
-    std::span conv_right_in(conv->inpdata(1), get_zita_buffer_size());
-
-    std::span conv_left_out(conv->outdata(0), get_zita_buffer_size());
-    std::span conv_right_out(conv->outdata(1), get_zita_buffer_size());
+  void kernel_worker_loop();
 
-    std::copy(data_left.begin(), data_left.end(), conv_left_in.begin());
-    std::copy(data_right.begin(), data_right.end(), conv_right_in.begin());
+  void build_engine(const uint& request, const std::string& path, const uint& target_rate);
 
-    if (zita_ready) {
-      const int& ret = conv->process(true);  // thread sync mode set to true
+  void hand_over_engine(std::unique_ptr<PartitionedConvolver> new_engine, const uint& request, const uint& target_rate);
 
-      if (ret != 0) {
-        util::debug(log_tag + "IR: process failed: " + util::to_string(ret, ""));
+  void adopt_engine();
 
-        zita_ready = false;
-      } else {
-        std::copy(conv_left_out.begin(), conv_left_out.end(), data_left.begin());
-        std::copy(conv_right_out.begin(), conv_right_out.end(), data_right.begin());
-      }
-    }
-  }
+  void crossfade(std::span<float>& left, std::span<float>& right);
 };
@@ -19,11 +19,11 @@
 
 #pragma once
 
-#include <deque>
 #include "fir_filter_bandpass.hpp"
 #include "fir_filter_highpass.hpp"
 #include "fir_filter_lowpass.hpp"
 #include "plugin_base.hpp"
+#include "stereo_ring.hpp"
 
 class Crystalizer : public PluginBase {
  public:
@@ -48,6 +48,12 @@ class Crystalizer : public PluginBase {
 
   auto get_latency_seconds() -> float override;
 
+  [[nodiscard]] auto is_silence_stable() const -> bool override;
+
+  auto get_tail_seconds() -> float override;
+
+  [[nodiscard]] auto needs_power_of_2_blocks() const -> bool override;
+
  private:
   bool n_samples_is_power_of_2 = true;
   bool filters_are_ready = false;
@@ -56,9 +62,18 @@ class Crystalizer : public PluginBase {
 
   uint blocksize = 512U;
   uint latency_n_frames = 0U;
+  uint tail_n_frames = 0U;
 
   static constexpr uint nbands = 13U;
 
+  struct Params {
+    std::array<bool, nbands> band_mute{};
+    std::array<bool, nbands> band_bypass{};
+    std::array<float, nbands> band_intensity{};
+  };
+
+  ParameterSnapshot<Params> params;
+
   std::vector<float> data_L;
   std::vector<float> data_R;
 
@@ -80,7 +95,7 @@ class Crystalizer : public PluginBase {
 
   std::array<std::unique_ptr<FirFilterBase>, nbands> filters;
 
-  std::deque<float> deque_out_L, deque_out_R;
+  StereoRing input_ring, output_ring;
 
   void bind_band(const int& n);
 
@@ -37,6 +37,8 @@ class DeepFilterNet : public PluginBase {
 
   void setup() override;
 
+  void reset() override;
+
   void process(std::span<float>& left_in,
                std::span<float>& right_in,
                std::span<float>& left_out,
@@ -44,7 +46,22 @@ class DeepFilterNet : public PluginBase {
 
   auto get_latency_seconds() -> float override;
 
+  [[nodiscard]] auto is_silence_stable() const -> bool override;
+
+  auto get_tail_seconds() -> float override;
+
  private:
+  /*
+    The model of libdeep_filter_ladspa runs at 48 kHz on hops of 10 ms. Its output is delayed by a lookahead of 2 hops
+    and each frame is filtered with the deep filter coefficients of the last 5 frames, the lookahead ones included.
+  */
+
+  static constexpr float model_hop_seconds = 0.01F;
+
+  static constexpr float model_lookahead_hops = 2.0F;
+
+  static constexpr float model_df_order = 5.0F;
+
   std::unique_ptr<ladspa::LadspaWrapper> ladspa_wrapper;
 
   bool resample = false;
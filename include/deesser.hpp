@@ -45,4 +45,12 @@ class Deesser : public PluginBase {
   double detected_port_value = 0.0;
 
  private:
+  // control port indices resolved in the constructor
+  uint detected_port = lv2::Lv2Wrapper::invalid_port_index;
+  uint compression_port = lv2::Lv2Wrapper::invalid_port_index;
+
+  void pack_meters(std::span<double> values) override;
+
+  void emit_meters(std::span<const double> values) override;
+
 };
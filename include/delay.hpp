@@ -41,4 +41,7 @@ class Delay : public PluginBase {
 
  private:
   uint latency_n_frames = 0U;
+
+  // control port indices resolved in the constructor
+  uint out_latency_port = lv2::Lv2Wrapper::invalid_port_index;
 };
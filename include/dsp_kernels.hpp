@@ -0,0 +1,68 @@
+/*
+ *  Copyright © 2017-2023 Wellington Wallace
+ *
+ *  This file is part of Easy Effects.
+ *
+ *  Easy Effects is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Easy Effects is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Easy Effects. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <complex>
+#include <cstdint>
+#include <span>
+
+/*
+  Small loops that run on every plugin for every quantum. The implementation is chosen when the program starts: AVX2
+  when the cpu has it, otherwise SSE2 on x86 and NEON on aarch64. There is a plain C++ fallback for other machines.
+  When the spans have different sizes only what fits in the smallest one is processed.
+*/
+
+namespace dsp {
+
+// largest absolute value
+
+auto abs_peak(std::span<const float> data) -> float;
+
+void apply_gain(std::span<float> data, const float& gain);
+
+// multiplies by gain and returns the largest absolute value of the result
+
+auto apply_gain_abs_peak(std::span<float> data, const float& gain) -> float;
+
+void interleave(std::span<const float> left, std::span<const float> right, std::span<float> output);
+
+void deinterleave(std::span<const float> input, std::span<float> left, std::span<float> right);
+
+// [-1, 1) is mapped to [-32768, 32767]. Values outside of this range are saturated
+
+void float_to_s16(std::span<const float> input, std::span<int16_t> output);
+
+void s16_to_float(std::span<const int16_t> input, std::span<float> output);
+
+// acc += a * b for each complex value. Used by the spectral convolutions
+
+void complex_multiply_accumulate(std::span<const std::complex<float>> a,
+                                 std::span<const std::complex<float>> b,
+                                 std::span<std::complex<float>> acc);
+
+// sum of a[n] * b[n]
+
+auto dot(std::span<const float> a, std::span<const float> b) -> float;
+
+// name of the instruction set being used. Just for the logs
+
+auto instruction_set() -> const char*;
+
+}  // namespace dsp
@@ -0,0 +1,197 @@
+/*
+ *  Copyright © 2017-2023 Wellington Wallace
+ *
+ *  This file is part of Easy Effects.
+ *
+ *  Easy Effects is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Easy Effects is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Easy Effects. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cstdint>
+#include <mutex>
+
+/*
+  Time spent by a plugin in its process() calls. It is written only by the realtime thread that runs the plugin and
+  read by the main thread. The durations go to a histogram of microseconds with 8 buckets per octave. So the
+  percentiles are known within 12.5%.
+*/
+
+class DspLoad {
+ public:
+  struct Stats {
+    uint64_t count = 0U;
+    uint64_t overruns = 0U;
+
+    // microseconds
+
+    double mean = 0.0;
+    double p99 = 0.0;
+    double max = 0.0;
+
+    double load = 0.0;  // percentage of the quantum duration used on average
+  };
+
+  void record(const uint64_t& elapsed_ns, const uint64_t& budget_ns) {
+    histogram[bucket(elapsed_ns / 1000U)].fetch_add(1U, std::memory_order_relaxed);
+
+    count.fetch_add(1U, std::memory_order_relaxed);
+    sum_ns.fetch_add(elapsed_ns, std::memory_order_relaxed);
+    budget_sum_ns.fetch_add(budget_ns, std::memory_order_relaxed);
+
+    if (elapsed_ns > max_ns.load(std::memory_order_relaxed)) {
+      max_ns.store(elapsed_ns, std::memory_order_relaxed);
+    }
+  }
+
+  void count_overrun() { overruns.fetch_add(1U, std::memory_order_relaxed); }
+
+  void reset() {
+    for (auto& b : histogram) {
+      b.store(0U, std::memory_order_relaxed);
+    }
+
+    count = 0U;
+    overruns = 0U;
+    sum_ns = 0U;
+    budget_sum_ns = 0U;
+    max_ns = 0U;
+  }
+
+  [[nodiscard]] auto stats() const -> Stats {
+    Stats s;
+
+    s.count = count.load(std::memory_order_relaxed);
+    s.overruns = overruns.load(std::memory_order_relaxed);
+
+    if (s.count == 0U) {
+      return s;
+    }
+
+    const auto sum = static_cast<double>(sum_ns.load(std::memory_order_relaxed));
+    const auto budget = static_cast<double>(budget_sum_ns.load(std::memory_order_relaxed));
+
+    s.mean = 0.001 * sum / static_cast<double>(s.count);
+    s.max = 0.001 * static_cast<double>(max_ns.load(std::memory_order_relaxed));
+    s.load = (budget > 0.0) ? 100.0 * sum / budget : 0.0;
+
+    // the upper bound of the bucket holding the 99th percentile. The buckets may be ahead of count by a few records
+
+    uint64_t total = 0U;
+
+    for (const auto& b : histogram) {
+      total += b.load(std::memory_order_relaxed);
+    }
+
+    const auto target = total - total / 100U;
+
+    uint64_t cumulative = 0U;
+
+    for (size_t n = 0U; n < histogram.size(); n++) {
+      cumulative += histogram[n].load(std::memory_order_relaxed);
+
+      if (cumulative >= target) {
+        s.p99 = std::min(static_cast<double>(lower_bound(n + 1U)), s.max);
+
+        break;
+      }
+    }
+
+    return s;
+  }
+
+ private:
+  static constexpr size_t n_buckets = 8U * 24U;
+
+  std::array<std::atomic<uint64_t>, n_buckets> histogram{};
+
+  std::atomic<uint64_t> count = 0U, overruns = 0U, sum_ns = 0U, budget_sum_ns = 0U, max_ns = 0U;
+
+  // values below 8 us have a bucket each. Above that each octave is split in 8 buckets
+
+  static auto bucket(const uint64_t& us) -> size_t {
+    if (us < 8U) {
+      return us;
+    }
+
+    const auto octave = static_cast<size_t>(std::bit_width(us)) - 1U;
+
+    const auto sub = static_cast<size_t>((us >> (octave - 3U)) & 7U);
+
+    return std::min(8U * (octave - 2U) + sub, n_buckets - 1U);
+  }
+
+  static auto lower_bound(const size_t& index) -> uint64_t {
+    if (index < 8U) {
+      return index;
+    }
+
+    const auto octave = index / 8U + 2U;
+
+    return (8U + index % 8U) << (octave - 3U);
+  }
+};
+
+/*
+  Attributes to a plugin the cycles in which the plugins of a chain used together more than the quantum duration. The
+  blame goes to the most expensive plugin of the cycle at the moment the budget is exceeded. The plugins of a chain are
+  usually run by the same data thread. If that is not the case the records that find the mutex taken are not counted
+  here. They are still in the histograms.
+*/
+
+class DspCycle {
+ public:
+  void add(const uint64_t& position, const uint64_t& elapsed_ns, const uint64_t& budget_ns, DspLoad* load) {
+    std::unique_lock<std::mutex> lock(mutex, std::try_to_lock);
+
+    if (!lock.owns_lock()) {
+      return;
+    }
+
+    if (position != cycle_position) {
+      cycle_position = position;
+      total_ns = 0U;
+      worst_ns = 0U;
+      worst = nullptr;
+      overrun = false;
+    }
+
+    total_ns += elapsed_ns;
+
+    if (elapsed_ns >= worst_ns) {
+      worst_ns = elapsed_ns;
+      worst = load;
+    }
+
+    if (!overrun && budget_ns != 0U && total_ns > budget_ns) {
+      overrun = true;
+
+      worst->count_overrun();
+    }
+  }
+
+ private:
+  std::mutex mutex;
+
+  bool overrun = false;
+
+  uint64_t cycle_position = 0U, total_ns = 0U, worst_ns = 0U;
+
+  DspLoad* worst = nullptr;
+};
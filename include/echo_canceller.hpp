@@ -59,8 +59,6 @@ class EchoCanceller : public PluginBase {
   int residual_echo_suppression = -10;
   int near_end_suppression = -10;
 
-  const float inv_short_max = 1.0F / (SHRT_MAX + 1.0F);
-
   std::vector<spx_int16_t> data_L;
   std::vector<spx_int16_t> data_R;
   std::vector<spx_int16_t> probe_mono;
@@ -19,6 +19,10 @@
 
 #pragma once
 
+#include <fftw3.h>
+#include <bit>
+#include <list>
+#include <nlohmann/json.hpp>
 #include <set>
 #include "autogain.hpp"
 #include "bass_enhancer.hpp"
@@ -35,6 +39,7 @@
 #include "exciter.hpp"
 #include "expander.hpp"
 #include "filter.hpp"
+#include "fused_chain.hpp"
 #include "gate.hpp"
 #include "limiter.hpp"
 #include "loudness.hpp"
@@ -51,6 +56,7 @@
 #include "stereo_tools.hpp"
 #include "tags_resources.hpp"  // IWYU pragma: export
 #include "tags_schema.hpp"     // IWYU pragma: export
+#include "test_signals.hpp"
 
 class EffectsBase {
  public:
@@ -65,6 +71,10 @@ class EffectsBase {
 
   PipeManager* pm = nullptr;
 
+  // declared before the plugins so it is destroyed after them
+
+  DspCycle dsp_cycle;
+
   std::shared_ptr<OutputLevel> output_level;
   std::shared_ptr<Spectrum> spectrum;
 
@@ -101,6 +111,65 @@ class EffectsBase {
 
   sigc::signal<void(const float&)> pipeline_latency;
 
+  // the quantum we ask the graph to use. Zero when we do not have a preference
+
+  [[nodiscard]] auto get_requested_quantum() const -> uint;
+
+  sigc::signal<void(const uint&)> quantum_request;
+
+  /*
+    The quantum the graph really gives to our chain. The smallest node.latency in the graph wins. So it is not the
+    requested one when another client asked for less. Zero until the chain has processed audio.
+  */
+
+  [[nodiscard]] auto get_negotiated_quantum() const -> uint;
+
+  sigc::signal<void(const uint&)> quantum_negotiated;
+
+  /*
+    Measured latency of the chain. The sequence sent by TestSignals to the first node after the source is looked for
+    by cross-correlation at the input and output of every plugin and at the end of the chain. All the values are in
+    milliseconds. The measurement is refused while apps are using the chain, and the end of the chain is muted while it
+    runs.
+  */
+
+  struct LatencyMeasurement {
+    struct Stage {
+      std::string name;
+
+      float reported = 0.0F;
+      float measured = 0.0F;
+
+      bool reached = false;  // false if the sequence was not found. Like for a plugin bypassed inside a FusedChain
+      bool mismatch = false;
+    };
+
+    bool valid = false;
+
+    float total = 0.0F;
+    float reported_total = 0.0F;
+
+    std::vector<Stage> stages;
+  };
+
+  auto start_latency_measurement(TestSignals* test_signals) -> bool;
+
+  virtual auto apps_want_to_play() -> bool;
+
+  void cancel_latency_measurement();
+
+  sigc::signal<void(const LatencyMeasurement&)> latency_measured;
+
+  // DSP load of a plugin in the list. Empty statistics are returned for names we do not have
+
+  [[nodiscard]] auto get_dsp_load(const std::string& name) const -> DspLoad::Stats;
+
+  // the DSP load of the plugins in the list, the spectrum and the output level in the order they are linked
+
+  auto get_dsp_load_report() -> nlohmann::json;
+
+  void reset_dsp_load();
+
   template <typename T>
   auto get_plugin_instance(const std::string& name) -> std::shared_ptr<T> {
     return std::dynamic_pointer_cast<T>(plugins[name]);
@@ -113,7 +182,36 @@ class EffectsBase {
 
   std::map<std::string, std::shared_ptr<PluginBase>> plugins;
 
-  std::vector<pw_proxy*> list_proxies, list_proxies_listen_mic;
+  /*
+    Instances removed from the plugins list. They stay connected to PipeWire but inactive and unlinked. So switching
+    back to a preset that uses them does not create them again. The most recently used are at the front.
+  */
+
+  static constexpr size_t plugin_pool_size = 16U;
+
+  std::list<std::pair<std::string, std::shared_ptr<PluginBase>>> plugin_pool;
+
+  std::vector<std::shared_ptr<FusedChain>> fused_chains;
+
+  /*
+    The links we made between the nodes of the pipeline. It is our model of the chain that is linked right now.
+  */
+
+  std::map<LinkEdge, std::vector<pw_proxy*>> chain_links;
+
+  std::vector<uint> chain_nodes;
+
+  std::vector<pw_proxy*> list_proxies_listen_mic;
+
+  uint requested_quantum = 0U;
+
+  uint negotiated_quantum = 0U;
+
+  guint quantum_check_timer = 0U;
+
+  TestSignals* measurement_signals = nullptr;
+
+  guint measurement_timer = 0U;
 
   std::vector<sigc::connection> connections;
 
@@ -121,11 +219,53 @@ class EffectsBase {
 
   void create_filters_if_necessary();
 
-  void remove_unused_filters();
-
   void activate_filters();
 
   void deactivate_filters();
 
   void broadcast_pipeline_latency();
+
+  /*
+    Connects to PipeWire the nodes needed to run the plugins in list and returns their ids in the order they have to
+    be linked. When the fused pipeline is enabled consecutive plugins without probe inputs are run by a FusedChain node
+    instead of having a node each.
+  */
+
+  auto prepare_chain_nodes(const std::vector<std::string>& list) -> std::vector<uint>;
+
+  // adds to link_ids the ids of all the links connected to the node
+
+  void insert_node_links(std::set<uint>& link_ids, const uint& node_id);
+
+  /*
+    Links node_ids in the given order plus the probe edges. Only the edges that are not in chain_links are created and
+    only the ones that are not wanted anymore are destroyed. So the parts of the chain that did not change keep
+    streaming. When mono_source is true the first node may be linked with a single port.
+  */
+
+  void link_chain(const std::vector<uint>& node_ids, const std::vector<LinkEdge>& probe_edges, const bool& mono_source);
+
+  void unlink_chain();
+
+  /*
+    Crystalizer reblocks the audio with extra latency when the quantum is not a power of 2. While it is in the list we
+    ask the graph for the largest power of 2 that is not above its default quantum. The convolution engine takes any
+    number of frames and does not need this.
+  */
+
+  void update_quantum_request(const std::vector<std::string>& list);
+
+  // warns when the graph did not give us the quantum we asked for
+
+  void check_quantum_request();
+
+  // moves the plugins that were removed from the plugins list to plugin_pool
+
+  void release_unused_plugins();
+
+  auto take_pooled_plugin(const std::string& name) -> std::shared_ptr<PluginBase>;
+
+  void finish_latency_measurement();
+
+  void release_latency_probes();
 };
@@ -56,6 +56,9 @@ class Equalizer : public PluginBase {
 
   uint latency_n_frames = 0U;
 
+  // control port indices resolved in the constructor
+  uint out_latency_port = lv2::Lv2Wrapper::invalid_port_index;
+
   std::vector<gulong> gconnections_unified;
 
   template <size_t n>
@@ -49,6 +49,8 @@ class FirFilterBase {
 
   [[nodiscard]] auto get_delay() const -> float;
 
+  [[nodiscard]] auto get_kernel_size() const -> size_t;
+
   template <typename T1>
   void process(T1& data_left, T1& data_right) {
     std::span conv_left_in(conv->inpdata(0), n_samples);
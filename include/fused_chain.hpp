@@ -0,0 +1,63 @@
+/*
+ *  Copyright © 2017-2023 Wellington Wallace
+ *
+ *  This file is part of Easy Effects.
+ *
+ *  Easy Effects is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Easy Effects is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Easy Effects. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "plugin_base.hpp"
+
+/*
+  A single PipeWire filter node that runs an ordered list of plugins back-to-back on its own scratch buffers. The
+  plugins keep their own bypass, gain and level meters. They are just not connected to the graph as separated nodes.
+  Plugins with probe inputs can not be fused because their probe ports have to be linked to other nodes.
+*/
+
+class FusedChain : public PluginBase {
+ public:
+  FusedChain(const std::string& tag,
+             const std::string& schema,
+             const std::string& schema_path,
+             PipeManager* pipe_manager);
+  FusedChain(const FusedChain&) = delete;
+  auto operator=(const FusedChain&) -> FusedChain& = delete;
+  FusedChain(const FusedChain&&) = delete;
+  auto operator=(const FusedChain&&) -> FusedChain& = delete;
+  ~FusedChain() override;
+
+  void setup() override;
+
+  void process(std::span<float>& left_in,
+               std::span<float>& right_in,
+               std::span<float>& left_out,
+               std::span<float>& right_out) override;
+
+  auto get_latency_seconds() -> float override;
+
+  void set_plugins(const std::vector<std::shared_ptr<PluginBase>>& list);
+
+  [[nodiscard]] auto get_plugins() const -> const std::vector<std::shared_ptr<PluginBase>>&;
+
+  static auto can_be_fused(const std::shared_ptr<PluginBase>& plugin) -> bool;
+
+ private:
+  static constexpr uint default_max_quantum = 8192U;
+
+  std::vector<std::shared_ptr<PluginBase>> plugins;
+
+  std::vector<float> scratch_a_L, scratch_a_R, scratch_b_L, scratch_b_R;
+};
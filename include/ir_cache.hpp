@@ -0,0 +1,68 @@
+/*
+ *  Copyright © 2017-2023 Wellington Wallace
+ *
+ *  This file is part of Easy Effects.
+ *
+ *  Easy Effects is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Easy Effects is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Easy Effects. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <glib.h>
+#include <memory>
+#include <span>
+#include <string>
+#include <vector>
+
+namespace ir_cache {
+
+/*
+  A stereo impulse response already resampled to the graph rate. Normally it is a read only mapping of a file in the
+  user cache dir. So the instances of the convolver using the same response share its memory.
+*/
+
+class Kernel {
+ public:
+  Kernel(GMappedFile* mapped_file, const size_t& frames);
+  Kernel(std::vector<float> samples, const size_t& frames);
+  Kernel(const Kernel&) = delete;
+  auto operator=(const Kernel&) -> Kernel& = delete;
+  Kernel(const Kernel&&) = delete;
+  auto operator=(const Kernel&&) -> Kernel& = delete;
+  ~Kernel();
+
+  [[nodiscard]] auto left() const -> std::span<const float>;
+
+  [[nodiscard]] auto right() const -> std::span<const float>;
+
+  [[nodiscard]] auto size() const -> size_t;
+
+ private:
+  GMappedFile* file = nullptr;
+
+  std::vector<float> memory;  // used when the cache file could not be written
+
+  size_t n_frames = 0U;
+
+  std::span<const float> data;  // all the left samples followed by the right ones
+};
+
+/*
+  Returns the response in path resampled to rate. The cache entries are named after the hash of the file contents.
+  Only a cache miss decodes and resamples the file. A null pointer is returned if it can not be used.
+*/
+
+auto load(const std::string& path, const uint& rate, const std::string& log_tag) -> std::shared_ptr<const Kernel>;
+
+}  // namespace ir_cache
@@ -43,6 +43,8 @@ class LevelMeter : public PluginBase {
 
   auto get_latency_seconds() -> float override;
 
+  [[nodiscard]] auto can_process_in_place() const -> bool override;
+
   void reset_history();
 
   sigc::signal<void(const double,  // momentary
@@ -56,6 +58,10 @@ class LevelMeter : public PluginBase {
       results;  // range
 
  private:
+  void pack_meters(std::span<double> values) override;
+
+  void emit_meters(std::span<const double> values) override;
+
   bool ebur128_ready = false;
 
   uint old_rate = 0U;
@@ -51,8 +51,19 @@ class Limiter : public PluginBase {
   float sidechain_r_port_value = 0.0F;
 
  private:
+  void pack_meters(std::span<double> values) override;
+
+  void emit_meters(std::span<const double> values) override;
+
   uint latency_n_frames = 0U;
 
+  // control port indices resolved in the constructor
+  uint out_latency_port = lv2::Lv2Wrapper::invalid_port_index;
+  uint grlm_l_port = lv2::Lv2Wrapper::invalid_port_index;
+  uint grlm_r_port = lv2::Lv2Wrapper::invalid_port_index;
+  uint sclm_l_port = lv2::Lv2Wrapper::invalid_port_index;
+  uint sclm_r_port = lv2::Lv2Wrapper::invalid_port_index;
+
   std::vector<pw_proxy*> list_proxies;
 
   void update_sidechain_links(const std::string& key);
@@ -44,4 +44,7 @@ class Loudness : public PluginBase {
 
  private:
   uint latency_n_frames = 0U;
+
+  // control port indices resolved in the constructor
+  uint out_latency_port = lv2::Lv2Wrapper::invalid_port_index;
 };
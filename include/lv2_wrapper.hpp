@@ -32,10 +32,16 @@
 #include <lv2/parameters/parameters.h>
 #include <lv2/ui/ui.h>
 #include <array>
+#include <atomic>
+#include <fstream>
+#include <map>
+#include <memory>
 #include <mutex>
+#include <set>
 #include <span>
 #include <thread>
 #include <unordered_map>
+#include "notification_ring.hpp"
 #include "string_literal_wrapper.hpp"
 #include "util.hpp"
 
@@ -58,7 +64,7 @@ struct Port {
 
   std::string symbol;
 
-  float value = 0.0F;  // Control value (if applicable)
+  float value = 0.0F;  // Control value (if applicable). Accessed through std::atomic_ref once connected.
 
   float min = -std::numeric_limits<float>::infinity();
 
@@ -67,6 +73,28 @@ struct Port {
   bool is_input;  // True if an input port
 
   bool optional;  // True if the connection is optional
+
+  bool smooth = false;  // True if the control can be interpolated. It is not an integer, toggle or enumeration
+};
+
+/*
+  What we learn about a plugin from its Turtle files. It is the same for all the instances of the plugin. So it is
+  built only once and shared by them.
+*/
+
+struct PluginDescriptor {
+  LilvWorld* world = nullptr;
+
+  const LilvPlugin* plugin = nullptr;
+
+  uint n_audio_in = 0U;
+  uint n_audio_out = 0U;
+
+  bool in_place_broken = false;  // the plugin requires lv2:inPlaceBroken
+
+  std::vector<Port> ports;
+
+  std::unordered_map<std::string, uint> control_port_indices;  // control port symbol -> port index
 };
 
 class Lv2Wrapper {
@@ -88,6 +116,8 @@ class Lv2Wrapper {
 
   [[nodiscard]] auto get_rate() const -> uint;
 
+  [[nodiscard]] auto is_in_place_broken() const -> bool;
+
   void connect_data_ports(std::span<float>& left_in,
                           std::span<float>& right_in,
                           std::span<float>& left_out,
@@ -102,12 +132,33 @@ class Lv2Wrapper {
 
   void activate();
 
-  void run() const;
+  void run();
 
   void deactivate();
 
+  // deactivates and activates the instance so the plugin clears its delay lines and envelopes
+
+  void reset();
+
+  static constexpr uint invalid_port_index = std::numeric_limits<uint>::max();
+
+  /*
+    Control ports should be resolved once to their index. The index overloads below do not allocate or search. They
+    are the ones to be used in the realtime thread.
+
+    New values for the input ports are not written to the plugin right away. They are queued and applied by run() in
+    the realtime thread before the plugin processes the next block. Reading an input port gives the last value that was
+    set. Reading an output port gives what the plugin wrote in the last run().
+  */
+
+  [[nodiscard]] auto get_control_port_index(const std::string& symbol) const -> uint;
+
+  void set_control_port_value(const uint& index, const float& value);
+
   void set_control_port_value(const std::string& symbol, const float& value);
 
+  auto get_control_port_value(const uint& index) -> float;
+
   auto get_control_port_value(const std::string& symbol) -> float;
 
   auto has_instance() -> bool;
@@ -130,81 +181,85 @@ class Lv2Wrapper {
 
   template <StringLiteralWrapper key_wrapper, StringLiteralWrapper gkey_wrapper>
   void bind_key_bool(GSettings* settings) {
-    set_control_port_value(key_wrapper.msg.data(),
-                           static_cast<float>(g_settings_get_boolean(settings, gkey_wrapper.msg.data())));
+    const auto index = get_control_port_index(key_wrapper.msg.data());
+
+    set_control_port_value(index, static_cast<float>(g_settings_get_boolean(settings, gkey_wrapper.msg.data())));
 
     g_signal_connect(settings, ("changed::"s + gkey_wrapper.msg.data()).c_str(),
                      G_CALLBACK(+[](GSettings* settings, char* key, gpointer user_data) {
-                       auto* self = static_cast<Lv2Wrapper*>(user_data);
+                       auto* binding = static_cast<KeyBinding*>(user_data);
 
-                       self->set_control_port_value(key_wrapper.msg.data(),
-                                                    static_cast<float>(g_settings_get_boolean(settings, key)));
+                       binding->wrapper->set_control_port_value(
+                           binding->index, static_cast<float>(g_settings_get_boolean(settings, key)));
                      }),
-                     this);
+                     make_key_binding(index));
 
     gsettings_sync_funcs.emplace_back([=, this]() {
       g_settings_set_boolean(settings, gkey_wrapper.msg.data(),
-                             static_cast<gboolean>(get_control_port_value(key_wrapper.msg.data())));
+                             static_cast<gboolean>(get_control_port_value(index)));
     });
   }
 
   template <StringLiteralWrapper key_wrapper, StringLiteralWrapper gkey_wrapper>
   void bind_key_enum(GSettings* settings) {
-    set_control_port_value(key_wrapper.msg.data(),
-                           static_cast<float>(g_settings_get_enum(settings, gkey_wrapper.msg.data())));
+    const auto index = get_control_port_index(key_wrapper.msg.data());
+
+    set_control_port_value(index, static_cast<float>(g_settings_get_enum(settings, gkey_wrapper.msg.data())));
 
     g_signal_connect(settings, ("changed::"s + gkey_wrapper.msg.data()).c_str(),
                      G_CALLBACK(+[](GSettings* settings, char* key, gpointer user_data) {
-                       auto* self = static_cast<Lv2Wrapper*>(user_data);
+                       auto* binding = static_cast<KeyBinding*>(user_data);
 
-                       self->set_control_port_value(key_wrapper.msg.data(),
-                                                    static_cast<float>(g_settings_get_enum(settings, key)));
+                       binding->wrapper->set_control_port_value(
+                           binding->index, static_cast<float>(g_settings_get_enum(settings, key)));
                      }),
-                     this);
+                     make_key_binding(index));
 
     gsettings_sync_funcs.emplace_back([=, this]() {
       g_settings_set_enum(settings, gkey_wrapper.msg.data(),
-                          static_cast<gint>(get_control_port_value(key_wrapper.msg.data())));
+                          static_cast<gint>(get_control_port_value(index)));
     });
   }
 
   template <StringLiteralWrapper key_wrapper, StringLiteralWrapper gkey_wrapper>
   void bind_key_int(GSettings* settings) {
-    set_control_port_value(key_wrapper.msg.data(),
-                           static_cast<float>(g_settings_get_int(settings, gkey_wrapper.msg.data())));
+    const auto index = get_control_port_index(key_wrapper.msg.data());
+
+    set_control_port_value(index, static_cast<float>(g_settings_get_int(settings, gkey_wrapper.msg.data())));
 
     g_signal_connect(settings, ("changed::"s + gkey_wrapper.msg.data()).c_str(),
                      G_CALLBACK(+[](GSettings* settings, char* key, gpointer user_data) {
-                       auto* self = static_cast<Lv2Wrapper*>(user_data);
+                       auto* binding = static_cast<KeyBinding*>(user_data);
 
-                       self->set_control_port_value(key_wrapper.msg.data(),
-                                                    static_cast<float>(g_settings_get_int(settings, key)));
+                       binding->wrapper->set_control_port_value(
+                           binding->index, static_cast<float>(g_settings_get_int(settings, key)));
                      }),
-                     this);
+                     make_key_binding(index));
 
     gsettings_sync_funcs.emplace_back([=, this]() {
       g_settings_set_int(settings, gkey_wrapper.msg.data(),
-                         static_cast<gint>(get_control_port_value(key_wrapper.msg.data())));
+                         static_cast<gint>(get_control_port_value(index)));
     });
   }
 
   template <StringLiteralWrapper key_wrapper, StringLiteralWrapper gkey_wrapper>
   void bind_key_double(GSettings* settings) {
-    set_control_port_value(key_wrapper.msg.data(),
-                           static_cast<float>(g_settings_get_double(settings, gkey_wrapper.msg.data())));
+    const auto index = get_control_port_index(key_wrapper.msg.data());
+
+    set_control_port_value(index, static_cast<float>(g_settings_get_double(settings, gkey_wrapper.msg.data())));
 
     g_signal_connect(settings, ("changed::"s + gkey_wrapper.msg.data()).c_str(),
                      G_CALLBACK(+[](GSettings* settings, char* key, gpointer user_data) {
-                       auto* self = static_cast<Lv2Wrapper*>(user_data);
+                       auto* binding = static_cast<KeyBinding*>(user_data);
 
-                       self->set_control_port_value(key_wrapper.msg.data(),
-                                                    static_cast<float>(g_settings_get_double(settings, key)));
+                       binding->wrapper->set_control_port_value(
+                           binding->index, static_cast<float>(g_settings_get_double(settings, key)));
                      }),
-                     this);
+                     make_key_binding(index));
 
     gsettings_sync_funcs.emplace_back([=, this]() {
       g_settings_set_double(settings, gkey_wrapper.msg.data(),
-                            static_cast<gdouble>(get_control_port_value(key_wrapper.msg.data())));
+                            static_cast<gdouble>(get_control_port_value(index)));
     });
   }
 
@@ -215,11 +270,13 @@ class Lv2Wrapper {
     auto linear_v =
         (!lower_bound && key_v <= util::minimum_db_d_level) ? 0.0F : static_cast<float>(util::db_to_linear(key_v));
 
-    set_control_port_value(key_wrapper.msg.data(), linear_v);
+    const auto index = get_control_port_index(key_wrapper.msg.data());
+
+    set_control_port_value(index, linear_v);
 
     g_signal_connect(settings, ("changed::"s + gkey_wrapper.msg.data()).c_str(),
                      G_CALLBACK(+[](GSettings* settings, char* key, gpointer user_data) {
-                       auto* self = static_cast<Lv2Wrapper*>(user_data);
+                       auto* binding = static_cast<KeyBinding*>(user_data);
 
                        auto key_v = g_settings_get_double(settings, gkey_wrapper.msg.data());
 
@@ -227,12 +284,12 @@ class Lv2Wrapper {
                                            ? 0.0F
                                            : static_cast<float>(util::db_to_linear(key_v));
 
-                       self->set_control_port_value(key_wrapper.msg.data(), linear_v);
+                       binding->wrapper->set_control_port_value(binding->index, linear_v);
                      }),
-                     this);
+                     make_key_binding(index));
 
     gsettings_sync_funcs.emplace_back([=, this]() {
-      const auto linear_v = get_control_port_value(key_wrapper.msg.data());
+      const auto linear_v = get_control_port_value(index);
 
       const auto db_v = (!lower_bound & (linear_v == 0.0F)) ? util::minimum_db_d_level : util::linear_to_db(linear_v);
 
@@ -243,6 +300,8 @@ class Lv2Wrapper {
  private:
   std::string plugin_uri;
 
+  std::shared_ptr<const PluginDescriptor> descriptor;
+
   LilvWorld* world = nullptr;
 
   const LilvPlugin* plugin = nullptr;
@@ -258,8 +317,6 @@ class Lv2Wrapper {
   void* libhandle = nullptr;
 
   uint n_ports = 0U;
-  uint n_audio_in = 0U;
-  uint n_audio_out = 0U;
 
   uint n_samples = 0U;
 
@@ -271,6 +328,18 @@ class Lv2Wrapper {
 
   std::vector<std::function<void()>> gsettings_sync_funcs;
 
+  // user data of the GSettings callbacks of bind_key_*. The port index is resolved once when the key is bound
+
+  struct KeyBinding {
+    Lv2Wrapper* wrapper = nullptr;
+
+    uint index = invalid_port_index;
+  };
+
+  std::vector<std::unique_ptr<KeyBinding>> key_bindings;
+
+  auto make_key_binding(const uint& index) -> KeyBinding*;
+
   std::unordered_map<std::string, LV2_URID> map_uri_to_urid;
   std::unordered_map<LV2_URID, std::string> map_urid_to_uri;
 
@@ -278,12 +347,48 @@ class Lv2Wrapper {
 
   std::mutex ui_mutex;
 
-  void check_required_features();
+  struct ControlEvent {
+    uint index = 0U;
+
+    float value = 0.0F;
+  };
+
+  struct ControlRamp {
+    uint index = 0U;
+
+    float start = 0.0F;
 
-  void create_ports();
+    float end = 0.0F;
+  };
+
+  // while a control is being interpolated the block is processed in slices of this size
+
+  static constexpr uint smoothing_slice = 32U;
+
+  std::unique_ptr<NotificationRing<ControlEvent>> control_events;
+
+  std::mutex control_events_mutex;  // the gsettings callbacks and the native ui are both producers
+
+  std::atomic<bool> control_events_overflow = false;
+
+  bool smooth_controls = false;
+
+  std::vector<float> control_targets;  // last value set for each input control port
+
+  std::vector<ControlRamp> control_ramps;  // memory for all the ports is reserved in the constructor
+
+  std::array<std::pair<uint, float*>, 6U> audio_connections{};
+
+  uint n_audio_connections = 0U;
 
   void connect_control_ports();
 
+  void connect_audio_port(const uint& index, float* data);
+
+  void queue_control_value(const uint& index, const float& value);
+
+  void apply_control_events();
+
   auto map_urid(const std::string& uri) -> LV2_URID;
 };
 
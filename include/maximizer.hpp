@@ -47,5 +47,13 @@ class Maximizer : public PluginBase {
   double reduction_port_value = 0.0;
 
  private:
+  void pack_meters(std::span<double> values) override;
+
+  void emit_meters(std::span<const double> values) override;
+
   uint latency_n_frames = 0U;
+
+  // control port indices resolved in the constructor
+  uint lv2_latency_port = lv2::Lv2Wrapper::invalid_port_index;
+  uint gr_port = lv2::Lv2Wrapper::invalid_port_index;
 };
@@ -59,8 +59,22 @@ class MultibandGate : public PluginBase {
   std::array<float, n_bands> reduction_port_array = {0.0F, 0.0F, 0.0F, 0.0F, 0.0F, 0.0F, 0.0F, 0.0F};
 
  private:
+  static_assert(4U * n_bands <= max_meter_values);
+
+  void pack_meters(std::span<double> values) override;
+
+  void emit_meters(std::span<const double> values) override;
+
   uint latency_n_frames = 0U;
 
+  // control port indices resolved in the constructor
+  uint out_latency_port = lv2::Lv2Wrapper::invalid_port_index;
+
+  std::array<uint, n_bands> fre_ports{};
+  std::array<uint, n_bands> elm_l_ports{}, elm_r_ports{};
+  std::array<uint, n_bands> clm_l_ports{}, clm_r_ports{};
+  std::array<uint, n_bands> rlm_l_ports{}, rlm_r_ports{};
+
   std::vector<pw_proxy*> list_proxies;
 
   void update_sidechain_links(const std::string& key);
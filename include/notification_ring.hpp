@@ -0,0 +1,128 @@
+/*
+ *  Copyright © 2017-2023 Wellington Wallace
+ *
+ *  This file is part of Easy Effects.
+ *
+ *  Easy Effects is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Easy Effects is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Easy Effects. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <span>
+#include <vector>
+
+/*
+  Single producer single consumer ring buffer used to send fixed size records or audio samples from the realtime thread
+  to a non realtime one. All the memory is allocated in the constructor. push() and pop() neither allocate nor lock.
+  When the consumer falls behind the new records are dropped instead of overwriting the ones that were not read yet.
+*/
+
+template <typename T>
+class NotificationRing {
+ public:
+  explicit NotificationRing(const size_t& capacity, const T& prototype = T{})
+      : slots(std::bit_ceil(capacity), prototype), mask(slots.size() - 1U) {}
+  NotificationRing(const NotificationRing&) = delete;
+  auto operator=(const NotificationRing&) -> NotificationRing& = delete;
+  NotificationRing(const NotificationRing&&) = delete;
+  auto operator=(const NotificationRing&&) -> NotificationRing& = delete;
+  ~NotificationRing() = default;
+
+  // producer
+
+  auto push(const T& value) -> bool {
+    const auto w = write_index.load(std::memory_order_relaxed);
+
+    if (w - read_index.load(std::memory_order_acquire) == slots.size()) {
+      return false;
+    }
+
+    slots[w & mask] = value;
+
+    write_index.store(w + 1U, std::memory_order_release);
+
+    return true;
+  }
+
+  // consumer
+
+  auto pop(T& value) -> bool {
+    const auto r = read_index.load(std::memory_order_relaxed);
+
+    if (r == write_index.load(std::memory_order_acquire)) {
+      return false;
+    }
+
+    value = slots[r & mask];
+
+    read_index.store(r + 1U, std::memory_order_release);
+
+    return true;
+  }
+
+  /*
+    Bulk versions for plain sample streams. They transfer as many elements as possible and return how many were
+    transferred.
+  */
+
+  auto push(std::span<const T> values) -> size_t {
+    const auto w = write_index.load(std::memory_order_relaxed);
+
+    const auto count = std::min(values.size(), slots.size() - (w - read_index.load(std::memory_order_acquire)));
+
+    for (size_t n = 0U; n < count; n++) {
+      slots[(w + n) & mask] = values[n];
+    }
+
+    write_index.store(w + count, std::memory_order_release);
+
+    return count;
+  }
+
+  auto pop(std::span<T> values) -> size_t {
+    const auto r = read_index.load(std::memory_order_relaxed);
+
+    const auto count = std::min(values.size(), write_index.load(std::memory_order_acquire) - r);
+
+    for (size_t n = 0U; n < count; n++) {
+      values[n] = slots[(r + n) & mask];
+    }
+
+    read_index.store(r + count, std::memory_order_release);
+
+    return count;
+  }
+
+  [[nodiscard]] auto empty() const -> bool {
+    return read_index.load(std::memory_order_acquire) == write_index.load(std::memory_order_acquire);
+  }
+
+ private:
+  // kept apart so the two threads do not keep invalidating each other's cache line
+
+  static constexpr size_t cache_line_size = 64U;
+
+  std::vector<T> slots;
+
+  size_t mask = 0U;
+
+  // the indexes only grow. Their difference is the number of records waiting to be read
+
+  alignas(cache_line_size) std::atomic<size_t> write_index = 0U;
+  alignas(cache_line_size) std::atomic<size_t> read_index = 0U;
+};
@@ -41,4 +41,6 @@ class OutputLevel : public PluginBase {
                std::span<float>& right_out) override;
 
   auto get_latency_seconds() -> float override;
+
+  [[nodiscard]] auto can_process_in_place() const -> bool override;
 };
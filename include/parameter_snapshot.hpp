@@ -0,0 +1,145 @@
+/*
+ *  Copyright © 2017-2023 Wellington Wallace
+ *
+ *  This file is part of Easy Effects.
+ *
+ *  Easy Effects is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Easy Effects is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Easy Effects. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+/*
+  Read-copy-update handoff of plugin parameters from the main thread to the realtime thread.
+
+  The main thread never modifies a state the realtime thread may be reading. It publishes a new immutable copy through
+  an atomic pointer swap and the previous one is deleted by a later reclaim() once the realtime thread is not using it
+  anymore. The realtime side never blocks and never allocates. There must be only one reader (the thread calling
+  process()) and all the publishing has to be done from the main thread.
+*/
+
+template <typename T>
+class ParameterSnapshot {
+ public:
+  struct State {
+    T data;
+
+    uint64_t serial = 0U;
+  };
+
+  class Reader {
+   public:
+    explicit Reader(ParameterSnapshot& owner) : owner(owner), state(owner.acquire()) {}
+    Reader(const Reader&) = delete;
+    auto operator=(const Reader&) -> Reader& = delete;
+    Reader(const Reader&&) = delete;
+    auto operator=(const Reader&&) -> Reader& = delete;
+    ~Reader() { owner.release(); }
+
+    auto operator->() const -> const T* { return &state->data; }
+
+    auto operator*() const -> const T& { return state->data; }
+
+    /*
+      Every published state gets a new serial. Plugins that have to push the parameters into an engine can use it to
+      know if something changed since the last quantum.
+    */
+
+    [[nodiscard]] auto serial() const -> uint64_t { return state->serial; }
+
+   private:
+    ParameterSnapshot& owner;
+
+    const State* state = nullptr;
+  };
+
+  ParameterSnapshot() : current(new State()) {}
+  ParameterSnapshot(const ParameterSnapshot&) = delete;
+  auto operator=(const ParameterSnapshot&) -> ParameterSnapshot& = delete;
+  ParameterSnapshot(const ParameterSnapshot&&) = delete;
+  auto operator=(const ParameterSnapshot&&) -> ParameterSnapshot& = delete;
+
+  ~ParameterSnapshot() {
+    delete current.load();
+
+    for (const auto* s : retired) {
+      delete s;
+    }
+  }
+
+  // realtime thread
+
+  [[nodiscard]] auto read() -> Reader { return Reader(*this); }
+
+  // main thread
+
+  [[nodiscard]] auto get() const -> const T& { return current.load()->data; }
+
+  template <typename F>
+  void update(F&& func) {
+    auto* next = new State{current.load()->data, ++last_serial};
+
+    func(next->data);
+
+    retired.push_back(current.exchange(next));
+
+    reclaim();
+  }
+
+  void reclaim() {
+    const auto* in_use = reader_state.load();
+
+    std::erase_if(retired, [&](const State* s) {
+      if (s == in_use) {
+        return false;
+      }
+
+      delete s;
+
+      return true;
+    });
+  }
+
+ private:
+  std::atomic<State*> current;
+
+  std::atomic<const State*> reader_state = nullptr;
+
+  std::vector<const State*> retired;
+
+  uint64_t last_serial = 0U;
+
+  auto acquire() -> const State* {
+    /*
+      The state is marked as in use before checking that it is still the current one. If update() swapped it in the
+      meantime we try again. After this loop reclaim() is guaranteed to see our mark.
+    */
+
+    const State* s = nullptr;
+
+    do {
+      s = current.load();
+
+      reader_state.store(s);
+    } while (s != current.load());
+
+    return s;
+  }
+
+  void release() { reader_state.store(nullptr); }
+};
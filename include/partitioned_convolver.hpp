@@ -0,0 +1,137 @@
+/*
+ *  Copyright © 2017-2023 Wellington Wallace
+ *
+ *  This file is part of Easy Effects.
+ *
+ *  Easy Effects is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Easy Effects is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Easy Effects. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <fftw3.h>
+#include <array>
+#include <atomic>
+#include <complex>
+#include <memory>
+#include <span>
+#include <thread>
+#include <vector>
+
+/*
+  Zero latency stereo convolution for long impulse responses. Each channel is convolved with its own kernel.
+
+  The first head_size taps are applied in the time domain, sample by sample. The rest of the kernel is divided in
+  stages. Each one is a uniformly partitioned FFT convolution (overlap-save with a frequency domain delay line) with
+  partitions stage_growth times longer than the ones of the previous stage. The first stage is computed by the thread
+  calling process(). The others have their own threads. A stage with partitions of S frames starts at the tap 2 * S.
+  So its thread has the time of one partition to compute a block before it is needed.
+
+  process() accepts any number of frames. Nothing has to be rebuilt when the quantum changes.
+*/
+
+class PartitionedConvolver {
+ public:
+  PartitionedConvolver() = default;
+  PartitionedConvolver(const PartitionedConvolver&) = delete;
+  auto operator=(const PartitionedConvolver&) -> PartitionedConvolver& = delete;
+  PartitionedConvolver(const PartitionedConvolver&&) = delete;
+  auto operator=(const PartitionedConvolver&&) -> PartitionedConvolver& = delete;
+  ~PartitionedConvolver();
+
+  static constexpr size_t head_size = 64U;
+
+  static constexpr size_t stage_growth = 16U;
+
+  static constexpr size_t max_partition_size = 16384U;
+
+  // Builds the stages for the given kernels. It is not realtime safe and it must not run while process() does.
+
+  void configure(std::span<const float> kernel_L, std::span<const float> kernel_R);
+
+  // convolves in place
+
+  void process(std::span<float> left, std::span<float> right);
+
+  // clears the signal history. The kernels are kept
+
+  void reset();
+
+  [[nodiscard]] auto kernel_size() const -> size_t;
+
+ private:
+  struct Stage {
+    Stage(const size_t& partition_size,
+          const size_t& first_tap,
+          const size_t& last_tap,
+          const std::array<std::span<const float>, 2>& kernels,
+          const bool& use_thread);
+    Stage(const Stage&) = delete;
+    auto operator=(const Stage&) -> Stage& = delete;
+    Stage(const Stage&&) = delete;
+    auto operator=(const Stage&&) -> Stage& = delete;
+    ~Stage();
+
+    const size_t size;  // partition length. The transforms have twice this length
+
+    const size_t n_bins;
+
+    const bool threaded;
+
+    size_t n_partitions = 0U;
+
+    size_t fdl_index = 0U;  // delay line slot of the most recent block
+
+    size_t position = 0U;  // frames of the current block received so far
+
+    fftwf_plan forward = nullptr, backward = nullptr;
+
+    std::vector<float> time;
+
+    std::vector<std::complex<float>> spectrum;
+
+    // previous and current input blocks. While a threaded stage computes the current block is kept in pending
+
+    std::array<std::vector<float>, 2> window, pending;
+
+    std::array<std::vector<std::complex<float>>, 2> filters, fdl;
+
+    // step() writes the contribution to the next blocks in output. It is swapped with current when they start
+
+    std::array<std::vector<float>, 2> output, current;
+
+    std::thread worker;
+
+    std::atomic<uint> submitted = 0U, done = 0U;
+
+    std::atomic<bool> running = true;
+
+    bool busy = false;  // a block was given to the worker and its result was not taken yet
+
+    void step();
+
+    void work();
+
+    void finish_block();
+
+    void wait();
+
+    void clear();
+  };
+
+  size_t n_taps = 0U;
+
+  std::array<std::vector<float>, 2> direct_kernel;  // the first head_size taps in reverse order
+
+  std::vector<std::unique_ptr<Stage>> stages;  // the first one runs in the thread calling process()
+};
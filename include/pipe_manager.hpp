@@ -31,9 +31,16 @@
 #include <spa/utils/result.h>
 #include <algorithm>
 #include <array>
+#include <chrono>
+#include <compare>
+#include <condition_variable>
+#include <functional>
 #include <map>
 #include <memory>
+#include <mutex>
+#include <optional>
 #include <span>
+#include <unordered_map>
 #include "tags_app.hpp"
 #include "tags_pipewire.hpp"
 #include "util.hpp"
@@ -114,6 +121,18 @@ struct LinkInfo {
   pw_link_state state = PW_LINK_STATE_UNLINKED;
 };
 
+// the links between the ports of two nodes
+
+struct LinkEdge {
+  uint output_node_id = 0U;
+
+  uint input_node_id = 0U;
+
+  bool probe_link = false;
+
+  auto operator<=>(const LinkEdge&) const = default;
+};
+
 struct PortInfo {
   std::string path;
 
@@ -140,6 +159,56 @@ struct PortInfo {
   uint64_t serial = SPA_ID_INVALID;
 };
 
+/*
+  The ports and links of the graph. They are stored by serial because this is what the destroy callbacks know about
+  them. Indexes by node id make the lookups done while linking independent of the size of the whole graph.
+*/
+
+class PortRegistry {
+ public:
+  void insert(const PortInfo& port);
+
+  void erase(const uint64_t& serial);
+
+  [[nodiscard]] auto of_node(const uint& node_id) const -> std::vector<PortInfo>;
+
+  [[nodiscard]] auto count(const uint& node_id) const -> uint;
+
+ private:
+  std::unordered_map<uint64_t, PortInfo> ports;
+
+  std::unordered_map<uint, std::vector<uint64_t>> serials_by_node;
+};
+
+class LinkRegistry {
+ public:
+  void insert(const LinkInfo& link);
+
+  void erase(const uint64_t& serial);
+
+  // returns a pointer to the link so its state can be updated. It is valid until the link is erased
+
+  auto find(const uint64_t& serial) -> LinkInfo*;
+
+  // links whose output port belongs to node_id
+
+  [[nodiscard]] auto from_node(const uint& node_id) const -> std::vector<LinkInfo>;
+
+  // links whose input port belongs to node_id
+
+  [[nodiscard]] auto to_node(const uint& node_id) const -> std::vector<LinkInfo>;
+
+  [[nodiscard]] auto between(const uint& output_node_id, const uint& input_node_id) const -> std::vector<LinkInfo>;
+
+ private:
+  std::unordered_map<uint64_t, LinkInfo> links;
+
+  std::unordered_multimap<uint, uint64_t> serials_by_output_node, serials_by_input_node;
+
+  [[nodiscard]] auto collect(const std::unordered_multimap<uint, uint64_t>& index, const uint& node_id) const
+      -> std::vector<LinkInfo>;
+};
+
 struct ModuleInfo {
   uint id;
 
@@ -214,9 +283,16 @@ class PipeManager {
 
   std::map<uint64_t, NodeInfo> node_map;
 
-  std::vector<LinkInfo> list_links;
+  /*
+    The serials of the nodes in node_map indexed by their id. node_serials, links and ports are changed by the
+    PipeWire thread through update_graph(). Other threads read them with graph_mutex locked through the methods below.
+  */
+
+  std::unordered_map<uint, uint64_t> node_serials;
+
+  LinkRegistry links;
 
-  std::vector<PortInfo> list_ports;
+  PortRegistry ports;
 
   std::vector<ModuleInfo> list_modules;
 
@@ -260,6 +336,64 @@ class PipeManager {
 
   auto count_node_ports(const uint& node_id) -> uint;
 
+  // copies of the links taken with graph_mutex locked. They can be called from any thread
+
+  auto links_from_node(const uint& node_id) -> std::vector<LinkInfo>;
+
+  auto links_to_node(const uint& node_id) -> std::vector<LinkInfo>;
+
+  auto links_between(const uint& output_node_id, const uint& input_node_id) -> std::vector<LinkInfo>;
+
+  /*
+    Creates the links of many pairs of nodes with a single roundtrip to the server. The links are sent as they are
+    added and commit() waits for all of them at once. A transaction that is not committed destroys its links.
+  */
+
+  class LinkTransaction {
+   public:
+    explicit LinkTransaction(PipeManager* pipe_manager);
+    LinkTransaction(const LinkTransaction&) = delete;
+    auto operator=(const LinkTransaction&) -> LinkTransaction& = delete;
+    LinkTransaction(const LinkTransaction&&) = delete;
+    auto operator=(const LinkTransaction&&) -> LinkTransaction& = delete;
+    ~LinkTransaction();
+
+    /*
+      Queues the links from the output ports of output_node_id to the input ports of input_node_id. Returns how many
+      links were queued. Errors reported later by the server are logged by commit().
+    */
+
+    auto add(const uint& output_node_id,
+             const uint& input_node_id,
+             const bool& probe_link = false,
+             const bool& link_passive = true) -> uint;
+
+    // returns the proxies of the links the server accepted grouped by the pair of nodes they connect
+
+    auto commit() -> std::map<LinkEdge, std::vector<pw_proxy*>>;
+
+    struct PendingLink {
+      pw_proxy* proxy = nullptr;
+
+      LinkEdge edge;
+
+      int res = 0;
+
+      spa_hook listener{};
+    };
+
+   private:
+    PipeManager* pm = nullptr;
+
+    bool committed = false;
+
+    // the listeners are registered in the proxies. Their addresses must not change.
+
+    std::vector<std::unique_ptr<PendingLink>> pending;
+
+    void release(const bool& destroy_all);
+  };
+
   /*
     Links the output ports of the node output_node_id to the input ports of the node input_node_id
   */
@@ -272,7 +406,7 @@ class PipeManager {
   void destroy_object(const int& id) const;
 
   /*
-    Destroy all the filters links
+    Destroy all the filters links. A single roundtrip to the server is made for the whole list.
   */
 
   void destroy_links(const std::vector<pw_proxy*>& list) const;
@@ -285,6 +419,26 @@ class PipeManager {
 
   auto wait_full() const -> int;
 
+  /*
+    Blocks the calling thread until predicate returns true or the timeout expires. The predicate runs with
+    graph_mutex locked and is evaluated again every time update_graph() is called. Returns its last value.
+  */
+
+  auto wait_for_graph(const std::function<bool()>& predicate, const std::chrono::milliseconds& timeout) -> bool;
+
+  // runs f with graph_mutex locked and wakes up the threads blocked in wait_for_graph()
+
+  template <typename F>
+  void update_graph(F&& f) {
+    {
+      std::scoped_lock<std::mutex> lock(graph_mutex);
+
+      f();
+    }
+
+    graph_changed.notify_all();
+  }
+
   static void lock_node_map();
 
   static void unlock_node_map();
@@ -321,5 +475,11 @@ class PipeManager {
 
   spa_hook core_listener{}, registry_listener{};
 
+  // protects node_serials, the link and port registries and the readiness state of our filters
+
+  std::mutex graph_mutex;
+
+  std::condition_variable graph_changed;
+
   void set_metadata_target_node(const uint& origin_id, const uint& target_id, const uint64_t& target_serial) const;
 };
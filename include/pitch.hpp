@@ -19,9 +19,9 @@
 
 #pragma once
 
-#include <deque>
 #include "SoundTouch.h"
 #include "plugin_base.hpp"
+#include "stereo_ring.hpp"
 
 class Pitch : public PluginBase {
  public:
@@ -55,28 +55,27 @@ class Pitch : public PluginBase {
 
   std::vector<float> data_L, data_R, data;
 
-  std::deque<float> deque_out_L, deque_out_R;
+  StereoRing output_ring;
 
   soundtouch::SoundTouch* snd_touch = nullptr;
 
-  bool anti_alias = false;
-  bool quick_seek = false;
-
-  int sequence_length_ms = 40;
-  int seek_window_ms = 15;
-  int overlap_length_ms = 8;
-
-  double semitones = 0.0;
-  double tempo_difference = 0.0;
-  double rate_difference = 0.0;
-
-  void set_semitones();
-  void set_sequence_length();
-  void set_seek_window();
-  void set_overlap_length();
-  void set_quick_seek();
-  void set_anti_alias();
-  void set_tempo_difference();
-  void set_rate_difference();
+  struct Params {
+    bool anti_alias = false;
+    bool quick_seek = false;
+
+    int sequence_length_ms = 40;
+    int seek_window_ms = 15;
+    int overlap_length_ms = 8;
+
+    double semitones = 0.0;
+    double tempo_difference = 0.0;
+    double rate_difference = 0.0;
+  };
+
+  ParameterSnapshot<Params> params;
+
+  void apply_settings();
+
+  void apply_params(const Params& p);
   void init_soundtouch();
 };
@@ -21,10 +21,17 @@
 
 #include <pipewire/filter.h>
 #include <spa/param/latency-utils.h>
+#include <atomic>
 #include <mutex>
 #include <ranges>
 #include <span>
+#include <thread>
+#include <vector>
+#include "dsp_kernels.hpp"  // IWYU pragma: export
+#include "dsp_load.hpp"
 #include "lv2_wrapper.hpp"
+#include "notification_ring.hpp"
+#include "parameter_snapshot.hpp"  // IWYU pragma: export
 #include "pipe_manager.hpp"
 #include "tags_plugin_name.hpp"  // IWYU pragma: export
 
@@ -60,6 +67,8 @@ class PluginBase {
     struct port* probe_right = nullptr;
 
     PluginBase* pb = nullptr;
+
+    PipeManager* pm = nullptr;
   };
 
   const std::string log_tag;
@@ -92,6 +101,8 @@ class PluginBase {
 
   float latency_value = 0.0F;  // seconds
 
+  uint64_t clock_position = 0U;  // graph position of the first frame of the current quantum
+
   std::chrono::time_point<std::chrono::system_clock> clock_start;
 
   std::vector<float> dummy_left, dummy_right;
@@ -104,6 +115,15 @@ class PluginBase {
 
   auto connect_to_pw() -> bool;
 
+  /*
+    connect_to_pw() in two steps. Many filters can be started before waiting for any of them. So PipeWire sets them
+    up at the same time.
+  */
+
+  auto start_connect_to_pw() -> bool;
+
+  auto wait_connected_to_pw() -> bool;
+
   void disconnect_from_pw();
 
   void reset_settings();
@@ -114,8 +134,43 @@ class PluginBase {
 
   void set_native_ui_update_frequency(const uint& value);
 
+  /*
+    Per quantum bookkeeping done before and after process(): calling setup() when the quantum or the sampling rate
+    change and managing the notifications clock. They are called by our PipeWire process callback and also by
+    FusedChain when the plugin is running inside a fused node.
+  */
+
+  void begin_quantum(const uint& n_samples, const uint& rate, const uint64_t& position);
+
+  void end_quantum();
+
+  /*
+    One quantum outside of a PipeWire graph. It does what our process callback does for the given buffers. Plugins
+    with a probe get silence on it. Used by the offline tools on plugins created without a PipeManager.
+  */
+
+  void process_quantum(std::span<float>& left_in,
+                       std::span<float>& right_in,
+                       std::span<float>& left_out,
+                       std::span<float>& right_out,
+                       const uint& rate,
+                       const uint64_t& position);
+
   virtual void setup();
 
+  // Blocks until the work setup() handed to other threads is done. The offline tools call it before processing
+
+  virtual void wait_for_setup();
+
+  /*
+    Discards the audio the plugin holds from its last use. EffectsBase calls it in the main thread when an instance is
+    taken from the pool, while its filter is still inactive. By default the LV2 instance is deactivated and activated
+    again and setup() is run again, which rebuilds the rings, the engines and the latency of the plugins that have
+    them. What only the realtime thread may touch is cleared by clear_state() at the start of the next quantum.
+  */
+
+  virtual void reset();
+
   virtual void process(std::span<float>& left_in,
                        std::span<float>& right_in,
                        std::span<float>& left_out,
@@ -132,13 +187,114 @@ class PluginBase {
 
   virtual auto get_latency_seconds() -> float;
 
+  /*
+    True if process() still works when the output spans are the same memory as the input ones. FusedChain uses it to
+    avoid copying between its scratch buffers. By default only LV2 plugins that do not declare lv2:inPlaceBroken can.
+  */
+
+  [[nodiscard]] virtual auto can_process_in_place() const -> bool;
+
+  /*
+    True if the plugin has to reblock the audio when the quantum is not a power of 2. EffectsBase asks the graph for a
+    power of 2 quantum while one of these is in the chain.
+  */
+
+  [[nodiscard]] virtual auto needs_power_of_2_blocks() const -> bool;
+
+  /*
+    Silence stable plugins output digital silence once their tail has been flushed when their input is digital
+    silence. process() is not called for them while that lasts. The tail is the reported latency plus the time given
+    by get_tail_seconds().
+  */
+
+  [[nodiscard]] virtual auto is_silence_stable() const -> bool;
+
+  virtual auto get_tail_seconds() -> float;
+
+  /*
+    Called before process(). It returns true and writes zeros to the output when the quantum can be skipped. The first
+    quantum with signal is processed normally so nothing is lost when the audio comes back.
+  */
+
+  auto skip_silent_quantum(const std::span<float>& left_in,
+                           const std::span<float>& right_in,
+                           std::span<float>& left_out,
+                           std::span<float>& right_out) -> bool;
+
+  /*
+    Latency measurement. While the probe is armed the realtime thread records the mono mix of the input and of the
+    output of the plugin in buffers allocated by arm_latency_probe. Samples are stored at their graph position relative
+    to the first quantum seen, so skipped quanta leave silence instead of shifting what follows. EffectsBase looks for
+    the measurement sequence in the recordings after disarming the probe. When silence_output is set the output is
+    muted after it is recorded, so the sequence does not reach the speakers or the recording apps.
+  */
+
+  struct LatencyProbe {
+    std::atomic<bool> armed = false;
+    std::atomic<bool> writing = false;
+
+    bool silence_output = false;
+
+    std::vector<float> input, output;
+
+    std::atomic<size_t> input_count = 0U, output_count = 0U;
+
+    std::atomic<uint64_t> input_start = 0U, output_start = 0U;
+
+    std::atomic<bool> input_started = false, output_started = false;
+  };
+
+  LatencyProbe latency_probe;
+
+  void arm_latency_probe(const size_t& capacity, const bool& silence_output = false);
+
+  // waits for the realtime thread to leave probe_latency. After it returns the recordings can be read
+
+  void disarm_latency_probe();
+
+  void probe_latency(const std::span<float>& left, const std::span<float>& right, const bool& output);
+
+  /*
+    Time spent in process(). Our PipeWire callback and FusedChain record it after each call. When dsp_cycle is set the
+    record is also used to find the plugin to blame for the cycles in which the chain overran the quantum.
+  */
+
+  DspLoad dsp_load;
+
+  DspCycle* dsp_cycle = nullptr;
+
+  void record_dsp_load(const std::chrono::steady_clock::duration& elapsed);
+
+  // sets node.latency to quantum/rate. A quantum equal to zero removes our request
+
+  void request_quantum(const uint& quantum, const uint& rate);
+
+  /*
+    Main thread side of the notifications. Called by a main loop timer shared by all plugins. It empties the records
+    the realtime thread left in our ring and emits the corresponding signals.
+  */
+
+  virtual void dispatch_notifications();
+
   sigc::signal<void(const float, const float)> input_level;
   sigc::signal<void(const float, const float)> output_level;
   sigc::signal<void()> latency;
 
+  // the quantum the graph is really running us with. Emitted when it changes even if post_messages is false
+
+  sigc::signal<void(const uint&)> negotiated_quantum;
+
  protected:
   std::mutex data_mutex;
 
+  /*
+    Removes us from the notifications drain. The base destructor does it too but by then the subclass members were
+    already destroyed. Subclasses whose dispatch_notifications() or meters read their own members have to call this
+    at the beginning of their destructors.
+  */
+
+  void stop_notifications();
+
   GSettings* settings = nullptr;
 
   PipeManager* pm = nullptr;
@@ -151,6 +307,18 @@ class PluginBase {
 
   uint n_ports = 4U;
 
+  uint requested_quantum = 0U;
+
+  uint silent_frames = 0U;
+
+  bool suspended_by_silence = false;
+
+  std::atomic<bool> reset_requested = false;
+
+  // realtime side of reset(). It must only clear buffers. Nothing is allocated or freed here
+
+  virtual void clear_state();
+
   float input_gain = 1.0F;
   float output_gain = 1.0F;
 
@@ -158,12 +326,43 @@ class PluginBase {
 
   std::vector<gulong> gconnections;
 
+  static constexpr uint max_meter_values = 32U;
+
+  struct Notification {
+    float input_left = util::minimum_db_level, input_right = util::minimum_db_level;
+    float output_left = util::minimum_db_level, output_right = util::minimum_db_level;
+
+    std::array<double, max_meter_values> meters{};
+  };
+
+  NotificationRing<Notification> notifications{16U};
+
+  /*
+    A latency or quantum change must not be lost when the ring is full like a levels record can. So they are not sent
+    through the ring. The realtime thread only stores them here and the main thread takes them.
+  */
+
+  std::atomic<bool> latency_changed = false;
+
+  std::atomic<uint> changed_quantum = 0U;
+
   void setup_input_output_gain();
 
   void initialize_listener();
 
   void notify();
 
+  void notify_latency_change();
+
+  /*
+    Plugins with extra meters copy them to the notification record in the realtime thread with pack_meters() and read
+    them back in the main thread with emit_meters().
+  */
+
+  virtual void pack_meters(std::span<double> values);
+
+  virtual void emit_meters(std::span<const double> values);
+
   void get_peaks(const std::span<float>& left_in,
                  const std::span<float>& right_in,
                  std::span<float>& left_out,
@@ -171,6 +370,22 @@ class PluginBase {
 
   static void apply_gain(std::span<float>& left, std::span<float>& right, const float& gain);
 
+  /*
+    Apply the input or output gain and measure the peaks shown by the level meters in the same pass over the samples.
+    The input peaks are measured before the samples are processed. So they are right even when processing in place.
+  */
+
+  void apply_input_gain(std::span<float>& left, std::span<float>& right);
+
+  void apply_output_gain(std::span<float>& left, std::span<float>& right);
+
+  // copies the input to the output unless they are the same buffers
+
+  static void passthrough(const std::span<float>& left_in,
+                          const std::span<float>& right_in,
+                          std::span<float>& left_out,
+                          std::span<float>& right_out);
+
   void update_filter_params();
 
  private:
@@ -178,4 +393,6 @@ class PluginBase {
 
   float input_peak_left = util::minimum_linear_level, input_peak_right = util::minimum_linear_level;
   float output_peak_left = util::minimum_linear_level, output_peak_right = util::minimum_linear_level;
+
+  Notification last_notification;
 };
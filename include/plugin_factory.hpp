@@ -0,0 +1,39 @@
+/*
+ *  Copyright © 2017-2023 Wellington Wallace
+ *
+ *  This file is part of Easy Effects.
+ *
+ *  Easy Effects is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Easy Effects is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Easy Effects. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <memory>
+#include <string>
+#include "plugin_base.hpp"
+
+namespace plugin_factory {
+
+/*
+  Creates the plugin for a list entry like "compressor#1". Its settings are read from the instance path under
+  schema_base_path. A null pipe manager creates the plugin without a PipeWire filter. A null pointer is returned if
+  the name is not known.
+*/
+
+auto create(const std::string& name,
+            const std::string& log_tag,
+            const std::string& schema_base_path,
+            PipeManager* pm) -> std::shared_ptr<PluginBase>;
+
+}  // namespace plugin_factory
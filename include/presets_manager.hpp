@@ -95,6 +95,10 @@ class PresetsManager {
 
   auto load_preset_file(const PresetType& preset_type, const std::string& name) -> bool;
 
+  // loads a preset file that may be outside of our presets directories
+
+  auto load_preset_from_path(const PresetType& preset_type, const std::filesystem::path& input_file) -> bool;
+
   auto read_plugins_preset(const PresetType& preset_type,
                            const std::vector<std::string>& plugins,
                            const nlohmann::json& json) -> bool;
@@ -23,9 +23,9 @@
 #include <rnnoise.h>
 #endif
 
-#include <deque>
 #include "plugin_base.hpp"
 #include "resampler.hpp"
+#include "stereo_ring.hpp"
 
 class RNNoise : public PluginBase {
  public:
@@ -45,6 +45,10 @@ class RNNoise : public PluginBase {
 
   auto get_latency_seconds() -> float override;
 
+  [[nodiscard]] auto is_silence_stable() const -> bool override;
+
+  auto get_tail_seconds() -> float override;
+
   void init_release();
 
 #ifndef ENABLE_RNNOISE
@@ -60,19 +64,25 @@ class RNNoise : public PluginBase {
   bool notify_latency = false;
   bool rnnoise_ready = false;
   bool resampler_ready = false;
-  bool enable_vad = false;
 
   uint blocksize = 480U;
   uint rnnoise_rate = 48000U;
   uint latency_n_frames = 0U;
 
-  float vad_thres = 0.95F;
-  float wet_ratio = 1.0F;
-  uint release = 2U;
+  struct Params {
+    bool enable_vad = false;
+
+    float vad_thres = 0.95F;
+    float wet_ratio = 1.0F;
+
+    int release = 2;
+  };
+
+  ParameterSnapshot<Params> params;
 
   const float inv_short_max = 1.0F / (SHRT_MAX + 1.0F);
 
-  std::deque<float> deque_out_L, deque_out_R;
+  StereoRing input_ring, denoised_ring, output_ring;
 
   std::vector<float> data_L, data_R, data_tmp;
   std::vector<float> resampled_data_L, resampled_data_R;
@@ -91,96 +101,55 @@ class RNNoise : public PluginBase {
 
   auto get_model_from_file() -> RNNModel*;
 
-  void free_rnnoise();
-
-  template <typename T1, typename T2>
-  void remove_noise(const T1& left_in, const T1& right_in, T2& out_L, T2& out_R) {
-    for (const auto& v : left_in) {
-      data_L.push_back(v);
-
-      if (data_L.size() == blocksize) {
-        if (state_left != nullptr) {
-          std::ranges::for_each(data_L, [](auto& v) { v *= static_cast<float>(SHRT_MAX + 1); });
-
-          data_tmp = data_L;
-
-          vad_prob_left = rnnoise_process_frame(state_left, data_L.data(), data_L.data());
-
-          if (enable_vad) {
-            if (vad_prob_left >= vad_thres) {
-              vad_grace_left = release;
-            }
+  void load_model();
 
-            if (vad_grace_left >= 0) {
-              --vad_grace_left;
-
-              for (size_t i = 0U; i < data_L.size(); i++) {
-                data_L[i] = data_L[i] * wet_ratio + data_tmp[i] * (1.0F - wet_ratio);
+  void free_rnnoise();
 
-                data_L[i] *= inv_short_max;
-              }
-            } else {
-              std::ranges::for_each(data_L, [&](auto& v) { v = 0.0F; });
-            }
-          } else {
-            for (size_t i = 0U; i < data_L.size(); i++) {
-              data_L[i] = data_L[i] * wet_ratio + data_tmp[i] * (1.0F - wet_ratio);
+  void remove_noise(std::span<const float> left_in,
+                    std::span<const float> right_in,
+                    StereoRing& out,
+                    const Params& p) {
+    input_ring.push(left_in, right_in);
 
-              data_L[i] *= inv_short_max;
-            }
-          }
-        }
+    while (input_ring.size() >= blocksize) {
+      input_ring.pop(data_L, data_R);
 
-        for (const auto& v : data_L) {
-          out_L.push_back(v);
-        }
+      denoise(state_left, data_L, vad_prob_left, vad_grace_left, p);
+      denoise(state_right, data_R, vad_prob_right, vad_grace_right, p);
 
-        data_L.resize(0U);
-      }
+      out.push(data_L, data_R);
     }
+  }
 
-    for (const auto& v : right_in) {
-      data_R.push_back(v);
-
-      if (data_R.size() == blocksize) {
-        if (state_right != nullptr) {
-          std::ranges::for_each(data_R, [](auto& v) { v *= static_cast<float>(SHRT_MAX + 1); });
+  void denoise(DenoiseState* state, std::vector<float>& data, float& vad_prob, int& vad_grace, const Params& p) {
+    if (state == nullptr) {
+      return;
+    }
 
-          data_tmp = data_R;
+    std::ranges::for_each(data, [](auto& v) { v *= static_cast<float>(SHRT_MAX + 1); });
 
-          vad_prob_right = rnnoise_process_frame(state_right, data_R.data(), data_R.data());
+    data_tmp = data;
 
-          if (enable_vad) {
-            if (vad_prob_right >= vad_thres) {
-              vad_grace_right = release;
-            }
+    vad_prob = rnnoise_process_frame(state, data.data(), data.data());
 
-            if (vad_grace_right >= 0) {
-              --vad_grace_right;
+    if (p.enable_vad) {
+      if (vad_prob >= p.vad_thres) {
+        vad_grace = p.release;
+      }
 
-              for (size_t i = 0U; i < data_R.size(); i++) {
-                data_R[i] = data_R[i] * wet_ratio + data_tmp[i] * (1.0F - wet_ratio);
+      if (vad_grace < 0) {
+        std::ranges::fill(data, 0.0F);
 
-                data_R[i] *= inv_short_max;
-              }
-            } else {
-              std::ranges::for_each(data_R, [&](auto& v) { v = 0.0F; });
-            }
-          } else {
-            for (size_t i = 0U; i < data_R.size(); i++) {
-              data_R[i] = data_R[i] * wet_ratio + data_tmp[i] * (1.0F - wet_ratio);
+        return;
+      }
 
-              data_R[i] *= inv_short_max;
-            }
-          }
-        }
+      --vad_grace;
+    }
 
-        for (const auto& v : data_R) {
-          out_R.push_back(v);
-        }
+    for (size_t i = 0U; i < data.size(); i++) {
+      data[i] = data[i] * p.wet_ratio + data_tmp[i] * (1.0F - p.wet_ratio);
 
-        data_R.resize(0U);
-      }
+      data[i] *= inv_short_max;
     }
   }
 
@@ -20,7 +20,10 @@
 #pragma once
 
 #include <fftw3.h>
+#include <atomic>
 #include <numbers>
+#include <semaphore>
+#include <thread>
 #include "plugin_base.hpp"
 
 class Spectrum : public PluginBase {
@@ -44,6 +47,8 @@ class Spectrum : public PluginBase {
 
   auto get_latency_seconds() -> float override;
 
+  void dispatch_notifications() override;
+
   sigc::signal<void(uint, uint, std::vector<double>)> power;  // rate, nbands, magnitudes
 
  private:
@@ -53,10 +58,60 @@ class Spectrum : public PluginBase {
 
   fftwf_complex* complex_output = nullptr;
 
+  uint n_bands = 8192U;
+
   std::vector<float> real_input;
-  std::vector<double> output;
+  std::vector<float> hann_window;
+  std::vector<float> history;
+  std::vector<float> rt_mono;
 
-  uint n_bands = 8192U;
+  size_t history_position = 0U;
+
+  /*
+    The realtime thread only downmixes the input into this ring. The FFT is done by analysis_thread at the rate the
+    meters are updated.
+  */
+
+  NotificationRing<float> samples{2U * n_bands};
+
+  std::atomic<uint> analysis_rate = 0U;
+
+  std::atomic<bool> analysis_requested = false;
+
+  std::atomic<bool> analysis_running = true;
+
+  /*
+    Released by the realtime thread when a transform is requested or the samples ring is getting full. A binary
+    semaphore must not be released again before it is acquired. So wake_pending keeps only one release pending.
+  */
+
+  std::binary_semaphore analysis_wakeup{0};
+
+  std::atomic<bool> wake_pending = false;
+
+  size_t unannounced_samples = 0U;  // only used by the realtime thread
+
+  struct Frame {
+    uint rate = 0U;
+
+    std::vector<double> magnitudes;
+  };
+
+  /*
+    All the frames have their final size from the start. So copying one into the ring does not allocate.
+  */
+
+  Frame analysis_frame{.rate = 0U, .magnitudes = std::vector<double>(n_bands / 2U + 1U)};
+
+  Frame last_frame = analysis_frame;
+
+  NotificationRing<Frame> frames{4U, analysis_frame};
+
+  std::thread analysis_thread;
+
+  void analyze();
+
+  void analysis_loop();
 
-  std::deque<float> deque_in_mono;
+  void wake_analysis();
 };
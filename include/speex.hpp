@@ -44,12 +44,16 @@ class Speex : public PluginBase {
  private:
   bool speex_ready = false;
 
-  int enable_denoise = 0, noise_suppression = -15, enable_agc = 0, enable_vad = 0, vad_probability_start = 95,
-      vad_probability_continue = 90, enable_dereverb = 0;
+  struct Params {
+    int enable_denoise = 0, noise_suppression = -15, enable_agc = 0, enable_vad = 0, vad_probability_start = 95,
+        vad_probability_continue = 90, enable_dereverb = 0;
+  };
 
-  uint latency_n_frames = 0U;
+  ParameterSnapshot<Params> params;
+
+  uint64_t applied_serial = 0U;
 
-  const float inv_short_max = 1.0F / (SHRT_MAX + 1);
+  uint latency_n_frames = 0U;
 
   std::vector<spx_int16_t> data_L, data_R;
 
@@ -57,4 +61,6 @@ class Speex : public PluginBase {
 
   void free_speex();
 
+  void apply_params(const Params& p);
+
 };
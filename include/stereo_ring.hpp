@@ -0,0 +1,121 @@
+/*
+ *  Copyright © 2017-2023 Wellington Wallace
+ *
+ *  This file is part of Easy Effects.
+ *
+ *  Easy Effects is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Easy Effects is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Easy Effects. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <span>
+#include <vector>
+
+/*
+  Fixed capacity FIFO holding the two channels of a plugin. It is used by the plugins that have to process the audio
+  in blocks of a size different from the quantum or that produce a variable number of samples. The memory is allocated
+  only by resize() so it can be used inside process(). The data goes in and out in at most two contiguous copies per
+  channel. It is not thread safe. Both sides must be used by the same thread.
+*/
+
+class StereoRing {
+ public:
+  void resize(const size_t& capacity) {
+    buffer_L.assign(capacity, 0.0F);
+    buffer_R.assign(capacity, 0.0F);
+
+    clear();
+  }
+
+  void clear() {
+    read_position = 0U;
+    n_frames = 0U;
+  }
+
+  [[nodiscard]] auto size() const -> size_t { return n_frames; }
+
+  [[nodiscard]] auto capacity() const -> size_t { return buffer_L.size(); }
+
+  // Returns the number of frames stored. What does not fit is discarded.
+
+  auto push(std::span<const float> left, std::span<const float> right) -> size_t {
+    const auto count = std::min({left.size(), right.size(), capacity() - n_frames});
+
+    if (count == 0U) {
+      return 0U;
+    }
+
+    const auto write_position = (read_position + n_frames) % capacity();
+    const auto first = std::min(count, capacity() - write_position);
+
+    std::copy_n(left.begin(), first, buffer_L.begin() + write_position);
+    std::copy_n(right.begin(), first, buffer_R.begin() + write_position);
+
+    std::copy_n(left.begin() + first, count - first, buffer_L.begin());
+    std::copy_n(right.begin() + first, count - first, buffer_R.begin());
+
+    n_frames += count;
+
+    return count;
+  }
+
+  // Returns the number of frames copied to the destination
+
+  auto pop(std::span<float> left, std::span<float> right) -> size_t {
+    const auto count = std::min({left.size(), right.size(), n_frames});
+
+    if (count == 0U) {
+      return 0U;
+    }
+
+    const auto first = std::min(count, capacity() - read_position);
+
+    std::copy_n(buffer_L.begin() + read_position, first, left.begin());
+    std::copy_n(buffer_R.begin() + read_position, first, right.begin());
+
+    std::copy_n(buffer_L.begin(), count - first, left.begin() + first);
+    std::copy_n(buffer_R.begin(), count - first, right.begin() + first);
+
+    read_position = (read_position + count) % capacity();
+
+    n_frames -= count;
+
+    return count;
+  }
+
+  /*
+    Fills the whole destination. When there are not enough frames the missing ones are written as silence at the
+    beginning. This delays everything that comes after by the same amount. The number of silent frames is returned so
+    the caller can account for the extra latency.
+  */
+
+  auto pop_or_pad(std::span<float> left, std::span<float> right) -> size_t {
+    const auto missing = left.size() > n_frames ? left.size() - n_frames : 0U;
+
+    std::fill_n(left.begin(), missing, 0.0F);
+    std::fill_n(right.begin(), missing, 0.0F);
+
+    pop(left.subspan(missing), right.subspan(missing));
+
+    return missing;
+  }
+
+ private:
+  size_t read_position = 0U;
+  size_t n_frames = 0U;
+
+  std::vector<float> buffer_L, buffer_R;
+};
@@ -42,6 +42,8 @@ class StereoTools : public PluginBase {
 
   auto get_latency_seconds() -> float override;
 
+  [[nodiscard]] auto can_process_in_place() const -> bool override;
+
   double correlation_port_value = 0.0;
 
  private:
@@ -39,7 +39,11 @@ class StreamOutputEffects : public EffectsBase {
 
   void disconnect_filters();
 
-  auto apps_want_to_play() -> bool;
+  // relinks only the part of the chain affected by a change of the plugins list
+
+  void update_chain();
+
+  auto apps_want_to_play() -> bool override;
 
   void on_app_added(NodeInfo node_info);
 
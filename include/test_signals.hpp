@@ -20,9 +20,12 @@
 #pragma once
 
 #include <pipewire/filter.h>
+#include <atomic>
 #include <numbers>
+#include <optional>
 #include <random>
 #include <span>
+#include <vector>
 #include "pipe_manager.hpp"
 
 enum class TestSignalType { sine_wave, gaussian, pink };
@@ -81,6 +84,35 @@ class TestSignals {
 
   auto white_noise() -> float;
 
+  /*
+    Latency measurement. The generator is linked to target_node_id and stays silent except for one period of a maximum
+    length sequence sent after a short time, so the new links are already streaming when it starts. The sequence is
+    found again by cross-correlation. Unlike a single impulse it is not confused with a loud sample of the audio going
+    through the chain, and its energy is spread over many samples so a low level is enough. Stopping the measurement
+    returns the graph position of the first sample of the sequence if it was sent. It can not be started while the
+    test signal is enabled.
+  */
+
+  auto start_latency_measurement(const uint& target_node_id) -> bool;
+
+  auto stop_latency_measurement() -> std::optional<uint64_t>;
+
+  std::atomic<bool> measuring = false;
+
+  std::atomic<bool> probe_sent = false;
+
+  std::atomic<uint64_t> probe_position = 0U;
+
+  uint64_t measurement_frames = 0U;
+
+  size_t probe_index = 0U;
+
+  static constexpr uint probe_order = 14U;
+
+  static constexpr float probe_amplitude = 0.1F;
+
+  const std::vector<float> probe_sequence;
+
  private:
   PipeManager* pm = nullptr;
 
@@ -90,7 +122,7 @@ class TestSignals {
 
   uint node_id = 0U;
 
-  std::vector<pw_proxy*> list_proxies;
+  std::vector<pw_proxy*> list_proxies, measurement_proxies;
 
   std::random_device rd{};
 
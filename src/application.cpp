@@ -20,6 +20,7 @@
 #include "application.hpp"
 #include "application_ui.hpp"
 #include "config.h"
+#include "dsp_kernels.hpp"
 #include "preferences_window.hpp"
 #include "tags_app.hpp"
 
@@ -59,6 +60,8 @@ void on_startup(GApplication* gapp) {
 
   self->data = new Data();
 
+  util::debug("audio processing kernels: "s + dsp::instruction_set());
+
   self->sie_settings = g_settings_new(tags::schema::id_input);
   self->soe_settings = g_settings_new(tags::schema::id_output);
 
@@ -88,6 +88,8 @@ AutoGain::AutoGain(const std::string& tag,
 }
 
 AutoGain::~AutoGain() {
+  stop_notifications();
+
   if (connected_to_pw) {
     disconnect_from_pw();
   }
@@ -213,14 +215,9 @@ void AutoGain::process(std::span<float>& left_in,
     return;
   }
 
-  if (input_gain != 1.0F) {
-    apply_gain(left_in, right_in, input_gain);
-  }
+  apply_input_gain(left_in, right_in);
 
-  for (size_t n = 0U; n < n_samples; n++) {
-    data[2U * n] = left_in[n];
-    data[2U * n + 1U] = right_in[n];
-  }
+  dsp::interleave(left_in, right_in, data);
 
   ebur128_add_frames_float(ebur_state, data.data(), n_samples);
 
@@ -362,21 +359,27 @@ void AutoGain::process(std::span<float>& left_in,
     apply_gain(left_out, right_out, static_cast<float>(internal_output_gain));
   }
 
-  if (output_gain != 1.0F) {
-    apply_gain(left_out, right_out, output_gain);
-  }
-
-  if (post_messages) {
-    get_peaks(left_in, right_in, left_out, right_out);
-
-    if (send_notifications) {
-      results.emit(loudness, internal_output_gain, momentary, shortterm, global, relative, range);
+  apply_output_gain(left_out, right_out);
 
-      notify();
-    }
+  if (post_messages && send_notifications) {
+    notify();
   }
 }
 
 auto AutoGain::get_latency_seconds() -> float {
   return 0.0F;
 }
+
+void AutoGain::pack_meters(std::span<double> values) {
+  values[0] = loudness;
+  values[1] = internal_output_gain;
+  values[2] = momentary;
+  values[3] = shortterm;
+  values[4] = global;
+  values[5] = relative;
+  values[6] = range;
+}
+
+void AutoGain::emit_meters(std::span<const double> values) {
+  results.emit(values[0], values[1], values[2], values[3], values[4], values[5], values[6]);
+}
@@ -32,6 +32,8 @@ BassEnhancer::BassEnhancer(const std::string& tag,
     util::debug(log_tag + "http://calf.sourceforge.net/plugins/BassEnhancer is not installed");
   }
 
+  meter_drive_port = lv2_wrapper->get_control_port_index("meter_drive");
+
   lv2_wrapper->bind_key_double_db<"amount", "amount">(settings);
 
   lv2_wrapper->bind_key_double<"drive", "harmonics">(settings);
@@ -50,6 +52,8 @@ BassEnhancer::BassEnhancer(const std::string& tag,
 }
 
 BassEnhancer::~BassEnhancer() {
+  stop_notifications();
+
   if (connected_to_pw) {
     disconnect_from_pw();
   }
@@ -80,31 +84,23 @@ void BassEnhancer::process(std::span<float>& left_in,
     return;
   }
 
-  if (input_gain != 1.0F) {
-    apply_gain(left_in, right_in, input_gain);
-  }
+  apply_input_gain(left_in, right_in);
 
   lv2_wrapper->connect_data_ports(left_in, right_in, left_out, right_out);
   lv2_wrapper->run();
 
-  if (output_gain != 1.0F) {
-    apply_gain(left_out, right_out, output_gain);
-  }
+  apply_output_gain(left_out, right_out);
 
   if (post_messages) {
-    get_peaks(left_in, right_in, left_out, right_out);
-
     if (send_notifications) {
       // harmonics needed as double for levelbar widget ui, so we convert it here
 
-      harmonics_port_value = static_cast<double>(lv2_wrapper->get_control_port_value("meter_drive"));
+      harmonics_port_value = static_cast<double>(lv2_wrapper->get_control_port_value(meter_drive_port));
 
       if (!post_messages) {
         return;
       }
 
-      harmonics.emit(harmonics_port_value);
-
       notify();
     }
   }
@@ -113,3 +109,11 @@ void BassEnhancer::process(std::span<float>& left_in,
 auto BassEnhancer::get_latency_seconds() -> float {
   return 0.0F;
 }
+
+void BassEnhancer::pack_meters(std::span<double> values) {
+  values[0] = harmonics_port_value;
+}
+
+void BassEnhancer::emit_meters(std::span<const double> values) {
+  harmonics.emit(values[0]);
+}
@@ -18,14 +18,85 @@
  */
 
 #include "convolver.hpp"
-#include <sndfile.hh>
-#include "resampler.hpp"
 
 namespace {
 
-constexpr auto CONVPROC_SCHEDULER_PRIORITY = 0;
+/*
+  Homomorphic method. The real cepstrum of the kernel is folded over its causal part. The exponential of its spectrum
+  has the same magnitude as the kernel and a minimum phase.
+*/
+
+void make_minimum_phase(std::vector<float>& kernel) {
+  float peak = 0.0F;
+
+  for (const auto& v : kernel) {
+    peak = std::max(peak, std::fabs(v));
+  }
+
+  if (peak == 0.0F) {
+    return;
+  }
+
+  // padding reduces the time aliasing of the cepstrum
+
+  size_t n = 1U;
+
+  while (n < 4U * kernel.size()) {
+    n *= 2U;
+  }
+
+  std::vector<float> time(n, 0.0F);
+  std::vector<std::complex<float>> spectrum(n / 2U + 1U);
+
+  auto* spectrum_ptr = reinterpret_cast<fftwf_complex*>(spectrum.data());
+
+  auto* forward = fftwf_plan_dft_r2c_1d(static_cast<int>(n), time.data(), spectrum_ptr, FFTW_ESTIMATE);
+  auto* backward = fftwf_plan_dft_c2r_1d(static_cast<int>(n), spectrum_ptr, time.data(), FFTW_ESTIMATE);
+
+  std::ranges::copy(kernel, time.begin());
 
-constexpr auto CONVPROC_SCHEDULER_CLASS = SCHED_FIFO;
+  fftwf_execute(forward);
+
+  float max_magnitude = 0.0F;
+
+  for (const auto& v : spectrum) {
+    max_magnitude = std::max(max_magnitude, std::abs(v));
+  }
+
+  // the floor keeps the logarithm finite at the zeros of the spectrum. It is 200 dB below its peak
+
+  const auto floor = 1e-10F * max_magnitude;
+
+  for (auto& v : spectrum) {
+    v = std::log(std::max(std::abs(v), floor));
+  }
+
+  fftwf_execute(backward);
+
+  const auto scale = 1.0F / static_cast<float>(n);
+
+  time[0] *= scale;
+  time[n / 2U] *= scale;
+
+  for (size_t k = 1U; k < n / 2U; k++) {
+    time[k] *= 2.0F * scale;
+  }
+
+  std::fill(time.begin() + static_cast<long>(n / 2U) + 1, time.end(), 0.0F);
+
+  fftwf_execute(forward);
+
+  for (auto& v : spectrum) {
+    v = std::exp(v) * scale;
+  }
+
+  fftwf_execute(backward);
+
+  std::copy(time.begin(), time.begin() + static_cast<long>(kernel.size()), kernel.begin());
+
+  fftwf_destroy_plan(forward);
+  fftwf_destroy_plan(backward);
+}
 
 }  // namespace
 
@@ -33,24 +104,26 @@ Convolver::Convolver(const std::string& tag,
                      const std::string& schema,
                      const std::string& schema_path,
                      PipeManager* pipe_manager)
-    : PluginBase(tag, tags::plugin_name::convolver, tags::plugin_package::zita, schema, schema_path, pipe_manager),
+    : PluginBase(tag, tags::plugin_name::convolver, tags::plugin_package::ee, schema, schema_path, pipe_manager),
       do_autogain(g_settings_get_boolean(settings, "autogain") != 0),
+      trim_ir(g_settings_get_boolean(settings, "trim-ir") != 0),
+      minimum_phase(g_settings_get_boolean(settings, "minimum-phase") != 0),
+      trim_threshold(static_cast<float>(g_settings_get_double(settings, "trim-threshold"))),
       ir_width(g_settings_get_int(settings, "ir-width")) {
+  /*
+    The engines are built and destroyed by worker threads while other plugins use fftw in the main thread. Its planner
+    has to be told about that.
+  */
+
+  fftwf_make_planner_thread_safe();
+
   gconnections.push_back(g_signal_connect(settings, "changed::ir-width",
                                           G_CALLBACK(+[](GSettings* settings, char* key, gpointer user_data) {
                                             auto* self = static_cast<Convolver*>(user_data);
 
                                             self->ir_width = g_settings_get_int(self->settings, key);
 
-                                            std::scoped_lock<std::mutex> lock(self->data_mutex);
-
-                                            if (self->kernel_is_initialized) {
-                                              self->kernel_L = self->original_kernel_L;
-                                              self->kernel_R = self->original_kernel_R;
-
-                                              self->set_kernel_stereo_width();
-                                              self->apply_kernel_autogain();
-                                            }
+                                            self->prepare_kernel();
                                           }),
                                           this));
 
@@ -72,258 +145,417 @@ Convolver::Convolver(const std::string& tag,
                                           }),
                                           this));
 
+  gconnections.push_back(g_signal_connect(settings, "changed::trim-ir",
+                                          G_CALLBACK(+[](GSettings* settings, char* key, gpointer user_data) {
+                                            auto* self = static_cast<Convolver*>(user_data);
+
+                                            self->trim_ir = g_settings_get_boolean(settings, key) != 0;
+
+                                            self->prepare_kernel();
+                                          }),
+                                          this));
+
+  gconnections.push_back(g_signal_connect(settings, "changed::trim-threshold",
+                                          G_CALLBACK(+[](GSettings* settings, char* key, gpointer user_data) {
+                                            auto* self = static_cast<Convolver*>(user_data);
+
+                                            const auto v = g_settings_get_double(settings, key);
+
+                                            self->trim_threshold = static_cast<float>(v);
+
+                                            self->prepare_kernel();
+                                          }),
+                                          this));
+
+  gconnections.push_back(g_signal_connect(settings, "changed::minimum-phase",
+                                          G_CALLBACK(+[](GSettings* settings, char* key, gpointer user_data) {
+                                            auto* self = static_cast<Convolver*>(user_data);
+
+                                            self->minimum_phase = g_settings_get_boolean(settings, key) != 0;
+
+                                            self->prepare_kernel();
+                                          }),
+                                          this));
+
   setup_input_output_gain();
+
+  kernel_worker = std::thread([this] { kernel_worker_loop(); });
 }
 
 Convolver::~Convolver() {
+  stop_notifications();
+
   if (connected_to_pw) {
     disconnect_from_pw();
   }
 
-  for (auto& t : mythreads) {
-    t.join();
-  }
-
-  mythreads.clear();
+  // the worker gives up the engine it may be building and leaves its loop
 
-  std::scoped_lock<std::mutex> lock(data_mutex);
+  {
+    std::scoped_lock<std::mutex> lock(worker_mutex);
 
-  ready = false;
+    worker_running = false;
 
-  if (conv != nullptr) {
-    conv->stop_process();
+    kernel_request++;
+  }
 
-    conv->cleanup();
+  worker_cv.notify_one();
 
-    delete conv;
+  if (kernel_worker.joinable()) {
+    kernel_worker.join();
   }
 
+  delete incoming.exchange(nullptr);
+  delete outgoing.exchange(nullptr);
+
   util::debug(log_tag + name + " destroyed");
 }
 
 void Convolver::setup() {
-  ready = false;
+  fading_L.resize(n_samples);
+  fading_R.resize(n_samples);
 
   /*
-    As zita uses fftw we have to be careful when reinitializing it. The thread that creates the fftw plan has to be the
-    same that destroys it. Otherwise segmentation faults can happen. As we do not want to do this initializing in the
-    plugin realtime thread we send it to the main thread through g_idle_add().connect_once
+    The engine accepts any number of frames. So a new quantum does not require a rebuild. Only a new rate does because
+    the kernel has to be resampled. Until the new engine is ready the current one is used.
   */
 
-  util::idle_add([&, this] {
-    if (ready) {
-      return;
-    }
-
-    blocksize = n_samples;
-
-    n_samples_is_power_of_2 = (n_samples & (n_samples - 1U)) == 0U && n_samples != 0U;
-
-    if (!n_samples_is_power_of_2) {
-      while ((blocksize & (blocksize - 1)) != 0 && blocksize > 2) {
-        blocksize--;
-      }
-    }
-
-    data_L.resize(0U);
-    data_R.resize(0U);
-
-    deque_out_L.resize(0U);
-    deque_out_R.resize(0U);
+  if (kernel_rate == rate) {
+    return;
+  }
 
-    notify_latency = true;
+  util::idle_add([&, this] { prepare_kernel(); });
+}
 
-    latency_n_frames = 0U;
+void Convolver::wait_for_setup() {
+  for (auto installed = installed_request.load(); installed != kernel_request.load();
+       installed = installed_request.load()) {
+    installed_request.wait(installed);
+  }
+}
 
-    read_kernel_file();
+void Convolver::clear_state() {
+  PluginBase::clear_state();
 
-    if (kernel_is_initialized) {
-      kernel_L = original_kernel_L;
-      kernel_R = original_kernel_R;
+  if (engine != nullptr) {
+    engine->reset();
+  }
 
-      set_kernel_stereo_width();
-      apply_kernel_autogain();
+  // a crossfade in progress is finished. The old engine goes back to the workers in the next process() call
 
-      setup_zita();
-    }
+  crossfade_position = crossfade_n_frames;
+}
 
-    std::scoped_lock<std::mutex> lock(data_mutex);
+void Convolver::dispatch_notifications() {
+  PluginBase::dispatch_notifications();
 
-    ready = kernel_is_initialized && zita_ready;
-  });
+  if (kernel_taps_changed.exchange(false)) {
+    kernel_taps.emit(original_taps, used_taps);
+  }
 }
 
 void Convolver::process(std::span<float>& left_in,
                         std::span<float>& right_in,
                         std::span<float>& left_out,
                         std::span<float>& right_out) {
-  std::scoped_lock<std::mutex> lock(data_mutex);
+  adopt_engine();
 
-  if (bypass || !ready) {
+  const bool fading = crossfade_position < crossfade_n_frames && left_in.size() <= fading_L.size();
+
+  const bool passthrough = engine == nullptr || engine->kernel_size() == 0U;
+
+  if (bypass || (passthrough && !fading)) {
     std::copy(left_in.begin(), left_in.end(), left_out.begin());
     std::copy(right_in.begin(), right_in.end(), right_out.begin());
 
     return;
   }
 
-  if (input_gain != 1.0F) {
-    apply_gain(left_in, right_in, input_gain);
+  apply_input_gain(left_in, right_in);
+
+  if (fading) {
+    std::copy(left_in.begin(), left_in.end(), fading_L.begin());
+    std::copy(right_in.begin(), right_in.end(), fading_R.begin());
+
+    if (fading_engine != nullptr) {
+      fading_engine->process(std::span(fading_L).first(left_in.size()), std::span(fading_R).first(right_in.size()));
+    }
   }
 
-  if (n_samples_is_power_of_2) {
-    std::copy(left_in.begin(), left_in.end(), left_out.begin());
-    std::copy(right_in.begin(), right_in.end(), right_out.begin());
+  std::copy(left_in.begin(), left_in.end(), left_out.begin());
+  std::copy(right_in.begin(), right_in.end(), right_out.begin());
 
-    do_convolution(left_out, right_out);
-  } else {
-    for (size_t j = 0U; j < left_in.size(); j++) {
-      data_L.push_back(left_in[j]);
-      data_R.push_back(right_in[j]);
+  if (engine != nullptr) {
+    engine->process(left_out, right_out);
+  }
 
-      if (data_L.size() == blocksize) {
-        do_convolution(data_L, data_R);
+  if (fading) {
+    crossfade(left_out, right_out);
+  }
 
-        for (const auto& v : data_L) {
-          deque_out_L.push_back(v);
-        }
+  apply_output_gain(left_out, right_out);
 
-        for (const auto& v : data_R) {
-          deque_out_R.push_back(v);
-        }
+  if (post_messages && send_notifications) {
+    notify();
+  }
+}
 
-        data_L.resize(0U);
-        data_R.resize(0U);
-      }
-    }
+void Convolver::crossfade(std::span<float>& left, std::span<float>& right) {
+  // equal power. The outputs of the new engine are in left and right. The ones of the old engine are in fading_L/R
 
-    // copying the processed samples to the output buffers
+  const auto n_frames = std::min(left.size(), static_cast<size_t>(crossfade_n_frames - crossfade_position));
 
-    if (deque_out_L.size() >= left_out.size()) {
-      for (float& v : left_out) {
-        v = deque_out_L.front();
+  for (size_t n = 0U; n < n_frames; n++) {
+    const auto phase = 0.5F * std::numbers::pi_v<float> * static_cast<float>(crossfade_position + n) /
+                       static_cast<float>(crossfade_n_frames);
 
-        deque_out_L.pop_front();
-      }
+    const auto gain_new = std::sin(phase);
+    const auto gain_old = std::cos(phase);
 
-      for (float& v : right_out) {
-        v = deque_out_R.front();
+    left[n] = gain_new * left[n] + gain_old * fading_L[n];
+    right[n] = gain_new * right[n] + gain_old * fading_R[n];
+  }
 
-        deque_out_R.pop_front();
-      }
-    } else {
-      const uint offset = 2U * (left_out.size() - deque_out_L.size());
+  crossfade_position += n_frames;
+}
+
+void Convolver::prepare_kernel() {
+  if (rate == 0U) {
+    return;
+  }
 
-      if (offset != latency_n_frames) {
-        latency_n_frames = offset;
+  {
+    std::scoped_lock<std::mutex> lock(worker_mutex);
 
-        notify_latency = true;
-      }
+    requested_path = util::gsettings_get_string(settings, "kernel-path");
 
-      for (uint n = 0U; !deque_out_L.empty() && n < left_out.size(); n++) {
-        if (n < offset) {
-          left_out[n] = 0.0F;
-          right_out[n] = 0.0F;
-        } else {
-          left_out[n] = deque_out_L.front();
-          right_out[n] = deque_out_R.front();
-
-          deque_out_R.pop_front();
-          deque_out_L.pop_front();
-        }
+    requested_rate = rate;
+
+    kernel_request++;
+  }
+
+  worker_cv.notify_one();
+}
+
+void Convolver::kernel_worker_loop() {
+  /*
+    Only the newest request matters. The ones made while an engine was being built are merged into a single one. And
+    build_engine() gives up as soon as it notices that a newer request was made.
+  */
+
+  uint handled_request = 0U;
+
+  while (true) {
+    uint request = 0U;
+    uint target_rate = 0U;
+    std::string path;
+
+    {
+      std::unique_lock<std::mutex> lock(worker_mutex);
+
+      worker_cv.wait(lock, [&] { return !worker_running || kernel_request.load() != handled_request; });
+
+      if (!worker_running) {
+        break;
       }
+
+      request = kernel_request.load();
+      target_rate = requested_rate;
+      path = requested_path;
     }
+
+    handled_request = request;
+
+    build_engine(request, path, target_rate);
   }
+}
+
+void Convolver::build_engine(const uint& request, const std::string& path, const uint& target_rate) {
+  // a newer request is waiting. There is no reason to build an engine that would be replaced right away
 
-  if (output_gain != 1.0F) {
-    apply_gain(left_out, right_out, output_gain);
+  if (request != kernel_request.load()) {
+    return;
   }
 
-  if (notify_latency) {
-    latency_value = static_cast<float>(latency_n_frames) / static_cast<float>(rate);
+  delete outgoing.exchange(nullptr);
+
+  // the file is hashed again so changes to its contents are noticed. Decoding it is needed only on a cache miss
 
-    util::debug(log_tag + name + " latency: " + util::to_string(latency_value, "") + " s");
+  original_kernel = ir_cache::load(path, target_rate, log_tag + name);
 
-    util::idle_add([=, this] { latency.emit(); });
+  // an engine without a kernel passes the audio through. Handing it over fades out the previous one
+
+  auto new_engine = std::make_unique<PartitionedConvolver>();
+
+  if (original_kernel != nullptr) {
+    set_kernel_stereo_width();
+    make_kernel_minimum_phase();
+    trim_kernel();
+    apply_kernel_autogain();
 
-    update_filter_params();
+    original_taps = static_cast<uint>(original_kernel->size());
+    used_taps = static_cast<uint>(kernel_L.size());
 
-    notify_latency = false;
+    new_engine->configure(kernel_L, kernel_R);
+
+    // the engine keeps the spectra it needs. These copies are only rebuilt from the shared kernel when needed
+
+    kernel_L = std::vector<float>();
+    kernel_R = std::vector<float>();
+
+    util::debug(log_tag + name + ": convolution engine is ready. Kernel size: " +
+                util::to_string(new_engine->kernel_size()));
+  } else {
+    util::warning(log_tag + name + ": Entering passthrough mode...");
+
+    original_taps = 0U;
+    used_taps = 0U;
   }
 
-  if (post_messages) {
-    get_peaks(left_in, right_in, left_out, right_out);
+  kernel_taps_changed = true;
 
-    if (send_notifications) {
-      notify();
+  hand_over_engine(std::move(new_engine), request, target_rate);
+ 
+  /*
+    The previous engine is destroyed here once the realtime thread is done with the crossfade and has handed it back.
+    Nobody finishes it if the audio is not flowing. So we do not wait for more than a second. What is left is deleted
+    by the next worker or by our destructor.
+  */
+
+  for (uint n = 0U; n < 100U && request == kernel_request.load(); n++) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+
+    if (incoming.load() == nullptr && !crossfading.load()) {
+      delete outgoing.exchange(nullptr);
+
+      break;
     }
+
+    delete outgoing.exchange(nullptr);
   }
 }
 
-void Convolver::read_kernel_file() {
-  kernel_is_initialized = false;
+void Convolver::hand_over_engine(std::unique_ptr<PartitionedConvolver> new_engine,
+                                 const uint& request,
+                                 const uint& target_rate) {
+  // an engine the realtime thread did not take yet was never used. It can be deleted here
 
-  const auto path = util::gsettings_get_string(settings, "kernel-path");
+  delete incoming.exchange(new_engine.release());
 
-  if (path.empty()) {
-    util::warning(log_tag + name + ": irs file path is null. Entering passthrough mode...");
+  kernel_rate = target_rate;
+
+  installed_request = request;
+
+  installed_request.notify_all();
+}
 
+void Convolver::adopt_engine() {
+  // the engine that finished fading out goes back to the workers when the slot is free
+
+  if (fading_engine != nullptr && crossfade_position >= crossfade_n_frames && outgoing.load() == nullptr) {
+    outgoing = fading_engine.release();
+
+    crossfading = false;
+  }
+
+  if (incoming.load(std::memory_order_relaxed) == nullptr) {
     return;
   }
 
-  // SndfileHandle might have issues with std::string, so we provide cstring
+  // a crossfade still in progress is cut short. We wait for the slot if the previous engine was not collected yet
 
-  SndfileHandle file = SndfileHandle(path.c_str());
+  if (fading_engine != nullptr) {
+    if (outgoing.load() != nullptr) {
+      return;
+    }
 
-  if (file.channels() == 0 || file.frames() == 0) {
-    util::warning(log_tag + name + ": irs file does not exists or it is empty: " + path);
-    util::warning(log_tag + name + ": Entering passthrough mode...");
+    outgoing = fading_engine.release();
+  }
+
+  auto* next = incoming.exchange(nullptr);
+
+  if (next == nullptr) {
+    crossfading = false;
 
     return;
   }
 
-  util::debug(log_tag + name + ": irs file: " + path);
-  util::debug(log_tag + name + ": irs rate: " + util::to_string(file.samplerate()) + " Hz");
-  util::debug(log_tag + name + ": irs channels: " + util::to_string(file.channels()));
-  util::debug(log_tag + name + ": irs frames: " + util::to_string(file.frames()));
+  /*
+    When there was no engine before there is nothing to fade from. The new one is used right away like the offline
+    tools expect.
+  */
+
+  const bool fade = engine != nullptr;
+
+  fading_engine = std::move(engine);
+
+  engine.reset(next);
 
-  // for now only stereo irs files are supported
+  crossfade_position = 0U;
 
-  if (file.channels() != 2) {
-    util::warning(log_tag + name + " Only stereo impulse responses are supported.");
-    util::warning(log_tag + name + " The impulse file was not loaded!");
+  crossfade_n_frames = fade ? static_cast<uint>(crossfade_ms * 0.001F * static_cast<float>(rate)) : 0U;
 
+  crossfading = fade;
+
+  tail_n_frames = static_cast<uint>(engine->kernel_size());
+}
+
+void Convolver::make_kernel_minimum_phase() {
+  if (!minimum_phase) {
     return;
   }
 
-  std::vector<float> buffer(file.frames() * file.channels());
-  std::vector<float> buffer_L(file.frames());
-  std::vector<float> buffer_R(file.frames());
+  make_minimum_phase(kernel_L);
+  make_minimum_phase(kernel_R);
+
+  util::debug(log_tag + name + ": kernel converted to minimum phase");
+}
 
-  file.readf(buffer.data(), file.frames());
+/*
+  The samples removed from each end hold less than trim_threshold of the kernel energy. Both channels are trimmed
+  by the same amount so they stay aligned.
+*/
 
-  for (size_t n = 0U; n < buffer_L.size(); n++) {
-    buffer_L[n] = buffer[2U * n];
-    buffer_R[n] = buffer[2U * n + 1U];
+void Convolver::trim_kernel() {
+  if (!trim_ir || kernel_L.empty()) {
+    return;
   }
 
-  if (file.samplerate() != static_cast<int>(rate)) {
-    util::debug(log_tag + name + " resampling the kernel to " + util::to_string(rate));
+  const auto energy = [&](const size_t& n) {
+    return static_cast<double>(kernel_L[n]) * kernel_L[n] + static_cast<double>(kernel_R[n]) * kernel_R[n];
+  };
 
-    auto resampler = std::make_unique<Resampler>(file.samplerate(), rate);
+  double total = 0.0;
 
-    original_kernel_L = resampler->process(buffer_L, true);
+  for (size_t n = 0U; n < kernel_L.size(); n++) {
+    total += energy(n);
+  }
 
-    resampler = std::make_unique<Resampler>(file.samplerate(), rate);
+  if (total == 0.0) {
+    return;
+  }
 
-    original_kernel_R = resampler->process(buffer_R, true);
-  } else {
-    original_kernel_L = buffer_L;
-    original_kernel_R = buffer_R;
+  const double limit = total * std::pow(10.0, static_cast<double>(trim_threshold) / 10.0);
+
+  size_t first = 0U;
+
+  for (double sum = energy(first); sum <= limit && first + 1U < kernel_L.size(); sum += energy(first)) {
+    first++;
   }
 
-  kernel_is_initialized = true;
+  size_t last = kernel_L.size();
 
-  util::debug(log_tag + name + ": kernel initialized");
+  for (double sum = energy(last - 1U); sum <= limit && last - 1U > first; sum += energy(last - 1U)) {
+    last--;
+  }
+
+  util::debug(log_tag + name + ": kernel trimmed from " + util::to_string(kernel_L.size()) + " to " +
+              util::to_string(last - first) + " samples. The onset was at sample " + util::to_string(first));
+
+  for (auto* kernel : {&kernel_L, &kernel_R}) {
+    kernel->erase(kernel->begin() + static_cast<long>(last), kernel->end());
+    kernel->erase(kernel->begin(), kernel->begin() + static_cast<long>(first));
+  }
 }
 
 void Convolver::apply_kernel_autogain() {
@@ -373,115 +605,29 @@ void Convolver::set_kernel_stereo_width() {
   const float w = static_cast<float>(ir_width) * 0.01F;
   const float x = (1.0F - w) / (1.0F + w);  // M-S coeff.; L_out = L + x*R; R_out = R + x*L
 
-  for (uint i = 0U; i < original_kernel_L.size(); i++) {
-    const auto L = original_kernel_L[i];
-    const auto R = original_kernel_R[i];
-
-    kernel_L[i] = L + x * R;
-    kernel_R[i] = R + x * L;
-  }
-}
-
-void Convolver::setup_zita() {
-  zita_ready = false;
-
-  if (n_samples == 0U || !kernel_is_initialized) {
-    return;
-  }
-
-  const uint max_convolution_size = kernel_L.size();
-  const uint buffer_size = get_zita_buffer_size();
-
-  if (conv != nullptr) {
-    conv->stop_process();
-
-    conv->cleanup();
-
-    delete conv;
-  }
-
-  conv = new Convproc();
-
-  conv->set_options(0);
-
-  int ret = conv->configure(2, 2, max_convolution_size, buffer_size, buffer_size, buffer_size, 0.0F /*density*/);
-
-  if (ret != 0) {
-    util::warning(log_tag + name + " can't initialise zita-convolver engine: " + util::to_string(ret, ""));
-
-    return;
-  }
-
-  ret = conv->impdata_create(0, 0, 1, kernel_L.data(), 0, static_cast<int>(kernel_L.size()));
-
-  if (ret != 0) {
-    util::warning(log_tag + name + " left impdata_create failed: " + util::to_string(ret));
-
-    return;
-  }
-
-  ret = conv->impdata_create(1, 1, 1, kernel_R.data(), 0, static_cast<int>(kernel_R.size()));
+  const auto original_L = original_kernel->left();
+  const auto original_R = original_kernel->right();
 
-  if (ret != 0) {
-    util::warning(log_tag + name + " right impdata_create failed: " + util::to_string(ret, ""));
+  kernel_L.resize(original_kernel->size());
+  kernel_R.resize(original_kernel->size());
 
-    return;
-  }
-
-  ret = conv->start_process(CONVPROC_SCHEDULER_PRIORITY, CONVPROC_SCHEDULER_CLASS);
-
-  if (ret != 0) {
-    util::warning(log_tag + name + " start_process failed: " + util::to_string(ret, ""));
-
-    conv->stop_process();
-    conv->cleanup();
-
-    return;
-  }
+  for (size_t i = 0U; i < original_kernel->size(); i++) {
+    const auto L = original_L[i];
+    const auto R = original_R[i];
 
-  zita_ready = true;
-
-  util::debug(log_tag + name + ": zita is ready");
-}
-
-auto Convolver::get_zita_buffer_size() -> uint {
-  if (n_samples_is_power_of_2) {
-    return n_samples;
+    kernel_L[i] = L + x * R;
+    kernel_R[i] = R + x * L;
   }
-
-  return blocksize;
 }
 
 auto Convolver::get_latency_seconds() -> float {
   return this->latency_value;
 }
 
-void Convolver::prepare_kernel() {
-  if (n_samples == 0U || rate == 0U) {
-    return;
-  }
-
-  data_mutex.lock();
-
-  ready = false;
-
-  data_mutex.unlock();
-
-  read_kernel_file();
-
-  if (kernel_is_initialized) {
-    kernel_L = original_kernel_L;
-    kernel_R = original_kernel_R;
-
-    set_kernel_stereo_width();
-    apply_kernel_autogain();
-
-    setup_zita();
-
-    data_mutex.lock();
-
-    ready = kernel_is_initialized && zita_ready;
+auto Convolver::is_silence_stable() const -> bool {
+  return true;
+}
 
-    data_mutex.unlock();
-  }
+auto Convolver::get_tail_seconds() -> float {
+  return (rate != 0U) ? static_cast<float>(tail_n_frames) / static_cast<float>(rate) : 0.0F;
 }
@@ -40,6 +40,12 @@ void ConvolverPreset::save(nlohmann::json& json) {
   json[section][instance_name]["ir-width"] = g_settings_get_int(settings, "ir-width");
 
   json[section][instance_name]["autogain"] = g_settings_get_boolean(settings, "autogain") != 0;
+
+  json[section][instance_name]["trim-ir"] = g_settings_get_boolean(settings, "trim-ir") != 0;
+
+  json[section][instance_name]["trim-threshold"] = g_settings_get_double(settings, "trim-threshold");
+
+  json[section][instance_name]["minimum-phase"] = g_settings_get_boolean(settings, "minimum-phase") != 0;
 }
 
 void ConvolverPreset::load(const nlohmann::json& json) {
@@ -54,4 +60,10 @@ void ConvolverPreset::load(const nlohmann::json& json) {
   update_key<int>(json.at(section).at(instance_name), settings, "ir-width", "ir-width");
 
   update_key<bool>(json.at(section).at(instance_name), settings, "autogain", "autogain");
+
+  update_key<bool>(json.at(section).at(instance_name), settings, "trim-ir", "trim-ir");
+
+  update_key<double>(json.at(section).at(instance_name), settings, "trim-threshold", "trim-threshold");
+
+  update_key<bool>(json.at(section).at(instance_name), settings, "minimum-phase", "minimum-phase");
 }
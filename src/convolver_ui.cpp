@@ -64,9 +64,9 @@ struct _ConvolverBox {
 
   GtkMenuButton *menu_button_impulses, *menu_button_combine;
 
-  GtkLabel *label_file_name, *label_sampling_rate, *label_samples, *label_duration;
+  GtkLabel *label_file_name, *label_sampling_rate, *label_samples, *label_duration, *label_used_samples;
 
-  GtkSpinButton* ir_width;
+  GtkSpinButton *ir_width, *trim_threshold;
 
   GtkCheckButton *check_left, *check_right;
 
@@ -86,7 +86,7 @@ struct _ConvolverBox {
 
   Data* data;
 
-  GtkToggleButton* autogain;
+  GtkToggleButton *autogain, *trim_ir, *minimum_phase;
 };
 
 // NOLINTNEXTLINE
@@ -453,6 +453,19 @@ void get_irs_info(ConvolverBox* self) {
   });
 }
 
+void update_used_samples(ConvolverBox* self, const uint& original_taps, const uint& used_taps) {
+  if (original_taps == 0U) {
+    gtk_label_set_text(self->label_used_samples, "");
+
+    return;
+  }
+
+  const auto percent = 100.0 * static_cast<double>(used_taps) / static_cast<double>(original_taps);
+
+  gtk_label_set_text(self->label_used_samples,
+                     fmt::format(ui::get_user_locale(), "{0:Ld} ({1:.0Lf} %)", used_taps, percent).c_str());
+}
+
 void setup(ConvolverBox* self,
            std::shared_ptr<Convolver> convolver,
            const std::string& schema_path,
@@ -496,6 +509,19 @@ void setup(ConvolverBox* self,
     });
   }));
 
+  update_used_samples(self, convolver->original_taps, convolver->used_taps);
+
+  self->data->connections.push_back(
+      convolver->kernel_taps.connect([=](const uint original_taps, const uint used_taps) {
+        util::idle_add([=]() {
+          if (get_ignore_filter_idle_add(serial)) {
+            return;
+          }
+
+          update_used_samples(self, original_taps, used_taps);
+        });
+      }));
+
   self->data->gconnections.push_back(g_signal_connect(
       self->settings, "changed::kernel-path", G_CALLBACK(+[](GSettings* settings, char* key, ConvolverBox* self) {
         self->data->mythreads.emplace_back([=]() {
@@ -508,8 +534,11 @@ void setup(ConvolverBox* self,
 
   gtk_label_set_text(self->plugin_credit, ui::get_plugin_credit_translated(self->data->convolver->package).c_str());
 
-  gsettings_bind_widgets<"input-gain", "output-gain", "autogain">(self->settings, self->input_gain, self->output_gain,
-                                                                  self->autogain);
+  gsettings_bind_widgets<"input-gain", "output-gain", "autogain", "trim-ir", "minimum-phase">(
+      self->settings, self->input_gain, self->output_gain, self->autogain, self->trim_ir, self->minimum_phase);
+
+  g_settings_bind(self->settings, "trim-threshold", gtk_spin_button_get_adjustment(self->trim_threshold), "value",
+                  G_SETTINGS_BIND_DEFAULT);
 
   g_settings_bind(self->settings, "ir-width", gtk_spin_button_get_adjustment(self->ir_width), "value",
                   G_SETTINGS_BIND_DEFAULT);
@@ -593,13 +622,17 @@ void convolver_box_class_init(ConvolverBoxClass* klass) {
   gtk_widget_class_bind_template_child(widget_class, ConvolverBox, label_sampling_rate);
   gtk_widget_class_bind_template_child(widget_class, ConvolverBox, label_samples);
   gtk_widget_class_bind_template_child(widget_class, ConvolverBox, label_duration);
+  gtk_widget_class_bind_template_child(widget_class, ConvolverBox, label_used_samples);
   gtk_widget_class_bind_template_child(widget_class, ConvolverBox, ir_width);
+  gtk_widget_class_bind_template_child(widget_class, ConvolverBox, trim_threshold);
   gtk_widget_class_bind_template_child(widget_class, ConvolverBox, check_left);
   gtk_widget_class_bind_template_child(widget_class, ConvolverBox, check_right);
   gtk_widget_class_bind_template_child(widget_class, ConvolverBox, show_fft);
   gtk_widget_class_bind_template_child(widget_class, ConvolverBox, enable_log_scale);
   gtk_widget_class_bind_template_child(widget_class, ConvolverBox, chart_box);
   gtk_widget_class_bind_template_child(widget_class, ConvolverBox, autogain);
+  gtk_widget_class_bind_template_child(widget_class, ConvolverBox, trim_ir);
+  gtk_widget_class_bind_template_child(widget_class, ConvolverBox, minimum_phase);
 
   gtk_widget_class_bind_template_callback(widget_class, on_reset);
   gtk_widget_class_bind_template_callback(widget_class, on_show_fft);
@@ -626,6 +659,8 @@ void convolver_box_init(ConvolverBox* self) {
 
   prepare_spinbuttons<"%">(self->ir_width);
 
+  prepare_spinbuttons<"dB">(self->trim_threshold);
+
   prepare_scales<"dB">(self->input_gain, self->output_gain);
 
   self->chart = ui::chart::create();
@@ -82,32 +82,18 @@ void Crossfeed::process(std::span<float>& left_in,
     return;
   }
 
-  if (input_gain != 1.0F) {
-    apply_gain(left_in, right_in, input_gain);
-  }
+  apply_input_gain(left_in, right_in);
 
-  for (size_t n = 0U; n < left_in.size(); n++) {
-    data[n * 2U] = left_in[n];
-    data[n * 2U + 1U] = right_in[n];
-  }
+  dsp::interleave(left_in, right_in, data);
 
   bs2b.cross_feed(data.data(), static_cast<int>(n_samples));
 
-  for (size_t n = 0U; n < left_out.size(); n++) {
-    left_out[n] = data[n * 2U];
-    right_out[n] = data[n * 2U + 1U];
-  }
-
-  if (output_gain != 1.0F) {
-    apply_gain(left_out, right_out, output_gain);
-  }
+  dsp::deinterleave(data, left_out, right_out);
 
-  if (post_messages) {
-    get_peaks(left_in, right_in, left_out, right_out);
+  apply_output_gain(left_out, right_out);
 
-    if (send_notifications) {
-      notify();
-    }
+  if (post_messages && send_notifications) {
+    notify();
   }
 }
 
@@ -31,6 +31,7 @@ Crystalizer::Crystalizer(const std::string& tag,
   std::ranges::fill(band_mute, false);
   std::ranges::fill(band_bypass, false);
   std::ranges::fill(band_intensity, 1.0F);
+
   std::ranges::fill(band_last_L, 0.0F);
   std::ranges::fill(band_last_R, 0.0F);
 
@@ -105,11 +106,11 @@ void Crystalizer::setup() {
 
     latency_n_frames = 1U;  // the second derivative forces us to delay at least one sample
 
-    deque_out_L.resize(0U);
-    deque_out_R.resize(0U);
+    data_L.resize(blocksize);
+    data_R.resize(blocksize);
 
-    data_L.resize(0U);
-    data_R.resize(0U);
+    input_ring.resize(n_samples + blocksize);
+    output_ring.resize(2U * (n_samples + blocksize));
 
     for (uint n = 0U; n < nbands; n++) {
       band_data_L.at(n).resize(blocksize);
@@ -129,6 +130,12 @@ void Crystalizer::setup() {
       filters.at(n)->setup();
     }
 
+    tail_n_frames = 0U;
+
+    for (const auto& filter : filters) {
+      tail_n_frames = std::max(tail_n_frames, static_cast<uint>(filter->get_kernel_size()));
+    }
+
     data_mutex.lock();
 
     filters_are_ready = true;
@@ -141,122 +148,87 @@ void Crystalizer::process(std::span<float>& left_in,
                           std::span<float>& right_in,
                           std::span<float>& left_out,
                           std::span<float>& right_out) {
-  std::scoped_lock<std::mutex> lock(data_mutex);
+  /*
+    The mutex is only held by the main thread while the filters are being replaced. We do not wait for it. The audio is
+    passed through while that happens.
+  */
+
+  std::unique_lock<std::mutex> lock(data_mutex, std::try_to_lock);
 
-  if (bypass || !filters_are_ready) {
+  if (!lock.owns_lock() || bypass || !filters_are_ready) {
     std::copy(left_in.begin(), left_in.end(), left_out.begin());
     std::copy(right_in.begin(), right_in.end(), right_out.begin());
 
     return;
   }
 
-  if (input_gain != 1.0F) {
-    apply_gain(left_in, right_in, input_gain);
+  {
+    const auto p = params.read();
+
+    band_mute = p->band_mute;
+    band_bypass = p->band_bypass;
+    band_intensity = p->band_intensity;
   }
 
+  apply_input_gain(left_in, right_in);
+
   if (n_samples_is_power_of_2 && blocksize == n_samples) {
     std::copy(left_in.begin(), left_in.end(), left_out.begin());
     std::copy(right_in.begin(), right_in.end(), right_out.begin());
 
     enhance_peaks(left_out, right_out);
   } else {
-    for (size_t j = 0U; j < left_in.size(); j++) {
-      data_L.push_back(left_in[j]);
-      data_R.push_back(right_in[j]);
+    input_ring.push(left_in, right_in);
 
-      if (data_L.size() == blocksize) {
-        enhance_peaks(data_L, data_R);
+    while (input_ring.size() >= blocksize) {
+      input_ring.pop(data_L, data_R);
 
-        for (const auto& v : data_L) {
-          deque_out_L.push_back(v);
-        }
+      enhance_peaks(data_L, data_R);
 
-        for (const auto& v : data_R) {
-          deque_out_R.push_back(v);
-        }
-
-        data_L.resize(0U);
-        data_R.resize(0U);
-      }
+      output_ring.push(data_L, data_R);
     }
 
     // copying the processed samples to the output buffers
 
-    if (deque_out_L.size() >= left_out.size()) {
-      for (float& v : left_out) {
-        v = deque_out_L.front();
-
-        deque_out_L.pop_front();
-      }
-
-      for (float& v : right_out) {
-        v = deque_out_R.front();
+    if (const auto padded = output_ring.pop_or_pad(left_out, right_out); padded != 0U) {
+      latency_n_frames += padded;
 
-        deque_out_R.pop_front();
-      }
-    } else {
-      uint offset = 2U * (left_out.size() - deque_out_L.size());
-
-      if (offset != latency_n_frames) {
-        latency_n_frames = offset + 1U;  // the second derivative forces us to delay at least one sample
-
-        notify_latency = true;
-      }
-
-      for (uint n = 0U; !deque_out_L.empty() && n < left_out.size(); n++) {
-        if (n < offset) {
-          left_out[n] = 0.0F;
-          right_out[n] = 0.0F;
-        } else {
-          left_out[n] = deque_out_L.front();
-          right_out[n] = deque_out_R.front();
-
-          deque_out_R.pop_front();
-          deque_out_L.pop_front();
-        }
-      }
+      notify_latency = true;
     }
   }
 
-  if (output_gain != 1.0F) {
-    apply_gain(left_out, right_out, output_gain);
-  }
+  apply_output_gain(left_out, right_out);
 
   if (notify_latency) {
     latency_value = static_cast<float>(latency_n_frames) / static_cast<float>(rate);
 
     util::debug(log_tag + name + " latency: " + util::to_string(latency_value, "") + " s");
 
-    util::idle_add([=, this]() {
-      if (!post_messages || latency.empty()) {
-        return;
-      }
-
-      latency.emit();
-    });
+    notify_latency_change();
 
     update_filter_params();
 
     notify_latency = false;
   }
 
-  if (post_messages) {
-    get_peaks(left_in, right_in, left_out, right_out);
-
-    if (send_notifications) {
-      notify();
-    }
+  if (post_messages && send_notifications) {
+    notify();
   }
 }
 
 void Crystalizer::bind_band(const int& n) {
   const std::string bandn = "band" + util::to_string(n);
 
-  band_intensity.at(n) =
+  const auto intensity =
       static_cast<float>(util::db_to_linear(g_settings_get_double(settings, ("intensity-" + bandn).c_str())));
+  const auto mute = g_settings_get_boolean(settings, ("mute-" + bandn).c_str()) != 0;
+  const auto bypass_band = g_settings_get_boolean(settings, ("bypass-" + bandn).c_str()) != 0;
 
-  band_mute.at(n) = g_settings_get_boolean(settings, ("mute-" + bandn).c_str()) != 0;
-  band_bypass.at(n) = g_settings_get_boolean(settings, ("bypass-" + bandn).c_str()) != 0;
+  params.update([&](Params& p) {
+    p.band_intensity.at(n) = intensity;
+    p.band_mute.at(n) = mute;
+    p.band_bypass.at(n) = bypass_band;
+  });
 
   using namespace std::string_literals;
 
@@ -269,8 +241,10 @@ void Crystalizer::bind_band(const int& n) {
                                             if (util::str_to_num(s_key.substr(s_key.find("-band") + 5U), index)) {
                                               auto* self = static_cast<Crystalizer*>(user_data);
 
-                                              self->band_intensity.at(index) =
-                                                  g_settings_get_double(settings, key) != 0;
+                                              const auto v = static_cast<float>(
+                                                  util::db_to_linear(g_settings_get_double(settings, key)));
+
+                                              self->params.update([&](Params& p) { p.band_intensity.at(index) = v; });
                                             }
                                           }),
                                           this));
@@ -284,7 +258,9 @@ void Crystalizer::bind_band(const int& n) {
                                             if (util::str_to_num(s_key.substr(s_key.find("-band") + 5U), index)) {
                                               auto* self = static_cast<Crystalizer*>(user_data);
 
-                                              self->band_mute.at(index) = g_settings_get_boolean(settings, key) != 0;
+                                              const auto v = g_settings_get_boolean(settings, key) != 0;
+
+                                              self->params.update([&](Params& p) { p.band_mute.at(index) = v; });
                                             }
                                           }),
                                           this));
@@ -298,7 +274,9 @@ void Crystalizer::bind_band(const int& n) {
                                             if (util::str_to_num(s_key.substr(s_key.find("-band") + 5U), index)) {
                                               auto* self = static_cast<Crystalizer*>(user_data);
 
-                                              self->band_bypass.at(index) = g_settings_get_boolean(settings, key) != 0;
+                                              const auto v = g_settings_get_boolean(settings, key) != 0;
+
+                                              self->params.update([&](Params& p) { p.band_bypass.at(index) = v; });
                                             }
                                           }),
                                           this));
@@ -307,3 +285,15 @@ void Crystalizer::bind_band(const int& n) {
 auto Crystalizer::get_latency_seconds() -> float {
   return this->latency_value;
 }
+
+auto Crystalizer::needs_power_of_2_blocks() const -> bool {
+  return true;
+}
+
+auto Crystalizer::is_silence_stable() const -> bool {
+  return true;
+}
+
+auto Crystalizer::get_tail_seconds() -> float {
+  return (rate != 0U) ? static_cast<float>(tail_n_frames) / static_cast<float>(rate) : 0.0F;
+}
@@ -113,6 +113,19 @@ void DeepFilterNet::setup() {
   });
 }
 
+void DeepFilterNet::reset() {
+  PluginBase::reset();
+
+  std::scoped_lock<std::mutex> lock(data_mutex);
+
+  // the LADSPA instance keeps the state of the network and the frames it still has to output
+
+  if (ladspa_wrapper->found_plugin() && ladspa_wrapper->has_instance()) {
+    ladspa_wrapper->deactivate();
+    ladspa_wrapper->activate();
+  }
+}
+
 void DeepFilterNet::process(std::span<float>& left_in,
                             std::span<float>& right_in,
                             std::span<float>& left_out,
@@ -126,9 +139,7 @@ void DeepFilterNet::process(std::span<float>& left_in,
     return;
   }
 
-  if (input_gain != 1.0F) {
-    apply_gain(left_in, right_in, input_gain);
-  }
+  apply_input_gain(left_in, right_in);
 
   if (resample) {
     const auto& resampled_inL = resampler_inL->process(left_in, false);
@@ -179,19 +190,28 @@ void DeepFilterNet::process(std::span<float>& left_in,
     std::fill(right_out.begin() + right_offset + right_count, right_out.end(), 0);
   }
 
-  if (output_gain != 1.0F) {
-    apply_gain(left_out, right_out, output_gain);
-  }
+  apply_output_gain(left_out, right_out);
 
-  if (post_messages) {
-    get_peaks(left_in, right_in, left_out, right_out);
-
-    if (send_notifications) {
-      notify();
-    }
+  if (post_messages && send_notifications) {
+    notify();
   }
 }
 
 auto DeepFilterNet::get_latency_seconds() -> float {
-  return 0.02F + 1.0F / rate;
+  return model_lookahead_hops * model_hop_seconds + 1.0F / rate;
+}
+
+auto DeepFilterNet::is_silence_stable() const -> bool {
+  return true;
+}
+
+auto DeepFilterNet::get_tail_seconds() -> float {
+  /*
+    After the lookahead the past frames of the deep filter still depend on the input. One more hop is added for the
+    overlap-add of the synthesis window and another one for the resamplers when they are used.
+  */
+
+  const auto hops = model_df_order - model_lookahead_hops + (resample ? 2.0F : 1.0F);
+
+  return hops * model_hop_seconds;
 }
@@ -32,6 +32,9 @@ Deesser::Deesser(const std::string& tag,
     util::debug(log_tag + "http://calf.sourceforge.net/plugins/Deesser is not installed");
   }
 
+  detected_port = lv2_wrapper->get_control_port_index("detected");
+  compression_port = lv2_wrapper->get_control_port_index("compression");
+
   lv2_wrapper->bind_key_enum<"mode", "mode">(settings);
 
   lv2_wrapper->bind_key_enum<"detection", "detection">(settings);
@@ -60,6 +63,8 @@ Deesser::Deesser(const std::string& tag,
 }
 
 Deesser::~Deesser() {
+  stop_notifications();
+
   if (connected_to_pw) {
     disconnect_from_pw();
   }
@@ -90,28 +95,19 @@ void Deesser::process(std::span<float>& left_in,
     return;
   }
 
-  if (input_gain != 1.0F) {
-    apply_gain(left_in, right_in, input_gain);
-  }
+  apply_input_gain(left_in, right_in);
 
   lv2_wrapper->connect_data_ports(left_in, right_in, left_out, right_out);
   lv2_wrapper->run();
 
-  if (output_gain != 1.0F) {
-    apply_gain(left_out, right_out, output_gain);
-  }
+  apply_output_gain(left_out, right_out);
 
   if (post_messages) {
-    get_peaks(left_in, right_in, left_out, right_out);
-
     if (send_notifications) {
       // values needed as double for levelbars widget ui, so we convert them here
 
-      detected_port_value = static_cast<double>(lv2_wrapper->get_control_port_value("detected"));
-      compression_port_value = static_cast<double>(lv2_wrapper->get_control_port_value("compression"));
-
-      detected.emit(detected_port_value);
-      compression.emit(compression_port_value);
+      detected_port_value = static_cast<double>(lv2_wrapper->get_control_port_value(detected_port));
+      compression_port_value = static_cast<double>(lv2_wrapper->get_control_port_value(compression_port));
 
       notify();
     }
@@ -121,3 +117,13 @@ void Deesser::process(std::span<float>& left_in,
 auto Deesser::get_latency_seconds() -> float {
   return 0.0F;
 }
+
+void Deesser::pack_meters(std::span<double> values) {
+  values[0] = detected_port_value;
+  values[1] = compression_port_value;
+}
+
+void Deesser::emit_meters(std::span<const double> values) {
+  detected.emit(values[0]);
+  compression.emit(values[1]);
+}
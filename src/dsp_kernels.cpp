@@ -0,0 +1,687 @@
+/*
+ *  Copyright © 2017-2023 Wellington Wallace
+ *
+ *  This file is part of Easy Effects.
+ *
+ *  Easy Effects is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Easy Effects is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Easy Effects. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "dsp_kernels.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+
+#if defined(__aarch64__)
+#include <arm_neon.h>
+#endif
+
+namespace dsp {
+
+namespace {
+
+constexpr float s16_scale = 32768.0F;
+constexpr float s16_min = -32768.0F;
+constexpr float s16_max = 32767.0F;
+constexpr float inv_s16_scale = 1.0F / s16_scale;
+
+/*
+  Plain C++ versions. The vectorized ones call them to process the samples left after the last full vector. The
+  peak functions take the peak found so far so they can continue from where the vector loop stopped.
+*/
+
+auto abs_peak_scalar(const float* data, const size_t count, float peak) -> float {
+  for (size_t n = 0U; n < count; n++) {
+    peak = std::max(peak, std::fabs(data[n]));
+  }
+
+  return peak;
+}
+
+void apply_gain_scalar(float* data, const size_t count, const float gain) {
+  for (size_t n = 0U; n < count; n++) {
+    data[n] *= gain;
+  }
+}
+
+auto apply_gain_abs_peak_scalar(float* data, const size_t count, const float gain, float peak) -> float {
+  for (size_t n = 0U; n < count; n++) {
+    data[n] *= gain;
+
+    peak = std::max(peak, std::fabs(data[n]));
+  }
+
+  return peak;
+}
+
+void interleave_scalar(const float* left, const float* right, float* output, const size_t count) {
+  for (size_t n = 0U; n < count; n++) {
+    output[2U * n] = left[n];
+    output[2U * n + 1U] = right[n];
+  }
+}
+
+void deinterleave_scalar(const float* input, float* left, float* right, const size_t count) {
+  for (size_t n = 0U; n < count; n++) {
+    left[n] = input[2U * n];
+    right[n] = input[2U * n + 1U];
+  }
+}
+
+void float_to_s16_scalar(const float* input, int16_t* output, const size_t count) {
+  for (size_t n = 0U; n < count; n++) {
+    auto v = input[n] * s16_scale;
+
+    // written like this so NaN is handled in the same way as the SSE min and max instructions do
+
+    v = (v < s16_max) ? v : s16_max;
+    v = (v > s16_min) ? v : s16_min;
+
+    output[n] = static_cast<int16_t>(std::lrint(v));
+  }
+}
+
+void s16_to_float_scalar(const int16_t* input, float* output, const size_t count) {
+  for (size_t n = 0U; n < count; n++) {
+    output[n] = static_cast<float>(input[n]) * inv_s16_scale;
+  }
+}
+
+// the complex values are interleaved real and imaginary parts. count is the number of complex values
+
+void complex_multiply_accumulate_scalar(const float* a, const float* b, float* acc, const size_t count) {
+  for (size_t n = 0U; n < count; n++) {
+    const auto ar = a[2U * n];
+    const auto ai = a[2U * n + 1U];
+    const auto br = b[2U * n];
+    const auto bi = b[2U * n + 1U];
+
+    acc[2U * n] += ar * br - ai * bi;
+    acc[2U * n + 1U] += ar * bi + ai * br;
+  }
+}
+
+auto dot_scalar(const float* a, const float* b, const size_t count, float sum) -> float {
+  for (size_t n = 0U; n < count; n++) {
+    sum += a[n] * b[n];
+  }
+
+  return sum;
+}
+
+#if defined(__SSE2__)
+
+auto horizontal_max(__m128 v) -> float {
+  v = _mm_max_ps(v, _mm_shuffle_ps(v, v, _MM_SHUFFLE(2, 3, 0, 1)));
+  v = _mm_max_ps(v, _mm_shuffle_ps(v, v, _MM_SHUFFLE(1, 0, 3, 2)));
+
+  return _mm_cvtss_f32(v);
+}
+
+auto abs_peak_sse2(const float* data, const size_t count, float peak) -> float {
+  const auto abs_mask = _mm_castsi128_ps(_mm_set1_epi32(0x7fffffff));
+
+  auto vpeak = _mm_set1_ps(peak);
+
+  size_t n = 0U;
+
+  for (; n + 4U <= count; n += 4U) {
+    vpeak = _mm_max_ps(vpeak, _mm_and_ps(_mm_loadu_ps(data + n), abs_mask));
+  }
+
+  return abs_peak_scalar(data + n, count - n, horizontal_max(vpeak));
+}
+
+void apply_gain_sse2(float* data, const size_t count, const float gain) {
+  const auto vgain = _mm_set1_ps(gain);
+
+  size_t n = 0U;
+
+  for (; n + 4U <= count; n += 4U) {
+    _mm_storeu_ps(data + n, _mm_mul_ps(_mm_loadu_ps(data + n), vgain));
+  }
+
+  apply_gain_scalar(data + n, count - n, gain);
+}
+
+auto apply_gain_abs_peak_sse2(float* data, const size_t count, const float gain, float peak) -> float {
+  const auto abs_mask = _mm_castsi128_ps(_mm_set1_epi32(0x7fffffff));
+  const auto vgain = _mm_set1_ps(gain);
+
+  auto vpeak = _mm_set1_ps(peak);
+
+  size_t n = 0U;
+
+  for (; n + 4U <= count; n += 4U) {
+    const auto v = _mm_mul_ps(_mm_loadu_ps(data + n), vgain);
+
+    _mm_storeu_ps(data + n, v);
+
+    vpeak = _mm_max_ps(vpeak, _mm_and_ps(v, abs_mask));
+  }
+
+  return apply_gain_abs_peak_scalar(data + n, count - n, gain, horizontal_max(vpeak));
+}
+
+void interleave_sse2(const float* left, const float* right, float* output, const size_t count) {
+  size_t n = 0U;
+
+  for (; n + 4U <= count; n += 4U) {
+    const auto l = _mm_loadu_ps(left + n);
+    const auto r = _mm_loadu_ps(right + n);
+
+    _mm_storeu_ps(output + 2U * n, _mm_unpacklo_ps(l, r));
+    _mm_storeu_ps(output + 2U * n + 4U, _mm_unpackhi_ps(l, r));
+  }
+
+  interleave_scalar(left + n, right + n, output + 2U * n, count - n);
+}
+
+void deinterleave_sse2(const float* input, float* left, float* right, const size_t count) {
+  size_t n = 0U;
+
+  for (; n + 4U <= count; n += 4U) {
+    const auto a = _mm_loadu_ps(input + 2U * n);
+    const auto b = _mm_loadu_ps(input + 2U * n + 4U);
+
+    _mm_storeu_ps(left + n, _mm_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0)));
+    _mm_storeu_ps(right + n, _mm_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1)));
+  }
+
+  deinterleave_scalar(input + 2U * n, left + n, right + n, count - n);
+}
+
+void float_to_s16_sse2(const float* input, int16_t* output, const size_t count) {
+  const auto vscale = _mm_set1_ps(s16_scale);
+  const auto vmin = _mm_set1_ps(s16_min);
+  const auto vmax = _mm_set1_ps(s16_max);
+
+  size_t n = 0U;
+
+  for (; n + 8U <= count; n += 8U) {
+    const auto a = _mm_max_ps(_mm_min_ps(_mm_mul_ps(_mm_loadu_ps(input + n), vscale), vmax), vmin);
+    const auto b = _mm_max_ps(_mm_min_ps(_mm_mul_ps(_mm_loadu_ps(input + n + 4U), vscale), vmax), vmin);
+
+    const auto packed = _mm_packs_epi32(_mm_cvtps_epi32(a), _mm_cvtps_epi32(b));
+
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(output + n), packed);
+  }
+
+  float_to_s16_scalar(input + n, output + n, count - n);
+}
+
+void s16_to_float_sse2(const int16_t* input, float* output, const size_t count) {
+  const auto vscale = _mm_set1_ps(inv_s16_scale);
+
+  size_t n = 0U;
+
+  for (; n + 8U <= count; n += 8U) {
+    const auto v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(input + n));
+
+    // sign extension of the 16 bits values to 32 bits
+
+    const auto lo = _mm_srai_epi32(_mm_unpacklo_epi16(v, v), 16);
+    const auto hi = _mm_srai_epi32(_mm_unpackhi_epi16(v, v), 16);
+
+    _mm_storeu_ps(output + n, _mm_mul_ps(_mm_cvtepi32_ps(lo), vscale));
+    _mm_storeu_ps(output + n + 4U, _mm_mul_ps(_mm_cvtepi32_ps(hi), vscale));
+  }
+
+  s16_to_float_scalar(input + n, output + n, count - n);
+}
+
+void complex_multiply_accumulate_sse2(const float* a, const float* b, float* acc, const size_t count) {
+  // flips the sign of the products of the imaginary parts that go to the real part of the result
+
+  const auto sign = _mm_set_ps(0.0F, -0.0F, 0.0F, -0.0F);
+
+  size_t n = 0U;
+
+  for (; n + 2U <= count; n += 2U) {
+    const auto va = _mm_loadu_ps(a + 2U * n);
+    const auto vb = _mm_loadu_ps(b + 2U * n);
+
+    const auto re = _mm_shuffle_ps(va, va, _MM_SHUFFLE(2, 2, 0, 0));
+    const auto im = _mm_shuffle_ps(va, va, _MM_SHUFFLE(3, 3, 1, 1));
+    const auto swapped = _mm_shuffle_ps(vb, vb, _MM_SHUFFLE(2, 3, 0, 1));
+
+    const auto product = _mm_add_ps(_mm_mul_ps(re, vb), _mm_xor_ps(_mm_mul_ps(im, swapped), sign));
+
+    _mm_storeu_ps(acc + 2U * n, _mm_add_ps(_mm_loadu_ps(acc + 2U * n), product));
+  }
+
+  complex_multiply_accumulate_scalar(a + 2U * n, b + 2U * n, acc + 2U * n, count - n);
+}
+
+auto dot_sse2(const float* a, const float* b, const size_t count, float sum) -> float {
+  auto vsum = _mm_setzero_ps();
+
+  size_t n = 0U;
+
+  for (; n + 4U <= count; n += 4U) {
+    vsum = _mm_add_ps(vsum, _mm_mul_ps(_mm_loadu_ps(a + n), _mm_loadu_ps(b + n)));
+  }
+
+  vsum = _mm_add_ps(vsum, _mm_shuffle_ps(vsum, vsum, _MM_SHUFFLE(2, 3, 0, 1)));
+  vsum = _mm_add_ps(vsum, _mm_shuffle_ps(vsum, vsum, _MM_SHUFFLE(1, 0, 3, 2)));
+
+  return dot_scalar(a + n, b + n, count - n, sum + _mm_cvtss_f32(vsum));
+}
+
+#endif
+
+#if defined(__x86_64__) || defined(__i386__)
+
+#define AVX2_TARGET __attribute__((target("avx2")))
+
+AVX2_TARGET auto horizontal_max_avx2(__m256 v) -> float {
+  auto m = _mm_max_ps(_mm256_castps256_ps128(v), _mm256_extractf128_ps(v, 1));
+
+  m = _mm_max_ps(m, _mm_shuffle_ps(m, m, _MM_SHUFFLE(2, 3, 0, 1)));
+  m = _mm_max_ps(m, _mm_shuffle_ps(m, m, _MM_SHUFFLE(1, 0, 3, 2)));
+
+  return _mm_cvtss_f32(m);
+}
+
+AVX2_TARGET auto abs_peak_avx2(const float* data, const size_t count, float peak) -> float {
+  const auto abs_mask = _mm256_castsi256_ps(_mm256_set1_epi32(0x7fffffff));
+
+  auto vpeak = _mm256_set1_ps(peak);
+
+  size_t n = 0U;
+
+  for (; n + 8U <= count; n += 8U) {
+    vpeak = _mm256_max_ps(vpeak, _mm256_and_ps(_mm256_loadu_ps(data + n), abs_mask));
+  }
+
+  return abs_peak_scalar(data + n, count - n, horizontal_max_avx2(vpeak));
+}
+
+AVX2_TARGET void apply_gain_avx2(float* data, const size_t count, const float gain) {
+  const auto vgain = _mm256_set1_ps(gain);
+
+  size_t n = 0U;
+
+  for (; n + 8U <= count; n += 8U) {
+    _mm256_storeu_ps(data + n, _mm256_mul_ps(_mm256_loadu_ps(data + n), vgain));
+  }
+
+  apply_gain_scalar(data + n, count - n, gain);
+}
+
+AVX2_TARGET auto apply_gain_abs_peak_avx2(float* data, const size_t count, const float gain, float peak) -> float {
+  const auto abs_mask = _mm256_castsi256_ps(_mm256_set1_epi32(0x7fffffff));
+  const auto vgain = _mm256_set1_ps(gain);
+
+  auto vpeak = _mm256_set1_ps(peak);
+
+  size_t n = 0U;
+
+  for (; n + 8U <= count; n += 8U) {
+    const auto v = _mm256_mul_ps(_mm256_loadu_ps(data + n), vgain);
+
+    _mm256_storeu_ps(data + n, v);
+
+    vpeak = _mm256_max_ps(vpeak, _mm256_and_ps(v, abs_mask));
+  }
+
+  return apply_gain_abs_peak_scalar(data + n, count - n, gain, horizontal_max_avx2(vpeak));
+}
+
+AVX2_TARGET void interleave_avx2(const float* left, const float* right, float* output, const size_t count) {
+  size_t n = 0U;
+
+  for (; n + 8U <= count; n += 8U) {
+    const auto l = _mm256_loadu_ps(left + n);
+    const auto r = _mm256_loadu_ps(right + n);
+
+    // the unpack instructions work inside each 128 bits lane. The permutes put the lanes back in order
+
+    const auto lo = _mm256_unpacklo_ps(l, r);
+    const auto hi = _mm256_unpackhi_ps(l, r);
+
+    _mm256_storeu_ps(output + 2U * n, _mm256_permute2f128_ps(lo, hi, 0x20));
+    _mm256_storeu_ps(output + 2U * n + 8U, _mm256_permute2f128_ps(lo, hi, 0x31));
+  }
+
+  interleave_scalar(left + n, right + n, output + 2U * n, count - n);
+}
+
+AVX2_TARGET void deinterleave_avx2(const float* input, float* left, float* right, const size_t count) {
+  size_t n = 0U;
+
+  for (; n + 8U <= count; n += 8U) {
+    const auto a = _mm256_loadu_ps(input + 2U * n);
+    const auto b = _mm256_loadu_ps(input + 2U * n + 8U);
+
+    const auto t0 = _mm256_permute2f128_ps(a, b, 0x20);
+    const auto t1 = _mm256_permute2f128_ps(a, b, 0x31);
+
+    _mm256_storeu_ps(left + n, _mm256_shuffle_ps(t0, t1, _MM_SHUFFLE(2, 0, 2, 0)));
+    _mm256_storeu_ps(right + n, _mm256_shuffle_ps(t0, t1, _MM_SHUFFLE(3, 1, 3, 1)));
+  }
+
+  deinterleave_scalar(input + 2U * n, left + n, right + n, count - n);
+}
+
+AVX2_TARGET void float_to_s16_avx2(const float* input, int16_t* output, const size_t count) {
+  const auto vscale = _mm256_set1_ps(s16_scale);
+  const auto vmin = _mm256_set1_ps(s16_min);
+  const auto vmax = _mm256_set1_ps(s16_max);
+
+  size_t n = 0U;
+
+  for (; n + 16U <= count; n += 16U) {
+    const auto a = _mm256_max_ps(_mm256_min_ps(_mm256_mul_ps(_mm256_loadu_ps(input + n), vscale), vmax), vmin);
+    const auto b = _mm256_max_ps(_mm256_min_ps(_mm256_mul_ps(_mm256_loadu_ps(input + n + 8U), vscale), vmax), vmin);
+
+    // packs also works per lane. The permute restores the order of the four 64 bits blocks
+
+    const auto packed = _mm256_packs_epi32(_mm256_cvtps_epi32(a), _mm256_cvtps_epi32(b));
+
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(output + n),
+                        _mm256_permute4x64_epi64(packed, _MM_SHUFFLE(3, 1, 2, 0)));
+  }
+
+  float_to_s16_scalar(input + n, output + n, count - n);
+}
+
+AVX2_TARGET void s16_to_float_avx2(const int16_t* input, float* output, const size_t count) {
+  const auto vscale = _mm256_set1_ps(inv_s16_scale);
+
+  size_t n = 0U;
+
+  for (; n + 8U <= count; n += 8U) {
+    const auto v = _mm256_cvtepi16_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(input + n)));
+
+    _mm256_storeu_ps(output + n, _mm256_mul_ps(_mm256_cvtepi32_ps(v), vscale));
+  }
+
+  s16_to_float_scalar(input + n, output + n, count - n);
+}
+
+AVX2_TARGET void complex_multiply_accumulate_avx2(const float* a, const float* b, float* acc, const size_t count) {
+  size_t n = 0U;
+
+  for (; n + 4U <= count; n += 4U) {
+    const auto va = _mm256_loadu_ps(a + 2U * n);
+    const auto vb = _mm256_loadu_ps(b + 2U * n);
+
+    const auto re = _mm256_moveldup_ps(va);
+    const auto im = _mm256_movehdup_ps(va);
+    const auto swapped = _mm256_permute_ps(vb, _MM_SHUFFLE(2, 3, 0, 1));
+
+    // addsub subtracts in the even positions, where the real parts are, and adds in the odd ones
+
+    const auto product = _mm256_addsub_ps(_mm256_mul_ps(re, vb), _mm256_mul_ps(im, swapped));
+
+    _mm256_storeu_ps(acc + 2U * n, _mm256_add_ps(_mm256_loadu_ps(acc + 2U * n), product));
+  }
+
+  complex_multiply_accumulate_scalar(a + 2U * n, b + 2U * n, acc + 2U * n, count - n);
+}
+
+AVX2_TARGET auto dot_avx2(const float* a, const float* b, const size_t count, float sum) -> float {
+  auto vsum = _mm256_setzero_ps();
+
+  size_t n = 0U;
+
+  for (; n + 8U <= count; n += 8U) {
+    vsum = _mm256_add_ps(vsum, _mm256_mul_ps(_mm256_loadu_ps(a + n), _mm256_loadu_ps(b + n)));
+  }
+
+  auto s4 = _mm_add_ps(_mm256_castps256_ps128(vsum), _mm256_extractf128_ps(vsum, 1));
+
+  s4 = _mm_add_ps(s4, _mm_shuffle_ps(s4, s4, _MM_SHUFFLE(2, 3, 0, 1)));
+  s4 = _mm_add_ps(s4, _mm_shuffle_ps(s4, s4, _MM_SHUFFLE(1, 0, 3, 2)));
+
+  return dot_scalar(a + n, b + n, count - n, sum + _mm_cvtss_f32(s4));
+}
+
+#undef AVX2_TARGET
+
+#endif
+
+#if defined(__aarch64__)
+
+auto abs_peak_neon(const float* data, const size_t count, float peak) -> float {
+  auto vpeak = vdupq_n_f32(peak);
+
+  size_t n = 0U;
+
+  for (; n + 4U <= count; n += 4U) {
+    vpeak = vmaxq_f32(vpeak, vabsq_f32(vld1q_f32(data + n)));
+  }
+
+  return abs_peak_scalar(data + n, count - n, vmaxvq_f32(vpeak));
+}
+
+void apply_gain_neon(float* data, const size_t count, const float gain) {
+  size_t n = 0U;
+
+  for (; n + 4U <= count; n += 4U) {
+    vst1q_f32(data + n, vmulq_n_f32(vld1q_f32(data + n), gain));
+  }
+
+  apply_gain_scalar(data + n, count - n, gain);
+}
+
+auto apply_gain_abs_peak_neon(float* data, const size_t count, const float gain, float peak) -> float {
+  auto vpeak = vdupq_n_f32(peak);
+
+  size_t n = 0U;
+
+  for (; n + 4U <= count; n += 4U) {
+    const auto v = vmulq_n_f32(vld1q_f32(data + n), gain);
+
+    vst1q_f32(data + n, v);
+
+    vpeak = vmaxq_f32(vpeak, vabsq_f32(v));
+  }
+
+  return apply_gain_abs_peak_scalar(data + n, count - n, gain, vmaxvq_f32(vpeak));
+}
+
+void interleave_neon(const float* left, const float* right, float* output, const size_t count) {
+  size_t n = 0U;
+
+  for (; n + 4U <= count; n += 4U) {
+    const float32x4x2_t v = {{vld1q_f32(left + n), vld1q_f32(right + n)}};
+
+    vst2q_f32(output + 2U * n, v);
+  }
+
+  interleave_scalar(left + n, right + n, output + 2U * n, count - n);
+}
+
+void deinterleave_neon(const float* input, float* left, float* right, const size_t count) {
+  size_t n = 0U;
+
+  for (; n + 4U <= count; n += 4U) {
+    const auto v = vld2q_f32(input + 2U * n);
+
+    vst1q_f32(left + n, v.val[0]);
+    vst1q_f32(right + n, v.val[1]);
+  }
+
+  deinterleave_scalar(input + 2U * n, left + n, right + n, count - n);
+}
+
+void float_to_s16_neon(const float* input, int16_t* output, const size_t count) {
+  const auto vmin = vdupq_n_f32(s16_min);
+  const auto vmax = vdupq_n_f32(s16_max);
+
+  size_t n = 0U;
+
+  for (; n + 8U <= count; n += 8U) {
+    const auto a = vmaxq_f32(vminq_f32(vmulq_n_f32(vld1q_f32(input + n), s16_scale), vmax), vmin);
+    const auto b = vmaxq_f32(vminq_f32(vmulq_n_f32(vld1q_f32(input + n + 4U), s16_scale), vmax), vmin);
+
+    vst1q_s16(output + n, vcombine_s16(vqmovn_s32(vcvtnq_s32_f32(a)), vqmovn_s32(vcvtnq_s32_f32(b))));
+  }
+
+  float_to_s16_scalar(input + n, output + n, count - n);
+}
+
+void s16_to_float_neon(const int16_t* input, float* output, const size_t count) {
+  size_t n = 0U;
+
+  for (; n + 8U <= count; n += 8U) {
+    const auto v = vld1q_s16(input + n);
+
+    vst1q_f32(output + n, vmulq_n_f32(vcvtq_f32_s32(vmovl_s16(vget_low_s16(v))), inv_s16_scale));
+    vst1q_f32(output + n + 4U, vmulq_n_f32(vcvtq_f32_s32(vmovl_high_s16(v)), inv_s16_scale));
+  }
+
+  s16_to_float_scalar(input + n, output + n, count - n);
+}
+
+void complex_multiply_accumulate_neon(const float* a, const float* b, float* acc, const size_t count) {
+  size_t n = 0U;
+
+  for (; n + 4U <= count; n += 4U) {
+    // the structure loads split the real and imaginary parts in two registers
+
+    const auto va = vld2q_f32(a + 2U * n);
+    const auto vb = vld2q_f32(b + 2U * n);
+
+    auto vacc = vld2q_f32(acc + 2U * n);
+
+    vacc.val[0] = vmlaq_f32(vacc.val[0], va.val[0], vb.val[0]);
+    vacc.val[0] = vmlsq_f32(vacc.val[0], va.val[1], vb.val[1]);
+    vacc.val[1] = vmlaq_f32(vacc.val[1], va.val[0], vb.val[1]);
+    vacc.val[1] = vmlaq_f32(vacc.val[1], va.val[1], vb.val[0]);
+
+    vst2q_f32(acc + 2U * n, vacc);
+  }
+
+  complex_multiply_accumulate_scalar(a + 2U * n, b + 2U * n, acc + 2U * n, count - n);
+}
+
+auto dot_neon(const float* a, const float* b, const size_t count, float sum) -> float {
+  auto vsum = vdupq_n_f32(0.0F);
+
+  size_t n = 0U;
+
+  for (; n + 4U <= count; n += 4U) {
+    vsum = vmlaq_f32(vsum, vld1q_f32(a + n), vld1q_f32(b + n));
+  }
+
+  return dot_scalar(a + n, b + n, count - n, sum + vaddvq_f32(vsum));
+}
+
+#endif
+
+struct Kernels {
+  const char* name;
+
+  float (*abs_peak)(const float*, size_t, float);
+  void (*apply_gain)(float*, size_t, float);
+  float (*apply_gain_abs_peak)(float*, size_t, float, float);
+  void (*interleave)(const float*, const float*, float*, size_t);
+  void (*deinterleave)(const float*, float*, float*, size_t);
+  void (*float_to_s16)(const float*, int16_t*, size_t);
+  void (*s16_to_float)(const int16_t*, float*, size_t);
+  void (*complex_multiply_accumulate)(const float*, const float*, float*, size_t);
+  float (*dot)(const float*, const float*, size_t, float);
+};
+
+auto select_kernels() -> Kernels {
+#if defined(__x86_64__) || defined(__i386__)
+  // we may run before the constructors that initialize the cpu model used by __builtin_cpu_supports
+
+  __builtin_cpu_init();
+
+  if (__builtin_cpu_supports("avx2") != 0) {
+    return {"AVX2",          &abs_peak_avx2,     &apply_gain_avx2,   &apply_gain_abs_peak_avx2,
+            &interleave_avx2, &deinterleave_avx2, &float_to_s16_avx2, &s16_to_float_avx2,
+            &complex_multiply_accumulate_avx2, &dot_avx2};
+  }
+#endif
+
+#if defined(__SSE2__)
+  return {"SSE2",          &abs_peak_sse2,     &apply_gain_sse2,   &apply_gain_abs_peak_sse2,
+          &interleave_sse2, &deinterleave_sse2, &float_to_s16_sse2, &s16_to_float_sse2,
+          &complex_multiply_accumulate_sse2, &dot_sse2};
+#elif defined(__aarch64__)
+  return {"NEON",          &abs_peak_neon,     &apply_gain_neon,   &apply_gain_abs_peak_neon,
+          &interleave_neon, &deinterleave_neon, &float_to_s16_neon, &s16_to_float_neon,
+          &complex_multiply_accumulate_neon, &dot_neon};
+#else
+  return {"scalar",          &abs_peak_scalar,     &apply_gain_scalar,   &apply_gain_abs_peak_scalar,
+          &interleave_scalar, &deinterleave_scalar, &float_to_s16_scalar, &s16_to_float_scalar,
+          &complex_multiply_accumulate_scalar, &dot_scalar};
+#endif
+}
+
+const Kernels kernels = select_kernels();
+
+}  // namespace
+
+auto abs_peak(std::span<const float> data) -> float {
+  return kernels.abs_peak(data.data(), data.size(), 0.0F);
+}
+
+void apply_gain(std::span<float> data, const float& gain) {
+  kernels.apply_gain(data.data(), data.size(), gain);
+}
+
+auto apply_gain_abs_peak(std::span<float> data, const float& gain) -> float {
+  return kernels.apply_gain_abs_peak(data.data(), data.size(), gain, 0.0F);
+}
+
+void interleave(std::span<const float> left, std::span<const float> right, std::span<float> output) {
+  const auto count = std::min({left.size(), right.size(), output.size() / 2U});
+
+  kernels.interleave(left.data(), right.data(), output.data(), count);
+}
+
+void deinterleave(std::span<const float> input, std::span<float> left, std::span<float> right) {
+  const auto count = std::min({input.size() / 2U, left.size(), right.size()});
+
+  kernels.deinterleave(input.data(), left.data(), right.data(), count);
+}
+
+void float_to_s16(std::span<const float> input, std::span<int16_t> output) {
+  kernels.float_to_s16(input.data(), output.data(), std::min(input.size(), output.size()));
+}
+
+void s16_to_float(std::span<const int16_t> input, std::span<float> output) {
+  kernels.s16_to_float(input.data(), output.data(), std::min(input.size(), output.size()));
+}
+
+void complex_multiply_accumulate(std::span<const std::complex<float>> a,
+                                 std::span<const std::complex<float>> b,
+                                 std::span<std::complex<float>> acc) {
+  const auto count = std::min({a.size(), b.size(), acc.size()});
+
+  // std::complex<float> is guaranteed to have the layout of an array with the real and imaginary parts
+
+  kernels.complex_multiply_accumulate(reinterpret_cast<const float*>(a.data()),
+                                      reinterpret_cast<const float*>(b.data()), reinterpret_cast<float*>(acc.data()),
+                                      count);
+}
+
+auto dot(std::span<const float> a, std::span<const float> b) -> float {
+  return kernels.dot(a.data(), b.data(), std::min(a.size(), b.size()), 0.0F);
+}
+
+auto instruction_set() -> const char* {
+  return kernels.name;
+}
+
+}  // namespace dsp
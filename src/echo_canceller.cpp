@@ -133,14 +133,12 @@ void EchoCanceller::process(std::span<float>& left_in,
     return;
   }
 
-  if (input_gain != 1.0F) {
-    apply_gain(left_in, right_in, input_gain);
-  }
+  apply_input_gain(left_in, right_in);
 
-  for (size_t j = 0U; j < left_in.size(); j++) {
-    data_L[j] = static_cast<spx_int16_t>(left_in[j] * (SHRT_MAX + 1));
-    data_R[j] = static_cast<spx_int16_t>(right_in[j] * (SHRT_MAX + 1));
+  dsp::float_to_s16(left_in, data_L);
+  dsp::float_to_s16(right_in, data_R);
 
+  for (size_t j = 0U; j < left_in.size(); j++) {
     /*
       This is a very naive and not corect attempt to mitigate the shortcomes discussed at
       https://github.com/wwmm/easyeffects/issues/1566.
@@ -155,40 +153,25 @@ void EchoCanceller::process(std::span<float>& left_in,
   speex_preprocess_run(state_left, filtered_L.data());
   speex_preprocess_run(state_right, filtered_R.data());
 
-  for (size_t j = 0U; j < filtered_L.size(); j++) {
-    left_out[j] = static_cast<float>(filtered_L[j]) * inv_short_max;
-
-    right_out[j] = static_cast<float>(filtered_R[j]) * inv_short_max;
-  }
+  dsp::s16_to_float(filtered_L, left_out);
+  dsp::s16_to_float(filtered_R, right_out);
 
-  if (output_gain != 1.0F) {
-    apply_gain(left_out, right_out, output_gain);
-  }
+  apply_output_gain(left_out, right_out);
 
   if (notify_latency) {
     const float latency_value = static_cast<float>(latency_n_frames) / static_cast<float>(rate);
 
     util::debug(log_tag + name + " latency: " + util::to_string(latency_value, "") + " s");
 
-    util::idle_add([=, this]() {
-      if (!post_messages || latency.empty()) {
-        return;
-      }
-
-      latency.emit();
-    });
+    notify_latency_change();
 
     update_filter_params();
 
     notify_latency = false;
   }
 
-  if (post_messages) {
-    get_peaks(left_in, right_in, left_out, right_out);
-
-    if (send_notifications) {
-      notify();
-    }
+  if (post_messages && send_notifications) {
+    notify();
   }
 }
 
@@ -0,0 +1,349 @@
+/*
+ *  Copyright © 2017-2023 Wellington Wallace
+ *
+ *  This file is part of Easy Effects.
+ *
+ *  Easy Effects is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Easy Effects is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Easy Effects. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+/*
+  Offline benchmark of the plugins. Each plugin is created without a PipeWire filter and run over a stereo signal for
+  every combination of sampling rate and quantum given in the command line. The results are printed to the standard
+  output as JSON.
+*/
+
+#include <glib.h>
+#include <sndfile.hh>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <new>
+#include <nlohmann/json.hpp>
+#include <random>
+#include <sstream>
+#include "config.h"
+#include "plugin_factory.hpp"
+#include "tags_app.hpp"
+
+namespace {
+
+// operator new calls made by the thread running the plugins while a measurement is in progress
+
+thread_local bool count_allocations = false;
+
+thread_local uint64_t n_allocations = 0U;
+
+struct Options {
+  std::vector<std::string> plugins;
+
+  std::vector<uint> quanta = {32U, 64U, 128U, 256U, 512U, 1024U, 2048U, 4096U, 8192U};
+
+  std::vector<uint> rates = {44100U, 48000U, 96000U};
+
+  double seconds = 2.0;
+
+  double warmup_seconds = 0.5;
+
+  std::string input;
+};
+
+struct Signal {
+  std::vector<float> left, right;
+};
+
+auto split(const std::string& str) -> std::vector<std::string> {
+  std::vector<std::string> list;
+
+  std::istringstream stream(str);
+
+  for (std::string item; std::getline(stream, item, ',');) {
+    if (!item.empty()) {
+      list.push_back(item);
+    }
+  }
+
+  return list;
+}
+
+template <typename T>
+auto split_numbers(const std::string& str, std::vector<T>& numbers) -> bool {
+  numbers.clear();
+
+  for (const auto& item : split(str)) {
+    if (T n{}; util::str_to_num(item, n) && n > 0) {
+      numbers.push_back(n);
+    } else {
+      return false;
+    }
+  }
+
+  return !numbers.empty();
+}
+
+void print_usage() {
+  std::cerr << "Usage: ee-bench [OPTION...]\n\n"
+            << "  --plugins=NAME[,NAME...]   plugins to measure. All of them by default\n"
+            << "  --quanta=N[,N...]          quantum sizes in frames. From 32 to 8192 by default\n"
+            << "  --rates=N[,N...]           sampling rates in Hz. 44100, 48000 and 96000 by default\n"
+            << "  --seconds=S                measured audio length per combination. 2 by default\n"
+            << "  --warmup=S                 audio processed before measuring. 0.5 by default\n"
+            << "  --input=FILE               audio file used as input instead of white noise\n";
+}
+
+auto parse_options(int argc, char* argv[], Options& options) -> bool {
+  const std::vector<std::string> args(argv + 1, argv + argc);
+
+  for (const auto& arg : args) {
+    const auto sep = arg.find('=');
+
+    const auto key = arg.substr(0U, sep);
+    const auto value = (sep != std::string::npos) ? arg.substr(sep + 1U) : "";
+
+    bool valid = !value.empty();
+
+    if (key == "--plugins") {
+      options.plugins = split(value);
+    } else if (key == "--quanta") {
+      valid = split_numbers(value, options.quanta);
+    } else if (key == "--rates") {
+      valid = split_numbers(value, options.rates);
+    } else if (key == "--seconds") {
+      valid = util::str_to_num(value, options.seconds) && options.seconds > 0.0;
+    } else if (key == "--warmup") {
+      valid = util::str_to_num(value, options.warmup_seconds) && options.warmup_seconds >= 0.0;
+    } else if (key == "--input") {
+      options.input = value;
+    } else {
+      valid = false;
+    }
+
+    if (!valid) {
+      std::cerr << "ee-bench: invalid option: " << arg << "\n\n";
+
+      return false;
+    }
+  }
+
+  if (options.plugins.empty()) {
+    options.plugins.assign(tags::plugin_name::list.begin(), tags::plugin_name::list.end());
+  }
+
+  return true;
+}
+
+auto load_signal(const Options& options, Signal& signal) -> bool {
+  if (options.input.empty()) {
+    // one second of white noise at -12 dBFS. The seed is fixed so every run processes the same samples
+
+    std::mt19937 generator(0U);
+
+    std::uniform_real_distribution<float> distribution(-0.25F, 0.25F);
+
+    for (uint n = 0U; n < 48000U; n++) {
+      signal.left.push_back(distribution(generator));
+      signal.right.push_back(distribution(generator));
+    }
+
+    return true;
+  }
+
+  SndfileHandle file = SndfileHandle(options.input.c_str());
+
+  if (file.channels() == 0 || file.frames() == 0) {
+    std::cerr << "ee-bench: the input file does not exist or is empty: " << options.input << "\n";
+
+    return false;
+  }
+
+  // the file rate is ignored. The plugins cost does not depend on what the samples mean
+
+  std::vector<float> buffer(file.channels() * file.frames());
+
+  file.readf(buffer.data(), file.frames());
+
+  for (sf_count_t n = 0; n < file.frames(); n++) {
+    signal.left.push_back(buffer[n * file.channels()]);
+    signal.right.push_back(buffer[n * file.channels() + ((file.channels() > 1) ? 1 : 0)]);
+  }
+
+  return true;
+}
+
+auto run(const std::string& name, const uint& rate, const uint& quantum, const Options& options, const Signal& signal)
+    -> nlohmann::json {
+  auto plugin = plugin_factory::create(name + "#0", "ee-bench: ", tags::app::path_stream_outputs, nullptr);
+
+  if (plugin == nullptr) {
+    return {{"plugin", name}, {"error", "unknown plugin"}};
+  }
+
+  std::vector<float> left_in(quantum), right_in(quantum), left_out(quantum), right_out(quantum);
+
+  std::span l_in(left_in), r_in(right_in), l_out(left_out), r_out(right_out);
+
+  uint64_t position = 0U;
+
+  size_t offset = 0U;
+
+  const auto process = [&] {
+    for (uint n = 0U; n < quantum; n++) {
+      left_in[n] = signal.left[offset];
+      right_in[n] = signal.right[offset];
+
+      offset = (offset + 1U) % signal.left.size();
+    }
+
+    plugin->process_quantum(l_in, r_in, l_out, r_out, rate, position);
+
+    position += quantum;
+  };
+
+  /*
+    Many plugins finish their setup in the main loop or in a worker thread. The main context is iterated during the
+    warm up so that work is done before we start measuring.
+  */
+
+  const auto n_warmup = static_cast<uint64_t>(options.warmup_seconds * rate / quantum) + 1U;
+
+  for (uint64_t n = 0U; n < n_warmup; n++) {
+    process();
+
+    while (g_main_context_iteration(nullptr, 0) != 0) {
+    }
+
+    plugin->wait_for_setup();
+  }
+
+  plugin->dsp_load.reset();
+
+  const auto n_quanta = static_cast<uint64_t>(options.seconds * rate / quantum) + 1U;
+
+  n_allocations = 0U;
+
+  count_allocations = true;
+
+  const auto start = std::chrono::steady_clock::now();
+
+  for (uint64_t n = 0U; n < n_quanta; n++) {
+    process();
+  }
+
+  const auto elapsed = std::chrono::steady_clock::now() - start;
+
+  count_allocations = false;
+
+  const auto elapsed_ns = static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count());
+
+  const auto n_frames = static_cast<double>(n_quanta * quantum);
+
+  const auto s = plugin->dsp_load.stats();
+
+  const auto latency = plugin->get_latency_seconds();
+
+  return {{"plugin", name},
+          {"available", plugin->package_installed},
+          {"rate", rate},
+          {"quantum", quantum},
+          {"frames", n_quanta * quantum},
+          {"ns-per-sample", elapsed_ns / n_frames},
+          {"realtime-factor", (n_frames / rate) / (elapsed_ns * 1.0e-9)},
+          {"mean-us", s.mean},
+          {"p99-us", s.p99},
+          {"max-us", s.max},
+          {"load-percent", s.load},
+          {"overruns", s.overruns},
+          {"allocations", n_allocations},
+          {"latency-seconds", latency},
+          {"latency-frames", std::lround(latency * static_cast<float>(rate))}};
+}
+
+}  // namespace
+
+auto operator new(std::size_t size) -> void* {
+  if (count_allocations) {
+    n_allocations++;
+  }
+
+  if (void* p = std::malloc(size == 0U ? 1U : size); p != nullptr) {
+    return p;
+  }
+
+  throw std::bad_alloc();
+}
+
+auto operator new[](std::size_t size) -> void* {
+  return operator new(size);
+}
+
+void operator delete(void* p) noexcept {
+  std::free(p);
+}
+
+void operator delete[](void* p) noexcept {
+  std::free(p);
+}
+
+void operator delete(void* p, std::size_t size) noexcept {
+  std::free(p);
+}
+
+void operator delete[](void* p, std::size_t size) noexcept {
+  std::free(p);
+}
+
+auto main(int argc, char* argv[]) -> int {
+  // the plugins must not read or change the user's settings
+
+  g_setenv("GSETTINGS_BACKEND", "memory", 1);
+
+  Options options;
+
+  Signal signal;
+
+  if (argc > 1 && std::string(argv[1]) == "--help") {
+    print_usage();
+
+    return EXIT_SUCCESS;
+  }
+
+  if (!parse_options(argc, argv, options)) {
+    print_usage();
+
+    return EXIT_FAILURE;
+  }
+
+  if (!load_signal(options, signal)) {
+    return EXIT_FAILURE;
+  }
+
+  nlohmann::json report;
+
+  report["version"] = VERSION;
+  report["commit"] = COMMIT_DESC;
+  report["input"] = options.input.empty() ? "white noise" : options.input;
+  report["results"] = nlohmann::json::array();
+
+  for (const auto& name : options.plugins) {
+    for (const auto& rate : options.rates) {
+      for (const auto& quantum : options.quanta) {
+        report["results"].push_back(run(name, rate, quantum, options, signal));
+      }
+    }
+  }
+
+  std::cout << report.dump(4) << std::endl;
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,307 @@
+/*
+ *  Copyright © 2017-2023 Wellington Wallace
+ *
+ *  This file is part of Easy Effects.
+ *
+ *  Easy Effects is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Easy Effects is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Easy Effects. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+/*
+  Offline render of an audio file through the effects chain of a preset. The chain is built the same way the app
+  builds it but the plugins are driven directly, without a PipeWire server, as fast as the CPU allows. The output is
+  a stereo 32 bit float WAV file aligned with the input. The chain latency is removed from its beginning.
+*/
+
+#include <glib.h>
+#include <sndfile.hh>
+#include <cstdlib>
+#include <iostream>
+#include "plugin_factory.hpp"
+#include "presets_manager.hpp"
+#include "resampler.hpp"
+#include "tags_app.hpp"
+
+namespace {
+
+struct Options {
+  PresetType preset_type = PresetType::output;
+
+  uint quantum = 512U;
+
+  uint rate = 0U;  // the input file rate is used when it is zero
+
+  std::string preset, input, output;
+};
+
+void print_usage() {
+  std::cerr << "Usage: ee-render [OPTION...] PRESET INPUT OUTPUT\n\n"
+            << "PRESET is the name of one of the user presets or the path to a preset file.\n\n"
+            << "  --pipeline=output|input    pipeline section of the preset to use. output by default\n"
+            << "  --quantum=N                frames given to the plugins in each process call. 512 by default\n"
+            << "  --rate=N                   processing and output sampling rate. The input rate by default\n";
+}
+
+auto parse_options(int argc, char* argv[], Options& options) -> bool {
+  const std::vector<std::string> args(argv + 1, argv + argc);
+
+  std::vector<std::string> positional;
+
+  for (const auto& arg : args) {
+    if (!arg.starts_with("--")) {
+      positional.push_back(arg);
+
+      continue;
+    }
+
+    const auto sep = arg.find('=');
+
+    const auto key = arg.substr(0U, sep);
+    const auto value = (sep != std::string::npos) ? arg.substr(sep + 1U) : "";
+
+    bool valid = false;
+
+    if (key == "--pipeline") {
+      valid = value == "output" || value == "input";
+
+      options.preset_type = (value == "input") ? PresetType::input : PresetType::output;
+    } else if (key == "--quantum") {
+      valid = util::str_to_num(value, options.quantum) && options.quantum > 0U;
+    } else if (key == "--rate") {
+      valid = util::str_to_num(value, options.rate) && options.rate > 0U;
+    }
+
+    if (!valid) {
+      std::cerr << "ee-render: invalid option: " << arg << "\n\n";
+
+      return false;
+    }
+  }
+
+  if (positional.size() != 3U) {
+    return false;
+  }
+
+  options.preset = positional[0];
+  options.input = positional[1];
+  options.output = positional[2];
+
+  return true;
+}
+
+auto load_preset(PresetsManager& presets_manager, const Options& options) -> bool {
+  if (std::filesystem::is_regular_file(options.preset)) {
+    return presets_manager.load_preset_from_path(options.preset_type, options.preset);
+  }
+
+  if (!presets_manager.preset_file_exists(options.preset_type, options.preset)) {
+    std::cerr << "ee-render: the preset does not exist: " << options.preset << "\n";
+
+    return false;
+  }
+
+  return presets_manager.load_preset_file(options.preset_type, options.preset);
+}
+
+// creates the plugins in the order saved in the pipeline settings by the preset loader
+
+auto create_chain(const Options& options) -> std::vector<std::shared_ptr<PluginBase>> {
+  const auto is_output = options.preset_type == PresetType::output;
+
+  auto* settings = g_settings_new(is_output ? tags::schema::id_output : tags::schema::id_input);
+
+  const auto schema_base_path = is_output ? tags::app::path_stream_outputs : tags::app::path_stream_inputs;
+
+  std::vector<std::shared_ptr<PluginBase>> chain;
+
+  for (const auto& name : util::gchar_array_to_vector(g_settings_get_strv(settings, "plugins"))) {
+    if (auto plugin = plugin_factory::create(name, "ee-render: ", schema_base_path, nullptr); plugin != nullptr) {
+      if (!plugin->package_installed) {
+        std::cerr << "ee-render: " << name << " is not installed. It will not change the audio\n";
+      }
+
+      chain.push_back(plugin);
+    }
+  }
+
+  g_object_unref(settings);
+
+  return chain;
+}
+
+auto read_input(const Options& options, std::vector<float>& left, std::vector<float>& right, uint& rate) -> bool {
+  SndfileHandle file = SndfileHandle(options.input.c_str());
+
+  if (file.channels() == 0 || file.frames() == 0) {
+    std::cerr << "ee-render: the input file does not exist or is empty: " << options.input << "\n";
+
+    return false;
+  }
+
+  std::vector<float> buffer(file.channels() * file.frames());
+
+  file.readf(buffer.data(), file.frames());
+
+  // mono files are sent to both channels and channels after the second one are ignored
+
+  for (sf_count_t n = 0; n < file.frames(); n++) {
+    left.push_back(buffer[n * file.channels()]);
+    right.push_back(buffer[n * file.channels() + ((file.channels() > 1) ? 1 : 0)]);
+  }
+
+  rate = static_cast<uint>(file.samplerate());
+
+  if (options.rate != 0U && options.rate != rate) {
+    Resampler resampler_L(static_cast<int>(rate), static_cast<int>(options.rate));
+    Resampler resampler_R(static_cast<int>(rate), static_cast<int>(options.rate));
+
+    left = resampler_L.process(left, true);
+    right = resampler_R.process(right, true);
+
+    rate = options.rate;
+  }
+
+  return true;
+}
+
+void render(std::vector<std::shared_ptr<PluginBase>>& chain,
+            const uint& quantum,
+            const uint& rate,
+            std::vector<float>& left,
+            std::vector<float>& right) {
+  /*
+    Most plugins finish their setup in the main loop. begin_quantum() starts it and we iterate the main context until
+    it is done. Some continue it in worker threads. So the first quantum of audio is already processed with everything
+    in place.
+  */
+
+  for (auto& plugin : chain) {
+    plugin->begin_quantum(quantum, rate, 0U);
+    plugin->end_quantum();
+  }
+
+  while (g_main_context_iteration(nullptr, 0) != 0) {
+  }
+
+  for (auto& plugin : chain) {
+    plugin->wait_for_setup();
+  }
+
+  std::vector<float> in_L(quantum), in_R(quantum), out_L(quantum), out_R(quantum);
+
+  std::vector<float> rendered_L, rendered_R;
+
+  const size_t n_frames = left.size();
+
+  size_t n_latency = 0U;
+
+  uint64_t position = 0U;
+
+  // after the input is over silence is processed until the samples delayed by the chain latency come out
+
+  while (position < n_frames + n_latency) {
+    for (size_t n = 0U; n < quantum; n++) {
+      in_L[n] = (position + n < n_frames) ? left[position + n] : 0.0F;
+      in_R[n] = (position + n < n_frames) ? right[position + n] : 0.0F;
+    }
+
+    for (auto& plugin : chain) {
+      std::span l_in(in_L), r_in(in_R), l_out(out_L), r_out(out_R);
+
+      plugin->process_quantum(l_in, r_in, l_out, r_out, rate, position);
+
+      std::swap(in_L, out_L);
+      std::swap(in_R, out_R);
+    }
+
+    rendered_L.insert(rendered_L.end(), in_L.begin(), in_L.end());
+    rendered_R.insert(rendered_R.end(), in_R.begin(), in_R.end());
+
+    position += quantum;
+
+    if (position >= n_frames && n_latency == 0U) {
+      float latency = 0.0F;
+
+      for (auto& plugin : chain) {
+        latency += plugin->get_latency_seconds();
+      }
+
+      n_latency = static_cast<size_t>(std::lround(latency * static_cast<float>(rate)));
+    }
+  }
+
+  left.assign(rendered_L.begin() + n_latency, rendered_L.begin() + n_latency + n_frames);
+  right.assign(rendered_R.begin() + n_latency, rendered_R.begin() + n_latency + n_frames);
+}
+
+auto write_output(const Options& options, const std::vector<float>& left, const std::vector<float>& right, uint rate)
+    -> bool {
+  auto file = SndfileHandle(options.output.c_str(), SFM_WRITE, SF_FORMAT_WAV | SF_FORMAT_FLOAT, 2, rate);
+
+  if (file.error() != 0) {
+    std::cerr << "ee-render: could not create the output file: " << file.strError() << "\n";
+
+    return false;
+  }
+
+  std::vector<float> buffer(2U * left.size());
+
+  dsp::interleave(left, right, buffer);
+
+  return file.writef(buffer.data(), static_cast<sf_count_t>(left.size())) == static_cast<sf_count_t>(left.size());
+}
+
+}  // namespace
+
+auto main(int argc, char* argv[]) -> int {
+  // the preset is loaded into settings that only exist in memory. The user's configuration is not touched
+
+  g_setenv("GSETTINGS_BACKEND", "memory", 1);
+
+  Options options;
+
+  if (!parse_options(argc, argv, options)) {
+    print_usage();
+
+    return EXIT_FAILURE;
+  }
+
+  std::vector<float> left, right;
+
+  uint rate = 0U;
+
+  if (!read_input(options, left, right, rate)) {
+    return EXIT_FAILURE;
+  }
+
+  PresetsManager presets_manager;
+
+  presets_manager.preset_load_error.connect([](const std::string& title, const std::string& description) {
+    std::cerr << "ee-render: " << title << ". " << description << "\n";
+  });
+
+  if (!load_preset(presets_manager, options)) {
+    return EXIT_FAILURE;
+  }
+
+  auto chain = create_chain(options);
+
+  render(chain, options.quantum, rate, left, right);
+
+  if (!write_output(options, left, right, rate)) {
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
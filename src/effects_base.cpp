@@ -18,7 +18,83 @@
  */
 
 #include "effects_base.hpp"
-#include "level_meter.hpp"
+#include "plugin_factory.hpp"
+
+namespace {
+
+/*
+  Cross-correlation of the recording with the measurement sequence computed with FFTW. Returns the offset of the
+  largest correlation magnitude and the ratio between it and the rms of the correlation over all the offsets.
+*/
+
+auto find_sequence(const std::span<const float>& recording, const std::vector<float>& sequence)
+    -> std::optional<std::pair<size_t, float>> {
+  if (recording.size() < sequence.size() || sequence.empty()) {
+    return std::nullopt;
+  }
+
+  const auto fft_size = std::bit_ceil(recording.size() + sequence.size());
+  const auto n_bins = (fft_size / 2U) + 1U;
+
+  auto* real = fftwf_alloc_real(fft_size);
+  auto* recording_spectrum = fftwf_alloc_complex(n_bins);
+  auto* sequence_spectrum = fftwf_alloc_complex(n_bins);
+
+  auto* forward = fftwf_plan_dft_r2c_1d(static_cast<int>(fft_size), real, recording_spectrum, FFTW_ESTIMATE);
+  auto* backward = fftwf_plan_dft_c2r_1d(static_cast<int>(fft_size), recording_spectrum, real, FFTW_ESTIMATE);
+
+  std::fill(real, real + fft_size, 0.0F);
+  std::ranges::copy(sequence, real);
+
+  fftwf_execute_dft_r2c(forward, real, sequence_spectrum);
+
+  std::fill(real, real + fft_size, 0.0F);
+  std::ranges::copy(recording, real);
+
+  fftwf_execute(forward);
+
+  // recording times the conjugate of the sequence gives the correlation at positive offsets
+
+  for (size_t k = 0U; k < n_bins; k++) {
+    const auto re = recording_spectrum[k][0];
+    const auto im = recording_spectrum[k][1];
+
+    recording_spectrum[k][0] = re * sequence_spectrum[k][0] + im * sequence_spectrum[k][1];
+    recording_spectrum[k][1] = im * sequence_spectrum[k][0] - re * sequence_spectrum[k][1];
+  }
+
+  fftwf_execute(backward);
+
+  const auto n_offsets = recording.size() - sequence.size() + 1U;
+
+  size_t peak_offset = 0U;
+  float peak = 0.0F;
+  double energy = 0.0;
+
+  for (size_t n = 0U; n < n_offsets; n++) {
+    const auto v = std::fabs(real[n]);
+
+    energy += static_cast<double>(v) * static_cast<double>(v);
+
+    if (v > peak) {
+      peak = v;
+      peak_offset = n;
+    }
+  }
+
+  fftwf_destroy_plan(forward);
+  fftwf_destroy_plan(backward);
+
+  fftwf_free(real);
+  fftwf_free(recording_spectrum);
+  fftwf_free(sequence_spectrum);
+
+  const auto rms = static_cast<float>(std::sqrt(energy / static_cast<double>(n_offsets)));
+
+  return std::make_pair(peak_offset, (rms > 0.0F) ? peak / rms : 0.0F);
+}
+
+}  // namespace
 
 EffectsBase::EffectsBase(std::string tag, const std::string& schema, PipeManager* pipe_manager)
     : log_tag(std::move(tag)),
@@ -36,12 +112,31 @@ EffectsBase::EffectsBase(std::string tag, const std::string& schema, PipeManager
 
   spectrum = std::make_shared<Spectrum>(log_tag, tags::schema::spectrum::id, tags::app::path + "/spectrum/"s, pm);
 
-  if (!output_level->connected_to_pw) {
-    output_level->connect_to_pw();
+  output_level->dsp_cycle = &dsp_cycle;
+  spectrum->dsp_cycle = &dsp_cycle;
+
+  // the output level meter is always at the end of the chain. Its quantum is the one the graph gives to all of us
+
+  connections.push_back(output_level->negotiated_quantum.connect([this](const uint& quantum) {
+    negotiated_quantum = quantum;
+
+    util::debug(log_tag + "negotiated quantum: " + util::to_string(quantum));
+
+    quantum_negotiated.emit(quantum);
+
+    check_quantum_request();
+  }));
+
+  const auto output_level_started = !output_level->connected_to_pw && output_level->start_connect_to_pw();
+
+  const auto spectrum_started = !spectrum->connected_to_pw && spectrum->start_connect_to_pw();
+
+  if (output_level_started) {
+    output_level->wait_connected_to_pw();
   }
 
-  if (!spectrum->connected_to_pw) {
-    spectrum->connect_to_pw();
+  if (spectrum_started) {
+    spectrum->wait_connected_to_pw();
   }
 
   create_filters_if_necessary();
@@ -93,6 +188,12 @@ EffectsBase::EffectsBase(std::string tag, const std::string& schema, PipeManager
 }
 
 EffectsBase::~EffectsBase() {
+  cancel_latency_measurement();
+
+  if (quantum_check_timer != 0U) {
+    g_source_remove(quantum_check_timer);
+  }
+
   for (auto& c : connections) {
     c.disconnect();
   }
@@ -132,137 +233,673 @@ void EffectsBase::create_filters_if_necessary() {
       continue;
     }
 
-    auto instance_id = util::to_string(tags::plugin_name::get_id(name));
-
-    auto path = schema_base_path + tags::plugin_name::get_base_name(name) + "/" + instance_id + "/";
-
-    path.erase(std::remove(path.begin(), path.end(), '_'), path.end());
-
-    std::shared_ptr<PluginBase> filter;
-
-    if (name.starts_with(tags::plugin_name::autogain)) {
-      filter = std::make_shared<AutoGain>(log_tag, tags::schema::autogain::id, path, pm);
-    } else if (name.starts_with(tags::plugin_name::bass_enhancer)) {
-      filter = std::make_shared<BassEnhancer>(log_tag, tags::schema::bass_enhancer::id, path, pm);
-    } else if (name.starts_with(tags::plugin_name::bass_loudness)) {
-      filter = std::make_shared<BassLoudness>(log_tag, tags::schema::bass_loudness::id, path, pm);
-    } else if (name.starts_with(tags::plugin_name::compressor)) {
-      filter = std::make_shared<Compressor>(log_tag, tags::schema::compressor::id, path, pm);
-    } else if (name.starts_with(tags::plugin_name::convolver)) {
-      filter = std::make_shared<Convolver>(log_tag, tags::schema::convolver::id, path, pm);
-    } else if (name.starts_with(tags::plugin_name::crossfeed)) {
-      filter = std::make_shared<Crossfeed>(log_tag, tags::schema::crossfeed::id, path, pm);
-    } else if (name.starts_with(tags::plugin_name::crystalizer)) {
-      filter = std::make_shared<Crystalizer>(log_tag, tags::schema::crystalizer::id, path, pm);
-    } else if (name.starts_with(tags::plugin_name::deepfilternet)) {
-      filter = std::make_shared<DeepFilterNet>(log_tag, tags::schema::deepfilternet::id, path, pm);
-    } else if (name.starts_with(tags::plugin_name::deesser)) {
-      filter = std::make_shared<Deesser>(log_tag, tags::schema::deesser::id, path, pm);
-    } else if (name.starts_with(tags::plugin_name::delay)) {
-      filter = std::make_shared<Delay>(log_tag, tags::schema::delay::id, path, pm);
-    } else if (name.starts_with(tags::plugin_name::echo_canceller)) {
-      filter = std::make_shared<EchoCanceller>(log_tag, tags::schema::echo_canceller::id, path, pm);
-    } else if (name.starts_with(tags::plugin_name::exciter)) {
-      filter = std::make_shared<Exciter>(log_tag, tags::schema::exciter::id, path, pm);
-    } else if (name.starts_with(tags::plugin_name::expander)) {
-      filter = std::make_shared<Expander>(log_tag, tags::schema::expander::id, path, pm);
-    } else if (name.starts_with(tags::plugin_name::equalizer)) {
-      filter =
-          std::make_shared<Equalizer>(log_tag, tags::schema::equalizer::id, path, tags::schema::equalizer::channel_id,
-                                      schema_base_path + "equalizer/" + instance_id + "/leftchannel/",
-                                      schema_base_path + "equalizer/" + instance_id + "/rightchannel/", pm);
-    } else if (name.starts_with(tags::plugin_name::filter)) {
-      filter = std::make_shared<Filter>(log_tag, tags::schema::filter::id, path, pm);
-    } else if (name.starts_with(tags::plugin_name::gate)) {
-      filter = std::make_shared<Gate>(log_tag, tags::schema::gate::id, path, pm);
-    } else if (name.starts_with(tags::plugin_name::level_meter)) {
-      filter = std::make_shared<LevelMeter>(log_tag, tags::schema::level_meter::id, path, pm);
-    } else if (name.starts_with(tags::plugin_name::limiter)) {
-      filter = std::make_shared<Limiter>(log_tag, tags::schema::limiter::id, path, pm);
-    } else if (name.starts_with(tags::plugin_name::loudness)) {
-      filter = std::make_shared<Loudness>(log_tag, tags::schema::loudness::id, path, pm);
-    } else if (name.starts_with(tags::plugin_name::maximizer)) {
-      filter = std::make_shared<Maximizer>(log_tag, tags::schema::maximizer::id, path, pm);
-    } else if (name.starts_with(tags::plugin_name::multiband_compressor)) {
-      filter = std::make_shared<MultibandCompressor>(log_tag, tags::schema::multiband_compressor::id, path, pm);
-    } else if (name.starts_with(tags::plugin_name::multiband_gate)) {
-      filter = std::make_shared<MultibandGate>(log_tag, tags::schema::multiband_gate::id, path, pm);
-    } else if (name.starts_with(tags::plugin_name::pitch)) {
-      filter = std::make_shared<Pitch>(log_tag, tags::schema::pitch::id, path, pm);
-    } else if (name.starts_with(tags::plugin_name::reverb)) {
-      filter = std::make_shared<Reverb>(log_tag, tags::schema::reverb::id, path, pm);
-    } else if (name.starts_with(tags::plugin_name::rnnoise)) {
-      filter = std::make_shared<RNNoise>(log_tag, tags::schema::rnnoise::id, path, pm);
-    } else if (name.starts_with(tags::plugin_name::speex)) {
-      filter = std::make_shared<Speex>(log_tag, tags::schema::speex::id, path, pm);
-    } else if (name.starts_with(tags::plugin_name::stereo_tools)) {
-      filter = std::make_shared<StereoTools>(log_tag, tags::schema::stereo_tools::id, path, pm);
+    if (auto plugin = take_pooled_plugin(name); plugin != nullptr) {
+      plugins.insert(std::make_pair(name, plugin));
+
+      continue;
+    }
+
+    auto filter = plugin_factory::create(name, log_tag, schema_base_path, pm);
+
+    if (filter == nullptr) {
+      continue;
     }
 
     connections.push_back(filter->latency.connect([=, this]() { broadcast_pipeline_latency(); }));
 
+    filter->dsp_cycle = &dsp_cycle;
+
     plugins.insert(std::make_pair(name, filter));
   }
 }
 
-void EffectsBase::remove_unused_filters() {
-  const auto list = util::gchar_array_to_vector(g_settings_get_strv(settings, "plugins"));
+void EffectsBase::activate_filters() {
+  for (auto& plugin : plugins | std::views::values) {
+    plugin->set_active(true);
+  }
+}
 
-  if (list.empty()) {
-    plugins.clear();
+void EffectsBase::deactivate_filters() {
+  for (auto& plugin : plugins | std::views::values) {
+    plugin->set_active(false);
+  }
+}
 
-    return;
+auto EffectsBase::get_pipeline_latency() -> float {
+  float total = 0.0F;
+
+  for (const auto& name : util::gchar_array_to_vector(g_settings_get_strv(settings, "plugins"))) {
+    if (plugins.contains(name)) {
+      total += plugins[name]->get_latency_seconds();
+    }
   }
 
-  for (auto it = plugins.begin(); it != plugins.end();) {
-    auto key = it->first;
+  return total * 1000.0F;
+}
 
-    if (std::ranges::find(list, key) == list.end()) {
-      auto plugin = it->second;
+void EffectsBase::broadcast_pipeline_latency() {
+  const auto latency_value = get_pipeline_latency();
+
+  util::debug(log_tag + "pipeline latency: " + util::to_string(latency_value, "") + " ms");
+
+  pipeline_latency.emit(latency_value);
+}
 
-      plugin->bypass = true;
-      plugin->set_post_messages(false);
-      plugin->latency.clear();
+auto EffectsBase::prepare_chain_nodes(const std::vector<std::string>& list) -> std::vector<uint> {
+  std::vector<uint> node_ids;
+  std::vector<std::shared_ptr<PluginBase>> nodes, starting, segment;
 
+  const auto use_fused_pipeline = g_settings_get_boolean(global_settings, "use-fused-pipeline") != 0;
+
+  size_t n_chains = 0U;
+
+  /*
+    The nodes that are not connected yet are only started here. We wait for all of them at the end so PipeWire can
+    set them up at the same time.
+  */
+
+  auto add_node = [&](const std::shared_ptr<PluginBase>& node) {
+    if (!node->connected_to_pw) {
+      if (!node->start_connect_to_pw()) {
+        return;
+      }
+
+      starting.push_back(node);
+    }
+
+    nodes.push_back(node);
+  };
+
+  auto flush_segment = [&]() {
+    // there is nothing to gain fusing a single plugin
+
+    if (segment.size() < 2U) {
+      for (const auto& plugin : segment) {
+        add_node(plugin);
+      }
+
+      segment.clear();
+
+      return;
+    }
+
+    if (n_chains == fused_chains.size()) {
+      fused_chains.push_back(std::make_shared<FusedChain>(
+          log_tag, tags::schema::fused_chain::id, schema_base_path + "fusedchain/" + util::to_string(n_chains) + "/",
+          pm));
+    }
+
+    auto chain = fused_chains[n_chains++];
+
+    for (const auto& plugin : segment) {
       if (plugin->connected_to_pw) {
         plugin->disconnect_from_pw();
       }
+    }
+
+    chain->set_plugins(segment);
+
+    add_node(chain);
+
+    segment.clear();
+  };
+
+  for (const auto& name : list) {
+    if (!plugins.contains(name)) {
+      continue;
+    }
+
+    const auto& plugin = plugins[name];
+
+    if (use_fused_pipeline && FusedChain::can_be_fused(plugin)) {
+      segment.push_back(plugin);
+    } else {
+      flush_segment();
+
+      add_node(plugin);
+    }
+  }
+
+  flush_segment();
+
+  /*
+    The chains that are not needed anymore leave the graph. Otherwise each one would stay there as an idle node that
+    costs a graph cycle per quantum. They also must not hold plugins that may be linked as standalone nodes. The
+    objects are kept so a later chain layout can connect them again.
+  */
+
+  for (size_t n = n_chains; n < fused_chains.size(); n++) {
+    if (fused_chains[n]->connected_to_pw) {
+      fused_chains[n]->disconnect_from_pw();
+    }
+
+    fused_chains[n]->set_plugins({});
+  }
+
+  for (const auto& node : starting) {
+    node->wait_connected_to_pw();
+  }
+
+  for (const auto& node : nodes) {
+    if (node->connected_to_pw) {
+      node_ids.push_back(node->get_node_id());
+    }
+  }
+
+  return node_ids;
+}
+
+void EffectsBase::insert_node_links(std::set<uint>& link_ids, const uint& node_id) {
+  for (const auto& link : pm->links_from_node(node_id)) {
+    link_ids.insert(link.id);
+  }
+
+  for (const auto& link : pm->links_to_node(node_id)) {
+    link_ids.insert(link.id);
+  }
+}
+
+void EffectsBase::link_chain(const std::vector<uint>& node_ids,
+                             const std::vector<LinkEdge>& probe_edges,
+                             const bool& mono_source) {
+  chain_nodes = node_ids;
+
+  std::set<LinkEdge> wanted(probe_edges.begin(), probe_edges.end());
+
+  for (size_t n = 1U; n < node_ids.size(); n++) {
+    wanted.insert({.output_node_id = node_ids[n - 1U], .input_node_id = node_ids[n]});
+  }
+
+  /*
+    The edges that are not wanted anymore are destroyed before the new ones are created. Otherwise the input of a node
+    could be fed by the old and the new paths at the same time for a moment. Edges whose links were removed by the
+    server, like when one of their nodes was disconnected, are also created again.
+  */
+
+  std::vector<pw_proxy*> stale;
+
+  auto destroy_edge_if = [&](const auto& predicate) {
+    for (auto it = chain_links.begin(); it != chain_links.end();) {
+      if (predicate(it->first, it->second)) {
+        stale.insert(stale.end(), it->second.begin(), it->second.end());
+
+        it = chain_links.erase(it);
+      } else {
+        it++;
+      }
+    }
+
+    pm->destroy_links(stale);
+
+    stale.clear();
+  };
+
+  destroy_edge_if([&](const LinkEdge& edge, const std::vector<pw_proxy*>& proxies) {
+    const auto n_alive = pm->links_between(edge.output_node_id, edge.input_node_id).size();
+
+    return !wanted.contains(edge) || n_alive < proxies.size();
+  });
+
+  std::set<LinkEdge> used(probe_edges.begin(), probe_edges.end());
+
+  PipeManager::LinkTransaction transaction(pm);
+
+  auto source_linked = !mono_source;
+
+  uint prev_node_id = node_ids.empty() ? SPA_ID_INVALID : node_ids.front();
+
+  for (size_t n = 1U; n < node_ids.size(); n++) {
+    const uint next_node_id = node_ids[n];
+
+    const LinkEdge edge{.output_node_id = prev_node_id, .input_node_id = next_node_id};
+
+    if (chain_links.contains(edge)) {
+      used.insert(edge);
+
+      prev_node_id = next_node_id;
+      source_linked = true;
+
+      continue;
+    }
+
+    const auto n_links = transaction.add(prev_node_id, next_node_id);
 
-      it = plugins.erase(it);
+    if ((source_linked && n_links == 2U) || (!source_linked && n_links != 0U)) {
+      used.insert(edge);
+
+      prev_node_id = next_node_id;
+      source_linked = true;
     } else {
+      util::warning(log_tag + "link from node " + util::to_string(prev_node_id) + " to node " +
+                    util::to_string(next_node_id) + " failed");
+    }
+  }
+
+  for (const auto& edge : probe_edges) {
+    if (!chain_links.contains(edge)) {
+      transaction.add(edge.output_node_id, edge.input_node_id, true);
+    }
+  }
+
+  // a single roundtrip to the server for all the links above
+
+  for (auto& [edge, proxies] : transaction.commit()) {
+    auto& list = chain_links[edge];
+
+    list.insert(list.end(), proxies.begin(), proxies.end());
+  }
+
+  // when a node could not be linked its neighbours were linked directly and the edges around it are not used
+
+  destroy_edge_if([&](const LinkEdge& edge, const auto& /*proxies*/) { return !used.contains(edge); });
+}
+
+void EffectsBase::unlink_chain() {
+  std::vector<pw_proxy*> list;
+
+  for (const auto& proxies : chain_links | std::views::values) {
+    list.insert(list.end(), proxies.begin(), proxies.end());
+  }
+
+  pm->destroy_links(list);
+
+  chain_links.clear();
+
+  chain_nodes.clear();
+}
+
+auto EffectsBase::get_requested_quantum() const -> uint {
+  return requested_quantum;
+}
+
+void EffectsBase::update_quantum_request(const std::vector<std::string>& list) {
+  const auto needs_power_of_2 = std::ranges::any_of(
+      list, [&](const auto& name) { return plugins.contains(name) && plugins[name]->needs_power_of_2_blocks(); });
+
+  uint rate = 0U;
+  uint quantum = 0U;
+  uint min_quantum = 0U;
+
+  util::str_to_num(pm->default_clock_rate, rate);
+  util::str_to_num(pm->default_quantum, quantum);
+  util::str_to_num(pm->default_min_quantum, min_quantum);
+
+  if (!needs_power_of_2 || rate == 0U || quantum == 0U) {
+    quantum = 0U;
+  } else {
+    // the smallest node.latency in the graph wins. So asking for less than the default is what actually has effect
+
+    quantum = std::max(std::bit_floor(quantum), std::bit_ceil(min_quantum));
+  }
+
+  for (const auto& plugin : plugins | std::views::values) {
+    plugin->request_quantum(quantum, rate);
+  }
+
+  for (const auto& chain : fused_chains) {
+    chain->request_quantum(quantum, rate);
+  }
+
+  spectrum->request_quantum(quantum, rate);
+  output_level->request_quantum(quantum, rate);
+
+  if (quantum != requested_quantum) {
+    requested_quantum = quantum;
+
+    util::debug(log_tag + "requested quantum: " + util::to_string(quantum));
+
+    quantum_request.emit(quantum);
+
+    /*
+      If the graph already runs with another quantum that it keeps our output level meter does not report a new one.
+      So the request is also checked a little after it is made.
+    */
+
+    if (quantum_check_timer != 0U) {
+      g_source_remove(quantum_check_timer);
+    }
+
+    quantum_check_timer = g_timeout_add(1000U, GSourceFunc(+[](gpointer user_data) {
+                                          auto* self = static_cast<EffectsBase*>(user_data);
+
+                                          self->quantum_check_timer = 0U;
+
+                                          self->check_quantum_request();
+
+                                          return G_SOURCE_REMOVE;
+                                        }),
+                                        this);
+  }
+}
+
+auto EffectsBase::get_negotiated_quantum() const -> uint {
+  return negotiated_quantum;
+}
+
+void EffectsBase::check_quantum_request() {
+  if (requested_quantum == 0U || negotiated_quantum == 0U || negotiated_quantum == requested_quantum) {
+    return;
+  }
+
+  util::warning(log_tag + "we asked for a quantum of " + util::to_string(requested_quantum) +
+                " but the graph runs with " + util::to_string(negotiated_quantum) +
+                ". Another client probably asked for a smaller one");
+}
+
+void EffectsBase::release_unused_plugins() {
+  const auto list = util::gchar_array_to_vector(g_settings_get_strv(settings, "plugins"));
+
+  for (auto it = plugins.begin(); it != plugins.end();) {
+    if (std::ranges::find(list, it->first) != list.end()) {
       it++;
+
+      continue;
+    }
+
+    const auto& plugin = it->second;
+
+    plugin->set_post_messages(false);
+
+    if (plugin->connected_to_pw) {
+      plugin->set_active(false);
+    }
+
+    util::debug(log_tag + "moving the " + it->first + " filter to the instance pool");
+
+    plugin_pool.emplace_front(it->first, plugin);
+
+    it = plugins.erase(it);
+  }
+
+  while (plugin_pool.size() > plugin_pool_size) {
+    const auto [name, plugin] = plugin_pool.back();
+
+    plugin_pool.pop_back();
+
+    util::debug(log_tag + "destroying the " + name + " filter that was the least recently used in the pool");
+
+    if (plugin->connected_to_pw) {
+      plugin->disconnect_from_pw();
     }
   }
 }
 
-void EffectsBase::activate_filters() {
-  for (auto& plugin : plugins | std::views::values) {
+auto EffectsBase::take_pooled_plugin(const std::string& name) -> std::shared_ptr<PluginBase> {
+  const auto it = std::ranges::find_if(plugin_pool, [&](const auto& entry) { return entry.first == name; });
+
+  if (it == plugin_pool.end()) {
+    return nullptr;
+  }
+
+  auto plugin = it->second;
+
+  plugin_pool.erase(it);
+
+  // the settings of the instance were already updated by the preset that is being loaded
+
+  plugin->notification_time_window =
+      0.001F * static_cast<float>(g_settings_get_int(global_settings, "meters-update-interval"));
+
+  // the audio it held when it was released must not come out again. Its filter is still inactive so this is safe
+
+  plugin->reset();
+
+  if (plugin->connected_to_pw) {
     plugin->set_active(true);
   }
+
+  util::debug(log_tag + "reusing the " + name + " filter from the instance pool");
+
+  return plugin;
 }
 
-void EffectsBase::deactivate_filters() {
-  for (auto& plugin : plugins | std::views::values) {
-    plugin->set_active(false);
+auto EffectsBase::apps_want_to_play() -> bool {
+  return false;
+}
+
+auto EffectsBase::start_latency_measurement(TestSignals* test_signals) -> bool {
+  // the first node is the source. The sequence enters the chain right after it
+
+  if (measurement_timer != 0U || chain_nodes.size() < 2U) {
+    return false;
   }
+
+  /*
+    The recordings of the apps would be mixed with the sequence and they would hear it. We also do not want to mute
+    them in the middle of a song.
+  */
+
+  if (apps_want_to_play()) {
+    util::warning(log_tag + "the latency can not be measured while apps are using the effects chain");
+
+    return false;
+  }
+
+  const auto rate = (output_level->rate != 0U) ? output_level->rate : 48000U;
+
+  // the sequence leaves 200 ms after the start. One more second is more than any chain we build can delay it
+
+  const auto sequence_ms = 1000U * test_signals->probe_sequence.size() / rate;
+
+  const auto timeout = 1200U + static_cast<guint>(sequence_ms) + static_cast<guint>(get_pipeline_latency());
+
+  const auto capacity = [&](const uint& plugin_rate) {
+    return static_cast<size_t>(timeout) * ((plugin_rate != 0U) ? plugin_rate : rate) / 1000U;
+  };
+
+  const auto list = util::gchar_array_to_vector(g_settings_get_strv(settings, "plugins"));
+
+  for (const auto& name : list) {
+    if (plugins.contains(name)) {
+      plugins[name]->arm_latency_probe(capacity(plugins[name]->rate));
+    }
+  }
+
+  output_level->arm_latency_probe(capacity(output_level->rate), true);
+
+  if (!test_signals->start_latency_measurement(chain_nodes[1])) {
+    util::warning(log_tag +
+                  "could not start the latency measurement. The test signal must be disabled and no application "
+                  "should be playing");
+
+    release_latency_probes();
+
+    return false;
+  }
+
+  measurement_signals = test_signals;
+
+  measurement_timer = g_timeout_add(timeout, GSourceFunc(+[](gpointer user_data) {
+                                      static_cast<EffectsBase*>(user_data)->finish_latency_measurement();
+
+                                      return G_SOURCE_REMOVE;
+                                    }),
+                                    this);
+
+  util::debug(log_tag + "latency measurement started");
+
+  return true;
 }
 
-auto EffectsBase::get_pipeline_latency() -> float {
-  float total = 0.0F;
+void EffectsBase::release_latency_probes() {
+  const auto release = [](PluginBase& plugin) {
+    plugin.disarm_latency_probe();
+
+    plugin.latency_probe.input = std::vector<float>();
+    plugin.latency_probe.output = std::vector<float>();
+  };
+
+  for (const auto& plugin : plugins | std::views::values) {
+    release(*plugin);
+  }
+
+  release(*output_level);
+}
+
+void EffectsBase::cancel_latency_measurement() {
+  if (measurement_timer == 0U) {
+    return;
+  }
+
+  g_source_remove(measurement_timer);
+
+  measurement_timer = 0U;
+
+  measurement_signals->stop_latency_measurement();
+
+  release_latency_probes();
+}
+
+void EffectsBase::finish_latency_measurement() {
+  measurement_timer = 0U;
+
+  const auto probe_position = measurement_signals->stop_latency_measurement();
+
+  const auto& sequence = measurement_signals->probe_sequence;
+
+  for (const auto& plugin : plugins | std::views::values) {
+    plugin->disarm_latency_probe();
+  }
+
+  output_level->disarm_latency_probe();
+
+  /*
+    A correlation peak less than 10 times the rms of the correlation is not trusted. It happens when the sequence was
+    buried in noise or smeared by a long reverb. Differences below 1 ms are not reported as a mismatch because the
+    correlation peak of filters is not always at their delay.
+  */
+
+  constexpr float min_peak_to_noise = 10.0F;
+  constexpr float tolerance = 1.0F;
+
+  const auto to_ms = [](const uint64_t& frames, const uint& rate) {
+    return (rate != 0U) ? 1000.0F * static_cast<float>(frames) / static_cast<float>(rate) : 0.0F;
+  };
+
+  // graph position at which the sequence starts in a recording of the probe
+
+  const auto locate = [&](const std::vector<float>& recording, const std::atomic<size_t>& count,
+                          const std::atomic<uint64_t>& start, const std::atomic<bool>& started,
+                          const std::string& name) -> std::optional<uint64_t> {
+    if (!probe_position.has_value() || !started) {
+      return std::nullopt;
+    }
+
+    const auto match = find_sequence(std::span(recording.data(), count.load(std::memory_order_acquire)), sequence);
+
+    if (!match.has_value()) {
+      return std::nullopt;
+    }
+
+    if (match->second < min_peak_to_noise) {
+      util::debug(log_tag + name + ": the measurement sequence was not found. Correlation peak to noise ratio: " +
+                  util::to_string(match->second, ""));
+
+      return std::nullopt;
+    }
+
+    return start + match->first;
+  };
+
+  LatencyMeasurement result;
+
+  result.reported_total = get_pipeline_latency();
+
+  const auto& level_probe = output_level->latency_probe;
+
+  if (const auto end = locate(level_probe.input, level_probe.input_count, level_probe.input_start,
+                              level_probe.input_started, "output level");
+      end.has_value() && *end >= *probe_position) {
+    result.valid = true;
+
+    result.total = to_ms(*end - *probe_position, output_level->rate);
+  }
 
   for (const auto& name : util::gchar_array_to_vector(g_settings_get_strv(settings, "plugins"))) {
-    if (plugins.contains(name)) {
-      total += plugins[name]->get_latency_seconds();
+    if (!plugins.contains(name)) {
+      continue;
+    }
+
+    const auto& plugin = plugins[name];
+    const auto& probe = plugin->latency_probe;
+
+    LatencyMeasurement::Stage stage{.name = name, .reported = 1000.0F * plugin->get_latency_seconds()};
+
+    const auto input = locate(probe.input, probe.input_count, probe.input_start, probe.input_started, name);
+    const auto output = locate(probe.output, probe.output_count, probe.output_start, probe.output_started, name);
+
+    if (input.has_value() && output.has_value() && *input >= *probe_position && *output >= *input) {
+      stage.reached = true;
+
+      stage.measured = to_ms(*output - *input, plugin->rate);
+
+      stage.mismatch = std::fabs(stage.measured - stage.reported) > tolerance;
+
+      if (stage.mismatch) {
+        util::warning(log_tag + name + " reports " + util::to_string(stage.reported, "") + " ms of latency but " +
+                      util::to_string(stage.measured, "") + " ms were measured");
+      }
     }
+
+    result.stages.push_back(stage);
   }
 
-  return total * 1000.0F;
+  release_latency_probes();
+
+  if (result.valid) {
+    util::debug(log_tag + "measured latency: " + util::to_string(result.total, "") + " ms. Reported: " +
+                util::to_string(result.reported_total, "") + " ms");
+  } else {
+    util::warning(log_tag + "the latency measurement sequence was not found at the end of the chain");
+  }
+
+  latency_measured.emit(result);
 }
 
-void EffectsBase::broadcast_pipeline_latency() {
-  const auto latency_value = get_pipeline_latency();
+auto EffectsBase::get_dsp_load(const std::string& name) const -> DspLoad::Stats {
+  if (const auto it = plugins.find(name); it != plugins.end()) {
+    return it->second->dsp_load.stats();
+  }
 
-  util::debug(log_tag + "pipeline latency: " + util::to_string(latency_value, "") + " ms");
+  return {};
+}
 
-  pipeline_latency.emit(latency_value);
+auto EffectsBase::get_dsp_load_report() -> nlohmann::json {
+  nlohmann::json json;
+
+  const auto add = [&](const std::string& name, const PluginBase& plugin) {
+    const auto s = plugin.dsp_load.stats();
+
+    json["plugins"].push_back({{"name", name},
+                               {"count", s.count},
+                               {"mean-us", s.mean},
+                               {"p99-us", s.p99},
+                               {"max-us", s.max},
+                               {"load-percent", s.load},
+                               {"overruns", s.overruns}});
+  };
+
+  json["rate"] = output_level->rate;
+  json["quantum"] = output_level->n_samples;
+  json["plugins"] = nlohmann::json::array();
+
+  for (const auto& name : util::gchar_array_to_vector(g_settings_get_strv(settings, "plugins"))) {
+    if (plugins.contains(name)) {
+      add(name, *plugins[name]);
+    }
+  }
+
+  add("spectrum", *spectrum);
+  add("output_level", *output_level);
+
+  return json;
+}
+
+void EffectsBase::reset_dsp_load() {
+  for (const auto& plugin : plugins | std::views::values) {
+    plugin->dsp_load.reset();
+  }
+
+  spectrum->dsp_load.reset();
+  output_level->dsp_load.reset();
 }
@@ -18,6 +18,8 @@
  */
 
 #include "effects_box.hpp"
+#include <fstream>
+#include <iomanip>
 
 namespace {
 
@@ -265,6 +267,37 @@ void on_listen_mic_toggled(EffectsBox* self, GtkToggleButton* button) {
   self->data->application->sie->set_listen_to_mic(gtk_toggle_button_get_active(button) != 0);
 }
 
+void on_save_dsp_load_report(EffectsBox* self, GtkButton* button) {
+  auto* active_window = gtk_application_get_active_window(GTK_APPLICATION(self->data->application));
+
+  auto* dialog = gtk_file_dialog_new();
+
+  gtk_file_dialog_set_title(dialog, _("Save the DSP Load Report"));
+  gtk_file_dialog_set_accept_label(dialog, _("Save"));
+  gtk_file_dialog_set_initial_name(dialog, "dsp_load.json");
+
+  gtk_file_dialog_save(
+      dialog, active_window, nullptr,
+      +[](GObject* source_object, GAsyncResult* result, gpointer user_data) {
+        auto* self = static_cast<EffectsBox*>(user_data);
+        auto* dialog = GTK_FILE_DIALOG(source_object);
+
+        if (auto* file = gtk_file_dialog_save_finish(dialog, result, nullptr); file != nullptr) {
+          auto* path = g_file_get_path(file);
+
+          std::ofstream o(path);
+
+          o << std::setw(4) << self->data->effects_base->get_dsp_load_report() << std::endl;
+
+          util::debug(std::string("DSP load report saved to: ") + path);
+
+          g_free(path);
+          g_object_unref(file);
+        }
+      },
+      self);
+}
+
 void setup(EffectsBox* self, app::Application* application, PipelineType pipeline_type, GtkIconTheme* icon_theme) {
   self->data->application = application;
   self->data->pipeline_type = pipeline_type;
@@ -522,6 +555,7 @@ void effects_box_class_init(EffectsBoxClass* klass) {
 
   gtk_widget_class_bind_template_callback(widget_class, stack_visible_child_changed);
   gtk_widget_class_bind_template_callback(widget_class, on_listen_mic_toggled);
+  gtk_widget_class_bind_template_callback(widget_class, on_save_dsp_load_report);
 }
 
 void effects_box_init(EffectsBox* self) {
@@ -32,6 +32,16 @@ Expander::Expander(const std::string& tag,
     util::debug(log_tag + "http://lsp-plug.in/plugins/lv2/sc_expander_stereo is not installed");
   }
 
+  out_latency_port = lv2_wrapper->get_control_port_index("out_latency");
+  rlm_l_port = lv2_wrapper->get_control_port_index("rlm_l");
+  rlm_r_port = lv2_wrapper->get_control_port_index("rlm_r");
+  slm_l_port = lv2_wrapper->get_control_port_index("slm_l");
+  slm_r_port = lv2_wrapper->get_control_port_index("slm_r");
+  clm_l_port = lv2_wrapper->get_control_port_index("clm_l");
+  clm_r_port = lv2_wrapper->get_control_port_index("clm_r");
+  elm_l_port = lv2_wrapper->get_control_port_index("elm_l");
+  elm_r_port = lv2_wrapper->get_control_port_index("elm_r");
+
   gconnections.push_back(g_signal_connect(settings, "changed::sidechain-type",
                                           G_CALLBACK(+[](GSettings* settings, const char* key, gpointer user_data) {
                                             auto* self = static_cast<Expander*>(user_data);
@@ -99,6 +109,8 @@ Expander::Expander(const std::string& tag,
 }
 
 Expander::~Expander() {
+  stop_notifications();
+
   if (connected_to_pw) {
     disconnect_from_pw();
   }
@@ -131,22 +143,18 @@ void Expander::process(std::span<float>& left_in,
     return;
   }
 
-  if (input_gain != 1.0F) {
-    apply_gain(left_in, right_in, input_gain);
-  }
+  apply_input_gain(left_in, right_in);
 
   lv2_wrapper->connect_data_ports(left_in, right_in, left_out, right_out, probe_left, probe_right);
   lv2_wrapper->run();
 
-  if (output_gain != 1.0F) {
-    apply_gain(left_out, right_out, output_gain);
-  }
+  apply_output_gain(left_out, right_out);
 
   /*
    This plugin gives the latency in number of samples
  */
 
-  const auto lv = static_cast<uint>(lv2_wrapper->get_control_port_value("out_latency"));
+  const auto lv = static_cast<uint>(lv2_wrapper->get_control_port_value(out_latency_port));
 
   if (latency_n_frames != lv) {
     latency_n_frames = lv;
@@ -155,37 +163,24 @@ void Expander::process(std::span<float>& left_in,
 
     util::debug(log_tag + name + " latency: " + util::to_string(latency_value, "") + " s");
 
-    util::idle_add([=, this]() {
-      if (!post_messages || latency.empty()) {
-        return;
-      }
-
-      latency.emit();
-    });
+    notify_latency_change();
 
     update_filter_params();
   }
 
   if (post_messages) {
-    get_peaks(left_in, right_in, left_out, right_out);
-
     if (send_notifications) {
       reduction_port_value =
-          0.5F * (lv2_wrapper->get_control_port_value("rlm_l") + lv2_wrapper->get_control_port_value("rlm_r"));
+          0.5F * (lv2_wrapper->get_control_port_value(rlm_l_port) + lv2_wrapper->get_control_port_value(rlm_r_port));
 
       sidechain_port_value =
-          0.5F * (lv2_wrapper->get_control_port_value("slm_l") + lv2_wrapper->get_control_port_value("slm_r"));
+          0.5F * (lv2_wrapper->get_control_port_value(slm_l_port) + lv2_wrapper->get_control_port_value(slm_r_port));
 
       curve_port_value =
-          0.5F * (lv2_wrapper->get_control_port_value("clm_l") + lv2_wrapper->get_control_port_value("clm_r"));
+          0.5F * (lv2_wrapper->get_control_port_value(clm_l_port) + lv2_wrapper->get_control_port_value(clm_r_port));
 
       envelope_port_value =
-          0.5F * (lv2_wrapper->get_control_port_value("elm_l") + lv2_wrapper->get_control_port_value("elm_r"));
-
-      reduction.emit(reduction_port_value);
-      sidechain.emit(sidechain_port_value);
-      curve.emit(curve_port_value);
-      envelope.emit(envelope_port_value);
+          0.5F * (lv2_wrapper->get_control_port_value(elm_l_port) + lv2_wrapper->get_control_port_value(elm_r_port));
 
       notify();
     }
@@ -229,3 +224,17 @@ void Expander::update_probe_links() {
 auto Expander::get_latency_seconds() -> float {
   return this->latency_value;
 }
+
+void Expander::pack_meters(std::span<double> values) {
+  values[0] = reduction_port_value;
+  values[1] = sidechain_port_value;
+  values[2] = curve_port_value;
+  values[3] = envelope_port_value;
+}
+
+void Expander::emit_meters(std::span<const double> values) {
+  reduction.emit(static_cast<float>(values[0]));
+  sidechain.emit(static_cast<float>(values[1]));
+  curve.emit(static_cast<float>(values[2]));
+  envelope.emit(static_cast<float>(values[3]));
+}
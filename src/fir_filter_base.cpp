@@ -208,3 +208,7 @@ void FirFilterBase::direct_conv(const std::vector<float>& a, const std::vector<f
 auto FirFilterBase::get_delay() const -> float {
   return delay;
 }
+
+auto FirFilterBase::get_kernel_size() const -> size_t {
+  return kernel.size();
+}
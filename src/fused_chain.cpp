@@ -0,0 +1,177 @@
+/*
+ *  Copyright © 2017-2023 Wellington Wallace
+ *
+ *  This file is part of Easy Effects.
+ *
+ *  Easy Effects is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Easy Effects is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Easy Effects. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "fused_chain.hpp"
+
+FusedChain::FusedChain(const std::string& tag,
+                       const std::string& schema,
+                       const std::string& schema_path,
+                       PipeManager* pipe_manager)
+    : PluginBase(tag, "fused_chain", tags::plugin_package::ee, schema, schema_path, pipe_manager) {
+  /*
+    The scratch buffers are allocated for the default maximum quantum of PipeWire so that nothing has to be allocated
+    in the realtime thread when the quantum changes. setup() only grows them for larger quanta.
+  */
+
+  scratch_a_L.resize(default_max_quantum);
+  scratch_a_R.resize(default_max_quantum);
+  scratch_b_L.resize(default_max_quantum);
+  scratch_b_R.resize(default_max_quantum);
+}
+
+FusedChain::~FusedChain() {
+  if (connected_to_pw) {
+    disconnect_from_pw();
+  }
+
+  util::debug(log_tag + name + " destroyed");
+}
+
+void FusedChain::setup() {
+  // a force-quantum setting or a larger PipeWire max quantum can give us more samples than the default maximum
+
+  if (n_samples > scratch_a_L.size()) {
+    util::debug(log_tag + name + ": growing the scratch buffers to " + util::to_string(n_samples) + " samples");
+
+    scratch_a_L.resize(n_samples);
+    scratch_a_R.resize(n_samples);
+    scratch_b_L.resize(n_samples);
+    scratch_b_R.resize(n_samples);
+  }
+}
+
+void FusedChain::process(std::span<float>& left_in,
+                         std::span<float>& right_in,
+                         std::span<float>& left_out,
+                         std::span<float>& right_out) {
+  /*
+    set_plugins() holds the lock only while it swaps the list. We do not wait for it in the realtime thread. The audio
+    just goes through untouched for the quantum that happens at the same time.
+  */
+
+  std::unique_lock<std::mutex> lock(data_mutex, std::try_to_lock);
+
+  if (!lock.owns_lock() || plugins.empty()) {
+    passthrough(left_in, right_in, left_out, right_out);
+
+    return;
+  }
+
+  /*
+    The first plugin reads from our input ports and the last one writes to our output ports. In between the plugins
+    ping-pong between two pairs of scratch buffers. Bypassed plugins are skipped instead of copying their input to
+    their output and plugins that can process in place write over their input when it is one of our scratch buffers.
+  */
+
+  std::span<float> a_L(scratch_a_L.data(), n_samples);
+  std::span<float> a_R(scratch_a_R.data(), n_samples);
+  std::span<float> b_L(scratch_b_L.data(), n_samples);
+  std::span<float> b_R(scratch_b_R.data(), n_samples);
+
+  std::span<float> src_L = left_in;
+  std::span<float> src_R = right_in;
+
+  auto last_active = plugins.size();
+
+  for (size_t n = plugins.size(); n > 0U; n--) {
+    if (!plugins[n - 1U]->bypass) {
+      last_active = n - 1U;
+
+      break;
+    }
+  }
+
+  float total_latency = 0.0F;
+
+  for (size_t n = 0U; n < plugins.size(); n++) {
+    auto& plugin = plugins[n];
+
+    plugin->begin_quantum(n_samples, rate, clock_position);
+
+    if (n > last_active || last_active == plugins.size() || (n != last_active && plugin->bypass)) {
+      plugin->end_quantum();
+
+      continue;
+    }
+
+    std::span<float> dst_L = (src_L.data() == a_L.data()) ? b_L : a_L;
+    std::span<float> dst_R = (src_R.data() == a_R.data()) ? b_R : a_R;
+
+    if (n == last_active) {
+      dst_L = left_out;
+      dst_R = right_out;
+    } else if (plugin->can_process_in_place() && src_L.data() != left_in.data()) {
+      dst_L = src_L;
+      dst_R = src_R;
+    }
+
+    plugin->probe_latency(src_L, src_R, false);
+
+    const auto process_start = std::chrono::steady_clock::now();
+
+    if (!plugin->skip_silent_quantum(src_L, src_R, dst_L, dst_R)) {
+      plugin->process(src_L, src_R, dst_L, dst_R);
+    }
+
+    plugin->record_dsp_load(std::chrono::steady_clock::now() - process_start);
+
+    plugin->probe_latency(dst_L, dst_R, true);
+
+    plugin->end_quantum();
+
+    total_latency += plugin->latency_value;
+
+    src_L = dst_L;
+    src_R = dst_R;
+  }
+
+  if (last_active == plugins.size()) {
+    passthrough(left_in, right_in, left_out, right_out);
+  }
+
+  if (total_latency != latency_value) {
+    latency_value = total_latency;
+
+    update_filter_params();
+  }
+}
+
+auto FusedChain::get_latency_seconds() -> float {
+  return 0.0F;  // the latency of each fused plugin is already accounted by EffectsBase
+}
+
+void FusedChain::set_plugins(const std::vector<std::shared_ptr<PluginBase>>& list) {
+  // the copy and the destruction of the old list are done without holding the lock the realtime thread tries
+
+  auto new_plugins = list;
+
+  {
+    std::scoped_lock<std::mutex> lock(data_mutex);
+
+    plugins.swap(new_plugins);
+  }
+}
+
+auto FusedChain::get_plugins() const -> const std::vector<std::shared_ptr<PluginBase>>& {
+  return plugins;
+}
+
+auto FusedChain::can_be_fused(const std::shared_ptr<PluginBase>& plugin) -> bool {
+  return !plugin->enable_probe;
+}
@@ -29,6 +29,20 @@ Gate::Gate(const std::string& tag, const std::string& schema, const std::string&
     util::debug(log_tag + "http://lsp-plug.in/plugins/lv2/sc_gate_stereo is not installed");
   }
 
+  out_latency_port = lv2_wrapper->get_control_port_index("out_latency");
+  gzs_port = lv2_wrapper->get_control_port_index("gzs");
+  gt_port = lv2_wrapper->get_control_port_index("gt");
+  hts_port = lv2_wrapper->get_control_port_index("hts");
+  hzs_port = lv2_wrapper->get_control_port_index("hzs");
+  rlm_l_port = lv2_wrapper->get_control_port_index("rlm_l");
+  rlm_r_port = lv2_wrapper->get_control_port_index("rlm_r");
+  slm_l_port = lv2_wrapper->get_control_port_index("slm_l");
+  slm_r_port = lv2_wrapper->get_control_port_index("slm_r");
+  clm_l_port = lv2_wrapper->get_control_port_index("clm_l");
+  clm_r_port = lv2_wrapper->get_control_port_index("clm_r");
+  elm_l_port = lv2_wrapper->get_control_port_index("elm_l");
+  elm_r_port = lv2_wrapper->get_control_port_index("elm_r");
+
   gconnections.push_back(g_signal_connect(settings, "changed::sidechain-input",
                                           G_CALLBACK(+[](GSettings* settings, char* key, gpointer user_data) {
                                             auto* self = static_cast<Gate*>(user_data);
@@ -98,6 +112,8 @@ Gate::Gate(const std::string& tag, const std::string& schema, const std::string&
 }
 
 Gate::~Gate() {
+  stop_notifications();
+
   if (connected_to_pw) {
     disconnect_from_pw();
   }
@@ -130,22 +146,18 @@ void Gate::process(std::span<float>& left_in,
     return;
   }
 
-  if (input_gain != 1.0F) {
-    apply_gain(left_in, right_in, input_gain);
-  }
+  apply_input_gain(left_in, right_in);
 
   lv2_wrapper->connect_data_ports(left_in, right_in, left_out, right_out, probe_left, probe_right);
   lv2_wrapper->run();
 
-  if (output_gain != 1.0F) {
-    apply_gain(left_out, right_out, output_gain);
-  }
+  apply_output_gain(left_out, right_out);
 
   /*
    This plugin gives the latency in number of samples
  */
 
-  const auto lv = static_cast<uint>(lv2_wrapper->get_control_port_value("out_latency"));
+  const auto lv = static_cast<uint>(lv2_wrapper->get_control_port_value(out_latency_port));
 
   if (latency_n_frames != lv) {
     latency_n_frames = lv;
@@ -154,46 +166,29 @@ void Gate::process(std::span<float>& left_in,
 
     util::debug(log_tag + name + " latency: " + util::to_string(latency_value, "") + " s");
 
-    util::idle_add([=, this]() {
-      if (!post_messages || latency.empty()) {
-        return;
-      }
-
-      latency.emit();
-    });
+    notify_latency_change();
 
     update_filter_params();
   }
 
   if (post_messages) {
-    get_peaks(left_in, right_in, left_out, right_out);
-
     if (send_notifications) {
-      attack_zone_start_port_value = lv2_wrapper->get_control_port_value("gzs");
-      attack_threshold_port_value = lv2_wrapper->get_control_port_value("gt");
-      release_zone_start_port_value = lv2_wrapper->get_control_port_value("hts");
-      release_threshold_port_value = lv2_wrapper->get_control_port_value("hzs");
+      attack_zone_start_port_value = lv2_wrapper->get_control_port_value(gzs_port);
+      attack_threshold_port_value = lv2_wrapper->get_control_port_value(gt_port);
+      release_zone_start_port_value = lv2_wrapper->get_control_port_value(hts_port);
+      release_threshold_port_value = lv2_wrapper->get_control_port_value(hzs_port);
 
       reduction_port_value =
-          0.5F * (lv2_wrapper->get_control_port_value("rlm_l") + lv2_wrapper->get_control_port_value("rlm_r"));
+          0.5F * (lv2_wrapper->get_control_port_value(rlm_l_port) + lv2_wrapper->get_control_port_value(rlm_r_port));
 
       sidechain_port_value =
-          0.5F * (lv2_wrapper->get_control_port_value("slm_l") + lv2_wrapper->get_control_port_value("slm_r"));
+          0.5F * (lv2_wrapper->get_control_port_value(slm_l_port) + lv2_wrapper->get_control_port_value(slm_r_port));
 
       curve_port_value =
-          0.5F * (lv2_wrapper->get_control_port_value("clm_l") + lv2_wrapper->get_control_port_value("clm_r"));
+          0.5F * (lv2_wrapper->get_control_port_value(clm_l_port) + lv2_wrapper->get_control_port_value(clm_r_port));
 
       envelope_port_value =
-          0.5F * (lv2_wrapper->get_control_port_value("elm_l") + lv2_wrapper->get_control_port_value("elm_r"));
-
-      attack_zone_start.emit(attack_zone_start_port_value);
-      attack_threshold.emit(attack_threshold_port_value);
-      release_zone_start.emit(release_zone_start_port_value);
-      release_threshold.emit(release_threshold_port_value);
-      reduction.emit(reduction_port_value);
-      sidechain.emit(sidechain_port_value);
-      curve.emit(curve_port_value);
-      envelope.emit(envelope_port_value);
+          0.5F * (lv2_wrapper->get_control_port_value(elm_l_port) + lv2_wrapper->get_control_port_value(elm_r_port));
 
       notify();
     }
@@ -237,3 +232,25 @@ void Gate::update_probe_links() {
 auto Gate::get_latency_seconds() -> float {
   return this->latency_value;
 }
+
+void Gate::pack_meters(std::span<double> values) {
+  values[0] = attack_zone_start_port_value;
+  values[1] = attack_threshold_port_value;
+  values[2] = release_zone_start_port_value;
+  values[3] = release_threshold_port_value;
+  values[4] = reduction_port_value;
+  values[5] = sidechain_port_value;
+  values[6] = curve_port_value;
+  values[7] = envelope_port_value;
+}
+
+void Gate::emit_meters(std::span<const double> values) {
+  attack_zone_start.emit(static_cast<float>(values[0]));
+  attack_threshold.emit(static_cast<float>(values[1]));
+  release_zone_start.emit(static_cast<float>(values[2]));
+  release_threshold.emit(static_cast<float>(values[3]));
+  reduction.emit(static_cast<float>(values[4]));
+  sidechain.emit(static_cast<float>(values[5]));
+  curve.emit(static_cast<float>(values[6]));
+  envelope.emit(static_cast<float>(values[7]));
+}
@@ -0,0 +1,369 @@
+/*
+ *  Copyright © 2017-2023 Wellington Wallace
+ *
+ *  This file is part of Easy Effects.
+ *
+ *  Easy Effects is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Easy Effects is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Easy Effects. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "ir_cache.hpp"
+#include <sndfile.hh>
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include "dsp_kernels.hpp"
+#include "resampler.hpp"
+#include "util.hpp"
+
+namespace {
+
+// the version has to change when the file layout or the way the kernels are resampled changes
+
+constexpr std::array<char, 8> magic = {'E', 'E', 'I', 'R', 'C', '0', '0', '1'};
+
+struct Header {
+  std::array<char, 8> magic;
+
+  uint32_t rate;
+
+  uint32_t n_channels;
+
+  uint64_t n_frames;
+};
+
+std::mutex registry_mutex;
+
+std::map<std::string, std::weak_ptr<const ir_cache::Kernel>> registry;  // cache file -> kernel in use
+
+auto get_cache_dir() -> std::filesystem::path {
+  return std::filesystem::path{g_get_user_cache_dir()} / "easyeffects" / "irs";
+}
+
+/*
+  Entries are written for every response and rate combination that was ever used. Their modification time is updated
+  when they are used again. So the cache dir is pruned once per session: files older than max_entry_age are removed
+  and then the oldest entries until the total size is below max_cache_size. Temporary files left by a crash are also
+  removed. The recent ones are kept because another instance may be writing them.
+*/
+
+constexpr auto max_entry_age = std::chrono::days(30);
+
+constexpr auto max_tmp_age = std::chrono::hours(1);
+
+constexpr uintmax_t max_cache_size = 512U * 1024U * 1024U;
+
+bool cache_dir_pruned = false;
+
+void prune_cache_dir() {
+  std::error_code ec;
+
+  const auto now = std::filesystem::file_time_type::clock::now();
+
+  std::vector<std::pair<std::filesystem::file_time_type, std::filesystem::path>> entries;
+
+  uintmax_t total_size = 0U;
+
+  for (const auto& entry : std::filesystem::directory_iterator(get_cache_dir(), ec)) {
+    if (!entry.is_regular_file(ec)) {
+      continue;
+    }
+
+    const auto& path = entry.path();
+
+    const auto mtime = entry.last_write_time(ec);
+
+    if (ec) {
+      continue;
+    }
+
+    const auto is_tmp = path.filename().string().find(".irc.tmp") != std::string::npos;
+
+    if ((is_tmp && now - mtime > max_tmp_age) || (path.extension() == ".irc" && now - mtime > max_entry_age)) {
+      util::debug("removing the stale impulse response cache file: " + path.string());
+
+      std::filesystem::remove(path, ec);
+
+      continue;
+    }
+
+    if (path.extension() == ".irc") {
+      total_size += entry.file_size(ec);
+
+      entries.emplace_back(mtime, path);
+    }
+  }
+
+  std::ranges::sort(entries);
+
+  for (const auto& [mtime, path] : entries) {
+    if (total_size <= max_cache_size) {
+      break;
+    }
+
+    const auto size = std::filesystem::file_size(path, ec);
+
+    if (!ec && std::filesystem::remove(path, ec)) {
+      util::debug("removing the least recently used impulse response cache file: " + path.string());
+
+      total_size -= size;
+    }
+  }
+}
+
+auto hash_file(const std::string& path) -> std::string {
+  GError* error = nullptr;
+
+  auto* file = g_mapped_file_new(path.c_str(), 0, &error);
+
+  if (file == nullptr) {
+    g_error_free(error);
+
+    return "";
+  }
+
+  auto* digest = g_compute_checksum_for_data(G_CHECKSUM_SHA256,
+                                             reinterpret_cast<const guchar*>(g_mapped_file_get_contents(file)),
+                                             g_mapped_file_get_length(file));
+
+  std::string hash = (digest != nullptr) ? digest : "";
+
+  g_free(digest);
+
+  g_mapped_file_unref(file);
+
+  return hash;
+}
+
+auto map_cache_file(const std::filesystem::path& path, const uint& rate) -> std::shared_ptr<const ir_cache::Kernel> {
+  auto* file = g_mapped_file_new(path.c_str(), 0, nullptr);
+
+  if (file == nullptr) {
+    return nullptr;
+  }
+
+  Header header{};
+
+  const auto length = g_mapped_file_get_length(file);
+
+  if (length >= sizeof(Header)) {
+    std::memcpy(&header, g_mapped_file_get_contents(file), sizeof(Header));
+  }
+
+  if (length < sizeof(Header) || header.magic != magic || header.rate != rate || header.n_channels != 2U ||
+      length != sizeof(Header) + 2U * header.n_frames * sizeof(float)) {
+    util::warning("ignoring the invalid impulse response cache file: " + path.string());
+
+    g_mapped_file_unref(file);
+
+    return nullptr;
+  }
+
+  return std::make_shared<const ir_cache::Kernel>(file, header.n_frames);
+}
+
+// writes a new file and renames it. Readers never see a partial entry
+
+auto write_cache_file(const std::filesystem::path& path, const uint& rate, const std::vector<float>& samples) -> bool {
+  std::error_code ec;
+
+  std::filesystem::create_directories(path.parent_path(), ec);
+
+  const auto thread_hash = std::hash<std::thread::id>{}(std::this_thread::get_id());
+
+  const auto tmp_path = path.string() + ".tmp" + util::to_string(thread_hash);
+
+  Header header{magic, rate, 2U, samples.size() / 2U};
+
+  std::ofstream file(tmp_path, std::ios::binary);
+
+  file.write(reinterpret_cast<const char*>(&header), sizeof(Header));
+  file.write(reinterpret_cast<const char*>(samples.data()),
+             static_cast<std::streamsize>(samples.size() * sizeof(float)));
+
+  file.close();
+
+  if (!file) {
+    std::filesystem::remove(tmp_path, ec);
+
+    return false;
+  }
+
+  std::filesystem::rename(tmp_path, path, ec);
+
+  return !ec;
+}
+
+// the left channel samples followed by the right ones
+
+auto decode(const std::string& path, const uint& rate, const std::string& log_tag) -> std::vector<float> {
+  // SndfileHandle might have issues with std::string, so we provide cstring
+
+  SndfileHandle file = SndfileHandle(path.c_str());
+
+  if (file.channels() == 0 || file.frames() == 0) {
+    util::warning(log_tag + ": irs file does not exists or it is empty: " + path);
+
+    return {};
+  }
+
+  util::debug(log_tag + ": irs file: " + path);
+  util::debug(log_tag + ": irs rate: " + util::to_string(file.samplerate()) + " Hz");
+  util::debug(log_tag + ": irs channels: " + util::to_string(file.channels()));
+  util::debug(log_tag + ": irs frames: " + util::to_string(file.frames()));
+
+  // for now only stereo irs files are supported
+
+  if (file.channels() != 2) {
+    util::warning(log_tag + " Only stereo impulse responses are supported.");
+    util::warning(log_tag + " The impulse file was not loaded!");
+
+    return {};
+  }
+
+  std::vector<float> buffer(file.frames() * file.channels());
+  std::vector<float> buffer_L(file.frames());
+  std::vector<float> buffer_R(file.frames());
+
+  file.readf(buffer.data(), file.frames());
+
+  dsp::deinterleave(buffer, buffer_L, buffer_R);
+
+  if (file.samplerate() != static_cast<int>(rate)) {
+    util::debug(log_tag + " resampling the kernel to " + util::to_string(rate));
+
+    auto resampler = std::make_unique<Resampler>(file.samplerate(), rate);
+
+    buffer_L = resampler->process(buffer_L, true);
+
+    resampler = std::make_unique<Resampler>(file.samplerate(), rate);
+
+    buffer_R = resampler->process(buffer_R, true);
+  }
+
+  const auto n_frames = std::min(buffer_L.size(), buffer_R.size());
+
+  std::vector<float> samples(2U * n_frames);
+
+  std::copy(buffer_L.begin(), buffer_L.begin() + n_frames, samples.begin());
+  std::copy(buffer_R.begin(), buffer_R.begin() + n_frames, samples.begin() + n_frames);
+
+  return samples;
+}
+
+}  // namespace
+
+namespace ir_cache {
+
+Kernel::Kernel(GMappedFile* mapped_file, const size_t& frames)
+    : file(mapped_file),
+      n_frames(frames),
+      data(reinterpret_cast<const float*>(g_mapped_file_get_contents(mapped_file) + sizeof(Header)), 2U * frames) {}
+
+Kernel::Kernel(std::vector<float> samples, const size_t& frames)
+    : memory(std::move(samples)), n_frames(frames), data(memory) {}
+
+Kernel::~Kernel() {
+  if (file != nullptr) {
+    g_mapped_file_unref(file);
+  }
+}
+
+auto Kernel::left() const -> std::span<const float> {
+  return data.first(n_frames);
+}
+
+auto Kernel::right() const -> std::span<const float> {
+  return data.subspan(n_frames, n_frames);
+}
+
+auto Kernel::size() const -> size_t {
+  return n_frames;
+}
+
+auto load(const std::string& path, const uint& rate, const std::string& log_tag) -> std::shared_ptr<const Kernel> {
+  if (path.empty()) {
+    util::warning(log_tag + ": irs file path is null.");
+
+    return nullptr;
+  }
+
+  const auto hash = hash_file(path);
+
+  if (hash.empty()) {
+    util::warning(log_tag + ": could not read the irs file: " + path);
+
+    return nullptr;
+  }
+
+  const auto cache_path = get_cache_dir() / (hash + "-" + util::to_string(rate) + ".irc");
+
+  std::scoped_lock<std::mutex> lock(registry_mutex);
+
+  if (!cache_dir_pruned) {
+    cache_dir_pruned = true;
+
+    prune_cache_dir();
+  }
+
+  std::erase_if(registry, [](const auto& entry) { return entry.second.expired(); });
+
+  if (auto kernel = registry[cache_path.string()].lock(); kernel != nullptr) {
+    util::debug(log_tag + ": sharing the kernel already in use: " + cache_path.string());
+
+    return kernel;
+  }
+
+  auto kernel = map_cache_file(cache_path, rate);
+
+  if (kernel != nullptr) {
+    util::debug(log_tag + ": kernel loaded from the cache: " + cache_path.string());
+
+    // the modification time tells prune_cache_dir() when the entry was last used
+
+    std::error_code ec;
+
+    std::filesystem::last_write_time(cache_path, std::filesystem::file_time_type::clock::now(), ec);
+  } else {
+    auto samples = decode(path, rate, log_tag);
+
+    if (samples.empty()) {
+      return nullptr;
+    }
+
+    if (write_cache_file(cache_path, rate, samples)) {
+      kernel = map_cache_file(cache_path, rate);
+    } else {
+      util::warning(log_tag + ": could not write the impulse response cache file: " + cache_path.string());
+    }
+
+    if (kernel == nullptr) {
+      const auto n_frames = samples.size() / 2U;
+
+      kernel = std::make_shared<const Kernel>(std::move(samples), n_frames);
+    }
+  }
+
+  registry[cache_path.string()] = kernel;
+
+  return kernel;
+}
+
+}  // namespace ir_cache
@@ -31,6 +31,8 @@ LevelMeter::LevelMeter(const std::string& tag,
                  pipe_manager) {}
 
 LevelMeter::~LevelMeter() {
+  stop_notifications();
+
   if (connected_to_pw) {
     disconnect_from_pw();
   }
@@ -108,17 +110,13 @@ void LevelMeter::process(std::span<float>& left_in,
                          std::span<float>& right_out) {
   std::scoped_lock<std::mutex> lock(data_mutex);
 
-  std::copy(left_in.begin(), left_in.end(), left_out.begin());
-  std::copy(right_in.begin(), right_in.end(), right_out.begin());
+  passthrough(left_in, right_in, left_out, right_out);
 
   if (bypass || !ebur128_ready) {
     return;
   }
 
-  for (size_t n = 0U; n < n_samples; n++) {
-    data[2U * n] = left_in[n];
-    data[2U * n + 1U] = right_in[n];
-  }
+  dsp::interleave(left_in, right_in, data);
 
   ebur128_add_frames_float(ebur_state, data.data(), n_samples);
 
@@ -154,8 +152,6 @@ void LevelMeter::process(std::span<float>& left_in,
     get_peaks(left_in, right_in, left_out, right_out);
 
     if (send_notifications) {
-      results.emit(momentary, shortterm, global, relative, range, true_peak_L, true_peak_R);
-
       notify();
     }
   }
@@ -165,6 +161,10 @@ auto LevelMeter::get_latency_seconds() -> float {
   return 0.0F;
 }
 
+auto LevelMeter::can_process_in_place() const -> bool {
+  return true;
+}
+
 void LevelMeter::reset_history() {
   mythreads.emplace_back([this]() {  // Using emplace_back here makes sense
     data_mutex.lock();
@@ -182,3 +182,17 @@ void LevelMeter::reset_history() {
     data_mutex.unlock();
   });
 }
+
+void LevelMeter::pack_meters(std::span<double> values) {
+  values[0] = momentary;
+  values[1] = shortterm;
+  values[2] = global;
+  values[3] = relative;
+  values[4] = range;
+  values[5] = true_peak_L;
+  values[6] = true_peak_R;
+}
+
+void LevelMeter::emit_meters(std::span<const double> values) {
+  results.emit(values[0], values[1], values[2], values[3], values[4], values[5], values[6]);
+}
@@ -32,6 +32,12 @@ Limiter::Limiter(const std::string& tag,
     util::debug(log_tag + "http://lsp-plug.in/plugins/lv2/sc_limiter_stereo is not installed");
   }
 
+  out_latency_port = lv2_wrapper->get_control_port_index("out_latency");
+  grlm_l_port = lv2_wrapper->get_control_port_index("grlm_l");
+  grlm_r_port = lv2_wrapper->get_control_port_index("grlm_r");
+  sclm_l_port = lv2_wrapper->get_control_port_index("sclm_l");
+  sclm_r_port = lv2_wrapper->get_control_port_index("sclm_r");
+
   gconnections.push_back(g_signal_connect(settings, "changed::external-sidechain",
                                           G_CALLBACK(+[](GSettings* settings, char* key, gpointer user_data) {
                                             auto* self = static_cast<Limiter*>(user_data);
@@ -82,6 +88,8 @@ Limiter::Limiter(const std::string& tag,
 }
 
 Limiter::~Limiter() {
+  stop_notifications();
+
   if (connected_to_pw) {
     disconnect_from_pw();
   }
@@ -114,22 +122,18 @@ void Limiter::process(std::span<float>& left_in,
     return;
   }
 
-  if (input_gain != 1.0F) {
-    apply_gain(left_in, right_in, input_gain);
-  }
+  apply_input_gain(left_in, right_in);
 
   lv2_wrapper->connect_data_ports(left_in, right_in, left_out, right_out, probe_left, probe_right);
   lv2_wrapper->run();
 
-  if (output_gain != 1.0F) {
-    apply_gain(left_out, right_out, output_gain);
-  }
+  apply_output_gain(left_out, right_out);
 
   /*
    This plugin gives the latency in number of samples
  */
 
-  const auto lv = static_cast<uint>(lv2_wrapper->get_control_port_value("out_latency"));
+  const auto lv = static_cast<uint>(lv2_wrapper->get_control_port_value(out_latency_port));
 
   if (latency_n_frames != lv) {
     latency_n_frames = lv;
@@ -138,30 +142,17 @@ void Limiter::process(std::span<float>& left_in,
 
     util::debug(log_tag + name + " latency: " + util::to_string(latency_value, "") + " s");
 
-    util::idle_add([=, this]() {
-      if (!post_messages || latency.empty()) {
-        return;
-      }
-
-      latency.emit();
-    });
+    notify_latency_change();
 
     update_filter_params();
   }
 
   if (post_messages) {
-    get_peaks(left_in, right_in, left_out, right_out);
-
     if (send_notifications) {
-      gain_l_port_value = lv2_wrapper->get_control_port_value("grlm_l");
-      gain_r_port_value = lv2_wrapper->get_control_port_value("grlm_r");
-      sidechain_l_port_value = lv2_wrapper->get_control_port_value("sclm_l");
-      sidechain_r_port_value = lv2_wrapper->get_control_port_value("sclm_r");
-
-      gain_left.emit(gain_l_port_value);
-      gain_right.emit(gain_r_port_value);
-      sidechain_left.emit(sidechain_l_port_value);
-      sidechain_right.emit(sidechain_r_port_value);
+      gain_l_port_value = lv2_wrapper->get_control_port_value(grlm_l_port);
+      gain_r_port_value = lv2_wrapper->get_control_port_value(grlm_r_port);
+      sidechain_l_port_value = lv2_wrapper->get_control_port_value(sclm_l_port);
+      sidechain_r_port_value = lv2_wrapper->get_control_port_value(sclm_r_port);
 
       notify();
     }
@@ -205,3 +196,17 @@ void Limiter::update_probe_links() {
 auto Limiter::get_latency_seconds() -> float {
   return this->latency_value;
 }
+
+void Limiter::pack_meters(std::span<double> values) {
+  values[0] = gain_l_port_value;
+  values[1] = gain_r_port_value;
+  values[2] = sidechain_l_port_value;
+  values[3] = sidechain_r_port_value;
+}
+
+void Limiter::emit_meters(std::span<const double> values) {
+  gain_left.emit(static_cast<float>(values[0]));
+  gain_right.emit(static_cast<float>(values[1]));
+  sidechain_left.emit(static_cast<float>(values[2]));
+  sidechain_right.emit(static_cast<float>(values[3]));
+}
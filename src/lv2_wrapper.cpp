@@ -38,56 +38,231 @@ auto lv2_printf(LV2_Log_Handle handle, LV2_URID type, const char* format, ...) -
   return r;
 }
 
-Lv2Wrapper::Lv2Wrapper(const std::string& plugin_uri) : plugin_uri(plugin_uri), world(lilv_world_new()) {
+namespace {
+
+/*
+  Scanning all the LV2 bundles installed in the system is the slowest part of our startup and it used to be done by
+  every wrapper. Now the lilv world is shared and each plugin is described only once. We also remember on disk in which
+  bundle each plugin was found. In the next run only those bundles are loaded and lilv_world_load_all() is called only
+  when a plugin is not in the cache or its bundle is gone. Mixing the two loading methods in the same world is not
+  safe. So each one has its own world. The worlds live until the end of the process because the descriptors keep
+  pointers to their plugins.
+
+  A plugin bundle alone does not describe everything. The plugin classes, units and port properties are defined by the
+  specification bundles (lv2core, units, port-props and the extensions). Their bundles are remembered in the cache as
+  well and loaded into the bundles world before any plugin. A cache without them was written by an older version and
+  is ignored until the next full scan rewrites it.
+*/
+
+std::mutex cache_mutex;
+
+LilvWorld* bundles_world = nullptr;  // only the bundles listed in the disk cache
+
+LilvWorld* full_world = nullptr;  // everything lilv_world_load_all() finds
+
+std::set<std::string> loaded_bundles;
+
+std::set<std::string> spec_bundles;
+
+constexpr auto spec_bundle_key = "@spec";
+
+std::map<std::string, std::string> bundle_cache;  // plugin uri -> bundle uri
+
+bool bundle_cache_read = false;
+
+std::unordered_map<std::string, std::shared_ptr<const PluginDescriptor>> descriptors;
+
+auto get_bundle_cache_path() -> std::filesystem::path {
+  return std::filesystem::path{g_get_user_cache_dir()} / "easyeffects" / "lv2-bundles";
+}
+
+void read_bundle_cache() {
+  bundle_cache_read = true;
+
+  std::ifstream file(get_bundle_cache_path());
+
+  std::string plugin_uri;
+  std::string bundle_uri;
+
+  while (file >> plugin_uri >> bundle_uri) {
+    if (plugin_uri == spec_bundle_key) {
+      spec_bundles.insert(bundle_uri);
+    } else {
+      bundle_cache[plugin_uri] = bundle_uri;
+    }
+  }
+}
+
+void write_bundle_cache() {
+  const auto path = get_bundle_cache_path();
+
+  std::error_code ec;
+
+  std::filesystem::create_directories(path.parent_path(), ec);
+
+  std::ofstream file(path);
+
+  for (const auto& bundle_uri : spec_bundles) {
+    file << spec_bundle_key << " " << bundle_uri << "\n";
+  }
+
+  for (const auto& [plugin_uri, bundle_uri] : bundle_cache) {
+    file << plugin_uri << " " << bundle_uri << "\n";
+  }
+
+  if (!file) {
+    util::warning("could not write the lv2 bundles cache: " + path.string());
+  }
+}
+
+auto bundle_exists(const std::string& bundle_uri) -> bool {
+  char* bundle_path = lilv_file_uri_parse(bundle_uri.c_str(), nullptr);
+
+  const bool exists = bundle_path != nullptr && std::filesystem::is_directory(bundle_path);
+
+  lilv_free(bundle_path);
+
+  return exists;
+}
+
+// the bundles holding the data files of the specifications the world knows about. The bundle is their directory
+
+void find_spec_bundles(LilvWorld* world) {
+  auto* rdf_type = lilv_new_uri(world, LILV_NS_RDF "type");
+  auto* rdfs_see_also = lilv_new_uri(world, LILV_NS_RDFS "seeAlso");
+  auto* lv2_specification = lilv_new_uri(world, LV2_CORE__Specification);
+
+  auto* specs = lilv_world_find_nodes(world, nullptr, rdf_type, lv2_specification);
+
+  for (auto* i = lilv_nodes_begin(specs); !lilv_nodes_is_end(specs, i); i = lilv_nodes_next(specs, i)) {
+    auto* files = lilv_world_find_nodes(world, lilv_nodes_get(specs, i), rdfs_see_also, nullptr);
+
+    for (auto* j = lilv_nodes_begin(files); !lilv_nodes_is_end(files, j); j = lilv_nodes_next(files, j)) {
+      const std::string file_uri = lilv_node_as_uri(lilv_nodes_get(files, j));
+
+      if (const auto pos = file_uri.rfind('/'); pos != std::string::npos) {
+        spec_bundles.insert(file_uri.substr(0U, pos + 1U));
+      }
+    }
+
+    lilv_nodes_free(files);
+  }
+
+  lilv_nodes_free(specs);
+
+  lilv_node_free(lv2_specification);
+  lilv_node_free(rdfs_see_also);
+  lilv_node_free(rdf_type);
+
+  util::debug("found " + util::to_string(spec_bundles.size()) + " lv2 specification bundles");
+}
+
+void load_bundle(LilvWorld* world, const std::string& bundle_uri) {
+  auto* bundle = lilv_new_uri(world, bundle_uri.c_str());
+
+  lilv_world_load_bundle(world, bundle);
+
+  lilv_node_free(bundle);
+
+  loaded_bundles.insert(bundle_uri);
+}
+
+auto create_bundles_world() -> LilvWorld* {
+  auto* world = lilv_world_new();
+
   if (world == nullptr) {
-    util::warning("failed to initialized the world");
+    return nullptr;
+  }
 
-    return;
+  for (const auto& bundle_uri : spec_bundles) {
+    if (bundle_exists(bundle_uri)) {
+      load_bundle(world, bundle_uri);
+    }
   }
 
-  auto* const uri = lilv_new_uri(world, plugin_uri.c_str());
+  // lilv_world_load_all() does this at its end. With single bundles it is up to us
+
+  lilv_world_load_specifications(world);
+  lilv_world_load_plugin_classes(world);
+
+  return world;
+}
+
+auto find_plugin(LilvWorld* world, const std::string& plugin_uri) -> const LilvPlugin* {
+  auto* uri = lilv_new_uri(world, plugin_uri.c_str());
 
   if (uri == nullptr) {
     util::warning("Invalid plugin URI: " + plugin_uri);
 
-    return;
+    return nullptr;
   }
 
-  lilv_world_load_all(world);
+  const auto* plugin = lilv_plugins_get_by_uri(lilv_world_get_all_plugins(world), uri);
 
-  const LilvPlugins* plugins = lilv_world_get_all_plugins(world);
+  lilv_node_free(uri);
 
-  plugin = lilv_plugins_get_by_uri(plugins, uri);
+  return plugin;
+}
 
-  lilv_node_free(uri);
+auto find_plugin_in_cached_bundle(const std::string& plugin_uri) -> const LilvPlugin* {
+  if (!bundle_cache_read) {
+    read_bundle_cache();
+  }
 
-  if (plugin == nullptr) {
-    util::warning("Could not find the plugin: " + plugin_uri);
+  const auto it = bundle_cache.find(plugin_uri);
 
-    return;
+  if (it == bundle_cache.end() || spec_bundles.empty()) {
+    return nullptr;
   }
 
-  found_plugin = true;
+  const auto& bundle_uri = it->second;
+
+  if (!loaded_bundles.contains(bundle_uri)) {
+    if (!bundle_exists(bundle_uri)) {
+      return nullptr;
+    }
+
+    if (bundles_world == nullptr) {
+      bundles_world = create_bundles_world();
 
-  check_required_features();
+      if (bundles_world == nullptr) {
+        return nullptr;
+      }
+    }
+
+    load_bundle(bundles_world, bundle_uri);
+  }
 
-  create_ports();
+  return find_plugin(bundles_world, plugin_uri);
 }
 
-Lv2Wrapper::~Lv2Wrapper() {
-  if (instance != nullptr) {
-    lilv_instance_deactivate(instance);
-    lilv_instance_free(instance);
+auto find_plugin_in_full_world(const std::string& plugin_uri) -> const LilvPlugin* {
+  if (full_world == nullptr) {
+    full_world = lilv_world_new();
 
-    instance = nullptr;
+    if (full_world == nullptr) {
+      util::warning("failed to initialized the world");
+
+      return nullptr;
+    }
+
+    lilv_world_load_all(full_world);
+
+    find_spec_bundles(full_world);
   }
 
-  if (world != nullptr) {
-    lilv_world_free(world);
+  const auto* plugin = find_plugin(full_world, plugin_uri);
+
+  if (plugin != nullptr) {
+    bundle_cache[plugin_uri] = lilv_node_as_uri(lilv_plugin_get_bundle_uri(plugin));
+
+    write_bundle_cache();
   }
+
+  return plugin;
 }
 
-void Lv2Wrapper::check_required_features() {
+void check_required_features(const std::string& plugin_uri, const LilvPlugin* plugin) {
   LilvNodes* required_features = lilv_plugin_get_required_features(plugin);
 
   if (required_features != nullptr) {
@@ -104,10 +279,13 @@ void Lv2Wrapper::check_required_features() {
   }
 }
 
-void Lv2Wrapper::create_ports() {
-  n_ports = lilv_plugin_get_num_ports(plugin);
+void create_ports(PluginDescriptor& d) {
+  auto* world = d.world;
+  const auto* plugin = d.plugin;
 
-  ports.resize(n_ports);
+  const uint n_ports = lilv_plugin_get_num_ports(plugin);
+
+  d.ports.resize(n_ports);
 
   // Get min, max and default values for all ports
 
@@ -123,9 +301,12 @@ void Lv2Wrapper::create_ports() {
   LilvNode* lv2_ControlPort = lilv_new_uri(world, LV2_CORE__ControlPort);
   LilvNode* lv2_AtomPort = lilv_new_uri(world, LV2_ATOM__AtomPort);
   LilvNode* lv2_connectionOptional = lilv_new_uri(world, LV2_CORE__connectionOptional);
+  LilvNode* lv2_integer = lilv_new_uri(world, LV2_CORE__integer);
+  LilvNode* lv2_toggled = lilv_new_uri(world, LV2_CORE__toggled);
+  LilvNode* lv2_enumeration = lilv_new_uri(world, LV2_CORE__enumeration);
 
   for (uint n = 0U; n < n_ports; n++) {
-    auto* port = &ports[n];
+    auto* port = &d.ports[n];
 
     const auto* lilv_port = lilv_plugin_get_port_by_index(plugin, n);
 
@@ -159,6 +340,12 @@ void Lv2Wrapper::create_ports() {
 
     if (lilv_port_is_a(plugin, lilv_port, lv2_ControlPort)) {
       port->type = TYPE_CONTROL;
+
+      port->smooth = port->is_input && !lilv_port_has_property(plugin, lilv_port, lv2_integer) &&
+                     !lilv_port_has_property(plugin, lilv_port, lv2_toggled) &&
+                     !lilv_port_has_property(plugin, lilv_port, lv2_enumeration);
+
+      d.control_port_indices[port->symbol] = n;
     } else if (lilv_port_is_a(plugin, lilv_port, lv2_AtomPort)) {
       port->type = TYPE_ATOM;
 
@@ -166,8 +353,8 @@ void Lv2Wrapper::create_ports() {
     } else if (lilv_port_is_a(plugin, lilv_port, lv2_AudioPort)) {
       port->type = TYPE_AUDIO;
 
-      n_audio_in = (port->is_input) ? n_audio_in + 1 : n_audio_in;
-      n_audio_out = (!port->is_input) ? n_audio_out + 1 : n_audio_out;
+      d.n_audio_in = (port->is_input) ? d.n_audio_in + 1 : d.n_audio_in;
+      d.n_audio_out = (!port->is_input) ? d.n_audio_out + 1 : d.n_audio_out;
     } else if (!port->optional) {
       util::warning("Port " + port->name + " has un unsupported type!");
     }
@@ -175,9 +362,12 @@ void Lv2Wrapper::create_ports() {
     lilv_node_free(port_name);
   }
 
-  // util::warning("n audio_in ports: " + util::to_string(n_audio_in));
-  // util::warning("n audio_out ports: " + util::to_string(n_audio_out));
+  // util::warning("n audio_in ports: " + util::to_string(d.n_audio_in));
+  // util::warning("n audio_out ports: " + util::to_string(d.n_audio_out));
 
+  lilv_node_free(lv2_enumeration);
+  lilv_node_free(lv2_toggled);
+  lilv_node_free(lv2_integer);
   lilv_node_free(lv2_connectionOptional);
   lilv_node_free(lv2_ControlPort);
   lilv_node_free(lv2_AtomPort);
@@ -186,6 +376,125 @@ void Lv2Wrapper::create_ports() {
   lilv_node_free(lv2_InputPort);
 }
 
+
+auto get_plugin_descriptor(const std::string& plugin_uri) -> std::shared_ptr<const PluginDescriptor> {
+  std::scoped_lock<std::mutex> lock(cache_mutex);
+
+  if (const auto it = descriptors.find(plugin_uri); it != descriptors.end()) {
+    return it->second;
+  }
+
+  auto d = std::make_shared<PluginDescriptor>();
+
+  d->plugin = find_plugin_in_cached_bundle(plugin_uri);
+  d->world = bundles_world;
+
+  if (d->plugin == nullptr) {
+    d->plugin = find_plugin_in_full_world(plugin_uri);
+    d->world = full_world;
+  }
+
+  if (d->plugin == nullptr) {
+    return nullptr;
+  }
+
+  check_required_features(plugin_uri, d->plugin);
+
+  LilvNode* lv2_inPlaceBroken = lilv_new_uri(d->world, LV2_CORE__inPlaceBroken);
+
+  d->in_place_broken = lilv_plugin_has_feature(d->plugin, lv2_inPlaceBroken);
+
+  lilv_node_free(lv2_inPlaceBroken);
+
+  create_ports(*d);
+
+  descriptors[plugin_uri] = d;
+
+  return d;
+}
+
+struct UiCandidate {
+  std::string uri;
+
+  std::string binary_path;
+
+  std::string bundle_path;
+};
+
+// the ui thread must not query the shared world. So what it needs is read here with the cache lock held
+
+auto list_plugin_uis(const LilvPlugin* plugin) -> std::vector<UiCandidate> {
+  std::scoped_lock<std::mutex> lock(cache_mutex);
+
+  std::vector<UiCandidate> list;
+
+  LilvUIs* uis = lilv_plugin_get_uis(plugin);
+
+  if (uis == nullptr) {
+    return list;
+  }
+
+  LILV_FOREACH(uis, u, uis) {
+    const LilvUI* ui = lilv_uis_get(uis, u);
+
+    auto* binary_path = lilv_file_uri_parse(lilv_node_as_uri(lilv_ui_get_binary_uri(ui)), nullptr);
+    auto* bundle_path = lilv_file_uri_parse(lilv_node_as_uri(lilv_ui_get_bundle_uri(ui)), nullptr);
+
+    if (binary_path != nullptr && bundle_path != nullptr) {
+      list.push_back(
+          {.uri = lilv_node_as_uri(lilv_ui_get_uri(ui)), .binary_path = binary_path, .bundle_path = bundle_path});
+    }
+
+    lilv_free(binary_path);
+    lilv_free(bundle_path);
+  }
+
+  lilv_uis_free(uis);
+
+  return list;
+}
+
+}  // namespace
+
+Lv2Wrapper::Lv2Wrapper(const std::string& plugin_uri)
+    : plugin_uri(plugin_uri), descriptor(get_plugin_descriptor(plugin_uri)) {
+  if (descriptor == nullptr) {
+    util::warning("Could not find the plugin: " + plugin_uri);
+
+    return;
+  }
+
+  world = descriptor->world;
+  plugin = descriptor->plugin;
+
+  // each instance needs its own copy of the ports because their values are connected to the plugin instance
+
+  ports = descriptor->ports;
+
+  n_ports = ports.size();
+
+  control_targets.resize(n_ports);
+
+  for (const auto& p : ports) {
+    control_targets[p.index] = p.value;
+  }
+
+  control_ramps.reserve(n_ports);
+
+  control_events = std::make_unique<NotificationRing<ControlEvent>>(std::max(256U, 2U * n_ports));
+
+  found_plugin = true;
+}
+
+Lv2Wrapper::~Lv2Wrapper() {
+  if (instance != nullptr) {
+    lilv_instance_deactivate(instance);
+    lilv_instance_free(instance);
+
+    instance = nullptr;
+  }
+}
+
 auto Lv2Wrapper::create_instance(const uint& rate) -> bool {
   this->rate = rate;
 
@@ -244,6 +553,8 @@ auto Lv2Wrapper::create_instance(const uint& rate) -> bool {
 
   connect_control_ports();
 
+  smooth_controls = false;  // the values set before the first block are not interpolated
+
   activate();
 
   return true;
@@ -265,6 +576,8 @@ void Lv2Wrapper::connect_data_ports(std::span<float>& left_in,
     return;
   }
 
+  n_audio_connections = 0U;
+
   int count_input = 0;
   int count_output = 0;
 
@@ -272,17 +585,17 @@ void Lv2Wrapper::connect_data_ports(std::span<float>& left_in,
     if (p.type == PortType::TYPE_AUDIO) {
       if (p.is_input) {
         if (count_input == 0) {
-          lilv_instance_connect_port(instance, p.index, left_in.data());
+          connect_audio_port(p.index, left_in.data());
         } else if (count_input == 1) {
-          lilv_instance_connect_port(instance, p.index, right_in.data());
+          connect_audio_port(p.index, right_in.data());
         }
 
         count_input++;
       } else {
         if (count_output == 0) {
-          lilv_instance_connect_port(instance, p.index, left_out.data());
+          connect_audio_port(p.index, left_out.data());
         } else if (count_output == 1) {
-          lilv_instance_connect_port(instance, p.index, right_out.data());
+          connect_audio_port(p.index, right_out.data());
         }
 
         count_output++;
@@ -301,6 +614,8 @@ void Lv2Wrapper::connect_data_ports(std::span<float>& left_in,
     return;
   }
 
+  n_audio_connections = 0U;
+
   int count_input = 0;
   int count_output = 0;
 
@@ -308,21 +623,21 @@ void Lv2Wrapper::connect_data_ports(std::span<float>& left_in,
     if (p.type == PortType::TYPE_AUDIO) {
       if (p.is_input) {
         if (count_input == 0) {
-          lilv_instance_connect_port(instance, p.index, left_in.data());
+          connect_audio_port(p.index, left_in.data());
         } else if (count_input == 1) {
-          lilv_instance_connect_port(instance, p.index, right_in.data());
+          connect_audio_port(p.index, right_in.data());
         } else if (count_input == 2) {
-          lilv_instance_connect_port(instance, p.index, probe_left.data());
+          connect_audio_port(p.index, probe_left.data());
         } else if (count_input == 3) {
-          lilv_instance_connect_port(instance, p.index, probe_right.data());
+          connect_audio_port(p.index, probe_right.data());
         }
 
         count_input++;
       } else {
         if (count_output == 0) {
-          lilv_instance_connect_port(instance, p.index, left_out.data());
+          connect_audio_port(p.index, left_out.data());
         } else if (count_output == 1) {
-          lilv_instance_connect_port(instance, p.index, right_out.data());
+          connect_audio_port(p.index, right_out.data());
         }
 
         count_output++;
@@ -331,6 +646,16 @@ void Lv2Wrapper::connect_data_ports(std::span<float>& left_in,
   }
 }
 
+void Lv2Wrapper::connect_audio_port(const uint& index, float* data) {
+  lilv_instance_connect_port(instance, index, data);
+
+  // run() needs to know the buffers when it has to process the block in slices
+
+  if (n_audio_connections < audio_connections.size()) {
+    audio_connections[n_audio_connections++] = {index, data};
+  }
+}
+
 void Lv2Wrapper::set_n_samples(const uint& value) {
   this->n_samples = value;
 }
@@ -343,68 +668,204 @@ auto Lv2Wrapper::get_rate() const -> uint {
   return this->rate;
 }
 
+auto Lv2Wrapper::is_in_place_broken() const -> bool {
+  return descriptor == nullptr || descriptor->in_place_broken;
+}
+
 void Lv2Wrapper::activate() {
   lilv_instance_activate(instance);
 }
 
-void Lv2Wrapper::run() const {
-  if (instance != nullptr) {
+void Lv2Wrapper::run() {
+  if (instance == nullptr) {
+    return;
+  }
+
+  apply_control_events();
+
+  if (control_ramps.empty()) {
     lilv_instance_run(instance, n_samples);
+
+    return;
   }
-}
 
-void Lv2Wrapper::deactivate() {
-  lilv_instance_deactivate(instance);
+  /*
+    Some controls changed since the last block. Instead of jumping to the new values, which can be heard as zipper
+    noise, they are linearly interpolated along this block. The plugin is run in small slices and the controls are
+    updated before each one.
+  */
+
+  for (uint offset = 0U, count = 0U; offset < n_samples; offset += count) {
+    // the last slice takes the remainder so no slice is smaller than the minimum block length we announced
+
+    count = (n_samples - offset < 2U * smoothing_slice) ? n_samples - offset : smoothing_slice;
+
+    const auto t = static_cast<float>(offset + count) / static_cast<float>(n_samples);
+
+    for (const auto& r : control_ramps) {
+      std::atomic_ref<float>(ports[r.index].value).store(r.start + t * (r.end - r.start), std::memory_order_relaxed);
+    }
+
+    for (uint n = 0U; n < n_audio_connections; n++) {
+      lilv_instance_connect_port(instance, audio_connections[n].first, audio_connections[n].second + offset);
+    }
+
+    lilv_instance_run(instance, count);
+  }
+
+  for (uint n = 0U; n < n_audio_connections; n++) {
+    lilv_instance_connect_port(instance, audio_connections[n].first, audio_connections[n].second);
+  }
+
+  control_ramps.clear();
 }
 
-void Lv2Wrapper::set_control_port_value(const std::string& symbol, const float& value) {
-  auto found = false;
+void Lv2Wrapper::apply_control_events() {
+  if (control_events_overflow.exchange(false, std::memory_order_acquire)) {
+    // Some events were lost. We just jump to the values the user wants.
 
-  for (auto& p : ports) {
-    if (p.type == PortType::TYPE_CONTROL && p.symbol == symbol) {
-      if (!p.is_input) {
-        util::warning(plugin_uri + " port " + symbol + " is not an input!");
+    smooth_controls = true;
 
-        return;
+    ControlEvent event;
+
+    while (control_events->pop(event)) {
+    }
+
+    for (auto& p : ports) {
+      if (p.type == PortType::TYPE_CONTROL && p.is_input) {
+        const auto target = std::atomic_ref<float>(control_targets[p.index]).load(std::memory_order_relaxed);
+
+        std::atomic_ref<float>(p.value).store(target, std::memory_order_relaxed);
       }
+    }
 
-      ui_port_event(p.index, value);
+    return;
+  }
 
-      // Check port bounds
-      if (value < p.min) {
-        // util::warning(plugin_uri + ": value " + util::to_string(value) + " is out of minimum limit for port " +
-        //               p.symbol + " (" + p.name + ")");
+  ControlEvent event;
 
-        p.value = p.min;
-      } else if (value > p.max) {
-        // util::warning(plugin_uri + ": value " + util::to_string(value) + " is out of maximum limit for port " +
-        //               p.symbol + " (" + p.name + ")");
+  while (control_events->pop(event)) {
+    auto& p = ports[event.index];
 
-        p.value = p.max;
-      } else {
-        p.value = value;
-      }
+    if (!p.smooth || !smooth_controls || n_samples < 2U * smoothing_slice) {
+      std::atomic_ref<float>(p.value).store(event.value, std::memory_order_relaxed);
 
-      found = true;
+      continue;
+    }
 
-      break;
+    // if this control is already in the list only its destination changes
+
+    auto it = std::ranges::find_if(control_ramps, [&](const auto& r) { return r.index == event.index; });
+
+    if (it != control_ramps.end()) {
+      it->end = event.value;
+    } else if (control_ramps.size() < control_ramps.capacity()) {
+      const auto start = std::atomic_ref<float>(p.value).load(std::memory_order_relaxed);
+
+      control_ramps.push_back({event.index, start, event.value});
     }
   }
 
-  if (!found) {
-    util::warning(plugin_uri + " port symbol not found: " + symbol);
+  smooth_controls = true;
+}
+
+void Lv2Wrapper::deactivate() {
+  lilv_instance_deactivate(instance);
+}
+
+void Lv2Wrapper::reset() {
+  if (instance == nullptr) {
+    return;
   }
+
+  deactivate();
+  activate();
 }
-auto Lv2Wrapper::get_control_port_value(const std::string& symbol) -> float {
-  for (const auto& p : ports) {
-    if (p.type == PortType::TYPE_CONTROL && p.symbol == symbol) {
-      return p.value;
-    }
+
+auto Lv2Wrapper::get_control_port_index(const std::string& symbol) const -> uint {
+  if (descriptor == nullptr) {
+    return invalid_port_index;
+  }
+
+  if (const auto it = descriptor->control_port_indices.find(symbol); it != descriptor->control_port_indices.end()) {
+    return it->second;
   }
 
   util::warning(plugin_uri + " port symbol not found: " + symbol);
 
-  return 0.0F;
+  return invalid_port_index;
+}
+
+void Lv2Wrapper::set_control_port_value(const uint& index, const float& value) {
+  if (index >= n_ports) {
+    return;
+  }
+
+  auto& p = ports[index];
+
+  if (!p.is_input) {
+    util::warning(plugin_uri + " port " + p.symbol + " is not an input!");
+
+    return;
+  }
+
+  ui_port_event(p.index, value);
+
+  queue_control_value(index, value);
+}
+
+void Lv2Wrapper::queue_control_value(const uint& index, const float& value) {
+  const auto& p = ports[index];
+
+  auto v = value;
+
+  // Check port bounds
+  if (v < p.min) {
+    v = p.min;
+  } else if (v > p.max) {
+    v = p.max;
+  }
+
+  std::scoped_lock<std::mutex> lock(control_events_mutex);
+
+  std::atomic_ref<float>(control_targets[index]).store(v, std::memory_order_relaxed);
+
+  /*
+    When nobody is consuming the events, because the plugin is not processing audio, the queue may become full. In this
+    case run() will copy all the targets to the ports.
+  */
+
+  if (!control_events->push({index, v})) {
+    control_events_overflow.store(true, std::memory_order_release);
+  }
+}
+
+auto Lv2Wrapper::make_key_binding(const uint& index) -> KeyBinding* {
+  key_bindings.push_back(std::make_unique<KeyBinding>(KeyBinding{.wrapper = this, .index = index}));
+
+  return key_bindings.back().get();
+}
+
+void Lv2Wrapper::set_control_port_value(const std::string& symbol, const float& value) {
+  set_control_port_value(get_control_port_index(symbol), value);
+}
+
+auto Lv2Wrapper::get_control_port_value(const uint& index) -> float {
+  if (index >= n_ports) {
+    return 0.0F;
+  }
+
+  auto& p = ports[index];
+
+  if (p.type == PortType::TYPE_CONTROL && p.is_input) {
+    return std::atomic_ref<float>(control_targets[index]).load(std::memory_order_relaxed);
+  }
+
+  return std::atomic_ref<float>(p.value).load(std::memory_order_relaxed);
+}
+
+auto Lv2Wrapper::get_control_port_value(const std::string& symbol) -> float {
+  return get_control_port_value(get_control_port_index(symbol));
 }
 
 auto Lv2Wrapper::has_instance() -> bool {
@@ -426,6 +887,12 @@ auto Lv2Wrapper::map_urid(const std::string& uri) -> LV2_URID {
 }
 
 void Lv2Wrapper::load_ui() {
+  const auto ui_list = list_plugin_uis(plugin);
+
+  if (ui_list.empty()) {
+    return;
+  }
+
   // preparing the thread that loads the native ui and updates it over time
 
   std::thread ui_updater([=, this]() {
@@ -436,12 +903,6 @@ void Lv2Wrapper::load_ui() {
         return;
       }
 
-      LilvUIs* uis = lilv_plugin_get_uis(plugin);
-
-      if (uis == nullptr) {
-        return;
-      }
-
       /*
         Code based on:
 
@@ -449,23 +910,10 @@ void Lv2Wrapper::load_ui() {
         https://github.com/zrythm/zrythm/blob/1bc89335ca42b83ce759fd4cd0fd518e43b7983d/src/plugins/lv2/lv2_ui.c#L394
       */
 
-      LILV_FOREACH(uis, u, uis) {
-        const LilvUI* ui = lilv_uis_get(uis, u);
-
-        std::string ui_uri = lilv_node_as_uri(lilv_ui_get_uri(ui));
-
+      for (const auto& [ui_uri, binary_path, bundle_path] : ui_list) {
         util::debug(plugin_uri + " ui uri: "s + ui_uri);
 
-        const LilvNode* binary_node = lilv_ui_get_binary_uri(ui);
-        const LilvNode* bundle_node = lilv_ui_get_bundle_uri(ui);
-
-        {
-          auto path = lilv_file_uri_parse(lilv_node_as_uri(binary_node), nullptr);
-
-          libhandle = dlopen(path, RTLD_NOW);
-
-          lilv_free(path);
-        }
+        libhandle = dlopen(binary_path.c_str(), RTLD_NOW);
 
         if (libhandle == nullptr) {
           continue;
@@ -557,28 +1005,24 @@ void Lv2Wrapper::load_ui() {
 
           LV2UI_Widget widget = nullptr;
 
-          auto bundle_path = lilv_file_uri_parse(lilv_node_as_uri(bundle_node), nullptr);
-
           ui_handle = ui_descriptor->instantiate(
-              ui_descriptor, plugin_uri.c_str(), bundle_path,
+              ui_descriptor, plugin_uri.c_str(), bundle_path.c_str(),
               +[](LV2UI_Controller controller, uint32_t port_index, uint32_t buffer_size, uint32_t port_protocol,
                   const void* buffer) {
                 auto self = static_cast<Lv2Wrapper*>(controller);
 
-                for (auto& p : self->ports) {
-                  if (p.index == port_index) {
-                    // util::warning("The user clicked on port: " + p.name + " -> " + p.symbol);
+                if (port_index >= self->n_ports) {
+                  return;
+                }
+
+                const auto& p = self->ports[port_index];
 
-                    if (port_protocol == 0) {  // port is a ui:floatProtocol
-                      p.value = *static_cast<const float*>(buffer);
-                    }
-                  }
+                if (port_protocol == 0 && p.type == PortType::TYPE_CONTROL && p.is_input) {  // ui:floatProtocol
+                  self->queue_control_value(port_index, *static_cast<const float*>(buffer));
                 }
               },
               this, &widget, features.data());
 
-          lilv_free(bundle_path);
-
           if (ui_handle == nullptr) {
             continue;
           }
@@ -594,15 +1038,15 @@ void Lv2Wrapper::load_ui() {
           break;
         }
       }
-
-      lilv_uis_free(uis);
     }
 
     // initilizing the ui with the current control values
 
     for (const auto& p : ports) {
       if (p.type == PortType::TYPE_CONTROL) {
-        ui_descriptor->port_event(ui_handle, p.index, sizeof(float), 0, &p.value);
+        const auto value = get_control_port_value(p.index);
+
+        ui_descriptor->port_event(ui_handle, p.index, sizeof(float), 0, &value);
       }
     }
 
@@ -630,9 +1074,11 @@ void Lv2Wrapper::notify_ui() {
     return;
   }
 
-  for (const auto& p : ports) {
+  for (auto& p : ports) {
     if (p.type == PortType::TYPE_CONTROL && !p.is_input) {
-      ui_descriptor->port_event(ui_handle, p.index, sizeof(float), 0, &p.value);
+      const auto value = std::atomic_ref<float>(p.value).load(std::memory_order_relaxed);
+
+      ui_descriptor->port_event(ui_handle, p.index, sizeof(float), 0, &value);
     }
   }
 }
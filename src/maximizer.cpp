@@ -32,6 +32,9 @@ Maximizer::Maximizer(const std::string& tag,
     util::debug(log_tag + "urn:zamaudio:ZaMaximX2 is not installed");
   }
 
+  lv2_latency_port = lv2_wrapper->get_control_port_index("lv2_latency");
+  gr_port = lv2_wrapper->get_control_port_index("gr");
+
   lv2_wrapper->bind_key_double<"thresh", "threshold">(settings);
 
   lv2_wrapper->bind_key_double<"ceil", "ceiling">(settings);
@@ -54,6 +57,8 @@ Maximizer::Maximizer(const std::string& tag,
 }
 
 Maximizer::~Maximizer() {
+  stop_notifications();
+
   if (connected_to_pw) {
     disconnect_from_pw();
   }
@@ -84,23 +89,19 @@ void Maximizer::process(std::span<float>& left_in,
     return;
   }
 
-  if (input_gain != 1.0F) {
-    apply_gain(left_in, right_in, input_gain);
-  }
+  apply_input_gain(left_in, right_in);
 
   lv2_wrapper->connect_data_ports(left_in, right_in, left_out, right_out);
 
   lv2_wrapper->run();
 
-  if (output_gain != 1.0F) {
-    apply_gain(left_out, right_out, output_gain);
-  }
+  apply_output_gain(left_out, right_out);
 
   /*
     This plugin gives the latency in number of samples
   */
 
-  const auto lv = static_cast<uint>(lv2_wrapper->get_control_port_value("lv2_latency"));
+  const auto lv = static_cast<uint>(lv2_wrapper->get_control_port_value(lv2_latency_port));
 
   if (latency_n_frames != lv) {
     latency_n_frames = lv;
@@ -109,26 +110,16 @@ void Maximizer::process(std::span<float>& left_in,
 
     util::debug(log_tag + name + " latency: " + util::to_string(latency_value, "") + " s");
 
-    util::idle_add([=, this]() {
-      if (!post_messages || latency.empty()) {
-        return;
-      }
-
-      latency.emit();
-    });
+    notify_latency_change();
 
     update_filter_params();
   }
 
   if (post_messages) {
-    get_peaks(left_in, right_in, left_out, right_out);
-
     if (send_notifications) {
       // reduction needed as double for levelbar widget ui, so we convert it here
 
-      reduction_port_value = static_cast<double>(lv2_wrapper->get_control_port_value("gr"));
-
-      reduction.emit(reduction_port_value);
+      reduction_port_value = static_cast<double>(lv2_wrapper->get_control_port_value(gr_port));
 
       notify();
     }
@@ -138,3 +129,11 @@ void Maximizer::process(std::span<float>& left_in,
 auto Maximizer::get_latency_seconds() -> float {
   return latency_value;
 }
+
+void Maximizer::pack_meters(std::span<double> values) {
+  values[0] = reduction_port_value;
+}
+
+void Maximizer::emit_meters(std::span<const double> values) {
+  reduction.emit(values[0]);
+}
@@ -38,6 +38,22 @@ MultibandCompressor::MultibandCompressor(const std::string& tag,
     util::debug(log_tag + "http://lsp-plug.in/plugins/lv2/sc_mb_compressor_stereo is not installed");
   }
 
+  // the band meters are read in the realtime thread. So their symbols are resolved only once
+
+  out_latency_port = lv2_wrapper->get_control_port_index("out_latency");
+
+  for (uint n = 0U; n < n_bands; n++) {
+    const auto nstr = util::to_string(n);
+
+    fre_ports[n] = lv2_wrapper->get_control_port_index("fre_" + nstr);
+    elm_l_ports[n] = lv2_wrapper->get_control_port_index("elm_" + nstr + "l");
+    elm_r_ports[n] = lv2_wrapper->get_control_port_index("elm_" + nstr + "r");
+    clm_l_ports[n] = lv2_wrapper->get_control_port_index("clm_" + nstr + "l");
+    clm_r_ports[n] = lv2_wrapper->get_control_port_index("clm_" + nstr + "r");
+    rlm_l_ports[n] = lv2_wrapper->get_control_port_index("rlm_" + nstr + "l");
+    rlm_r_ports[n] = lv2_wrapper->get_control_port_index("rlm_" + nstr + "r");
+  }
+
   gconnections.push_back(g_signal_connect(settings, "changed::sidechain-input-device",
                                           G_CALLBACK(+[](GSettings* settings, char* key, gpointer user_data) {
                                             auto* self = static_cast<MultibandCompressor*>(user_data);
@@ -63,6 +79,8 @@ MultibandCompressor::MultibandCompressor(const std::string& tag,
 }
 
 MultibandCompressor::~MultibandCompressor() {
+  stop_notifications();
+
   if (connected_to_pw) {
     disconnect_from_pw();
   }
@@ -95,22 +113,18 @@ void MultibandCompressor::process(std::span<float>& left_in,
     return;
   }
 
-  if (input_gain != 1.0F) {
-    apply_gain(left_in, right_in, input_gain);
-  }
+  apply_input_gain(left_in, right_in);
 
   lv2_wrapper->connect_data_ports(left_in, right_in, left_out, right_out, probe_left, probe_right);
   lv2_wrapper->run();
 
-  if (output_gain != 1.0F) {
-    apply_gain(left_out, right_out, output_gain);
-  }
+  apply_output_gain(left_out, right_out);
 
   /*
    This plugin gives the latency in number of samples
  */
 
-  const auto lv = static_cast<uint>(lv2_wrapper->get_control_port_value("out_latency"));
+  const auto lv = static_cast<uint>(lv2_wrapper->get_control_port_value(out_latency_port));
 
   if (latency_n_frames != lv) {
     latency_n_frames = lv;
@@ -119,41 +133,26 @@ void MultibandCompressor::process(std::span<float>& left_in,
 
     util::debug(log_tag + name + " latency: " + util::to_string(latency_value, "") + " s");
 
-    util::idle_add([=, this]() {
-      if (!post_messages || latency.empty()) {
-        return;
-      }
-
-      latency.emit();
-    });
+    notify_latency_change();
 
     update_filter_params();
   }
 
   if (post_messages) {
-    get_peaks(left_in, right_in, left_out, right_out);
-
     if (send_notifications) {
       for (uint n = 0U; n < n_bands; n++) {
-        const auto nstr = util::to_string(n);
+        frequency_range_end_port_array.at(n) = lv2_wrapper->get_control_port_value(fre_ports[n]);
 
-        frequency_range_end_port_array.at(n) = lv2_wrapper->get_control_port_value("fre_" + nstr);
+        envelope_port_array.at(n) = 0.5F * (lv2_wrapper->get_control_port_value(elm_l_ports[n]) +
+                                            lv2_wrapper->get_control_port_value(elm_r_ports[n]));
 
-        envelope_port_array.at(n) = 0.5F * (lv2_wrapper->get_control_port_value("elm_" + nstr + "l") +
-                                            lv2_wrapper->get_control_port_value("elm_" + nstr + "r"));
+        curve_port_array.at(n) = 0.5F * (lv2_wrapper->get_control_port_value(clm_l_ports[n]) +
+                                         lv2_wrapper->get_control_port_value(clm_r_ports[n]));
 
-        curve_port_array.at(n) = 0.5F * (lv2_wrapper->get_control_port_value("clm_" + nstr + "l") +
-                                         lv2_wrapper->get_control_port_value("clm_" + nstr + "r"));
-
-        reduction_port_array.at(n) = 0.5F * (lv2_wrapper->get_control_port_value("rlm_" + nstr + "l") +
-                                             lv2_wrapper->get_control_port_value("rlm_" + nstr + "r"));
+        reduction_port_array.at(n) = 0.5F * (lv2_wrapper->get_control_port_value(rlm_l_ports[n]) +
+                                             lv2_wrapper->get_control_port_value(rlm_r_ports[n]));
       }
 
-      frequency_range.emit(frequency_range_end_port_array);
-      envelope.emit(envelope_port_array);
-      curve.emit(curve_port_array);
-      reduction.emit(reduction_port_array);
-
       notify();
     }
   }
@@ -204,3 +203,30 @@ void MultibandCompressor::update_probe_links() {
 auto MultibandCompressor::get_latency_seconds() -> float {
   return latency_value;
 }
+
+void MultibandCompressor::pack_meters(std::span<double> values) {
+  // n_bands values for each meter array. In the same order emit_meters reads them
+
+  for (uint n = 0U; n < n_bands; n++) {
+    values[n] = frequency_range_end_port_array.at(n);
+    values[n_bands + n] = envelope_port_array.at(n);
+    values[2U * n_bands + n] = curve_port_array.at(n);
+    values[3U * n_bands + n] = reduction_port_array.at(n);
+  }
+}
+
+void MultibandCompressor::emit_meters(std::span<const double> values) {
+  std::array<float, n_bands> frequency_range_end{}, envelope_values{}, curve_values{}, reduction_values{};
+
+  for (uint n = 0U; n < n_bands; n++) {
+    frequency_range_end.at(n) = static_cast<float>(values[n]);
+    envelope_values.at(n) = static_cast<float>(values[n_bands + n]);
+    curve_values.at(n) = static_cast<float>(values[2U * n_bands + n]);
+    reduction_values.at(n) = static_cast<float>(values[3U * n_bands + n]);
+  }
+
+  frequency_range.emit(frequency_range_end);
+  envelope.emit(envelope_values);
+  curve.emit(curve_values);
+  reduction.emit(reduction_values);
+}
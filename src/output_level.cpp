@@ -42,8 +42,7 @@ void OutputLevel::process(std::span<float>& left_in,
                           std::span<float>& right_in,
                           std::span<float>& left_out,
                           std::span<float>& right_out) {
-  std::copy(left_in.begin(), left_in.end(), left_out.begin());
-  std::copy(right_in.begin(), right_in.end(), right_out.begin());
+  passthrough(left_in, right_in, left_out, right_out);
 
   if (post_messages) {
     get_peaks(left_in, right_in, left_out, right_out);
@@ -57,3 +56,7 @@ void OutputLevel::process(std::span<float>& left_in,
 auto OutputLevel::get_latency_seconds() -> float {
   return 0.0F;
 }
+
+auto OutputLevel::can_process_in_place() const -> bool {
+  return true;
+}
@@ -0,0 +1,322 @@
+/*
+ *  Copyright © 2017-2023 Wellington Wallace
+ *
+ *  This file is part of Easy Effects.
+ *
+ *  Easy Effects is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Easy Effects is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Easy Effects. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "partitioned_convolver.hpp"
+#include <pthread.h>
+#include <sched.h>
+#include <algorithm>
+#include "dsp_kernels.hpp"
+
+PartitionedConvolver::Stage::Stage(const size_t& partition_size,
+                                   const size_t& first_tap,
+                                   const size_t& last_tap,
+                                   const std::array<std::span<const float>, 2>& kernels,
+                                   const bool& use_thread)
+    : size(partition_size), n_bins(partition_size + 1U), threaded(use_thread), time(2U * partition_size) {
+  n_partitions = std::max<size_t>(1U, (last_tap - std::min(first_tap, last_tap) + size - 1U) / size);
+
+  spectrum.resize(n_bins);
+
+  auto* spectrum_ptr = reinterpret_cast<fftwf_complex*>(spectrum.data());
+
+  forward = fftwf_plan_dft_r2c_1d(static_cast<int>(2U * size), time.data(), spectrum_ptr, FFTW_ESTIMATE);
+  backward = fftwf_plan_dft_c2r_1d(static_cast<int>(2U * size), spectrum_ptr, time.data(), FFTW_ESTIMATE);
+
+  // the scale of the inverse transform is applied to the filters
+
+  const auto scale = 1.0F / static_cast<float>(2U * size);
+
+  for (size_t c = 0U; c < 2U; c++) {
+    const auto& kernel = kernels.at(c);
+
+    window.at(c).resize(2U * size);
+    output.at(c).resize(size);
+    current.at(c).resize(size);
+    fdl.at(c).resize(n_partitions * n_bins);
+    filters.at(c).resize(n_partitions * n_bins);
+
+    if (threaded) {
+      pending.at(c).resize(size);
+    }
+
+    for (size_t p = 0U; p < n_partitions; p++) {
+      std::ranges::fill(time, 0.0F);
+
+      const auto begin = std::min(first_tap + p * size, kernel.size());
+      const auto end = std::min({begin + size, last_tap, kernel.size()});
+
+      if (begin < end) {
+        std::copy(kernel.begin() + begin, kernel.begin() + end, time.begin());
+      }
+
+      fftwf_execute(forward);
+
+      std::ranges::transform(spectrum, filters.at(c).begin() + p * n_bins, [&](const auto& v) { return v * scale; });
+    }
+  }
+
+  if (threaded) {
+    worker = std::thread(&Stage::work, this);
+
+    /*
+      Best effort. Without realtime privileges the worker keeps the normal scheduling. It is still fine as long as it
+      finishes a block in the time the realtime thread takes to consume one.
+    */
+
+    sched_param param{};
+
+    param.sched_priority = sched_get_priority_min(SCHED_FIFO);
+
+    pthread_setschedparam(worker.native_handle(), SCHED_FIFO, &param);
+  }
+}
+
+PartitionedConvolver::Stage::~Stage() {
+  if (worker.joinable()) {
+    wait();
+
+    running = false;
+
+    submitted++;
+
+    submitted.notify_one();
+
+    worker.join();
+  }
+
+  fftwf_destroy_plan(forward);
+  fftwf_destroy_plan(backward);
+}
+
+void PartitionedConvolver::Stage::step() {
+  fdl_index = (fdl_index + 1U) % n_partitions;
+
+  for (size_t c = 0U; c < 2U; c++) {
+    auto& w = window.at(c);
+
+    std::ranges::copy(w, time.begin());
+
+    fftwf_execute(forward);
+
+    std::ranges::copy(spectrum, fdl.at(c).begin() + fdl_index * n_bins);
+
+    // the current block becomes the previous one
+
+    std::copy(w.begin() + size, w.end(), w.begin());
+
+    std::ranges::fill(spectrum, std::complex<float>(0.0F, 0.0F));
+
+    const std::span<const std::complex<float>> delay_line = fdl.at(c);
+    const std::span<const std::complex<float>> filter = filters.at(c);
+
+    for (size_t p = 0U; p < n_partitions; p++) {
+      const auto slot = (fdl_index + n_partitions - p) % n_partitions;
+
+      dsp::complex_multiply_accumulate(delay_line.subspan(slot * n_bins, n_bins), filter.subspan(p * n_bins, n_bins),
+                                       spectrum);
+    }
+
+    fftwf_execute(backward);
+
+    std::copy(time.begin() + size, time.end(), output.at(c).begin());
+  }
+}
+
+void PartitionedConvolver::Stage::work() {
+  uint seen = 0U;
+
+  while (true) {
+    submitted.wait(seen);
+
+    if (!running) {
+      return;
+    }
+
+    seen = submitted.load();
+
+    step();
+
+    done.store(seen);
+
+    done.notify_one();
+  }
+}
+
+void PartitionedConvolver::Stage::wait() {
+  /*
+    The worker has the time of a whole block to compute the previous one. We only really block here if the machine can
+    not keep up with the convolution.
+  */
+
+  for (auto d = done.load(); d != submitted.load(); d = done.load()) {
+    done.wait(d);
+  }
+}
+
+void PartitionedConvolver::Stage::finish_block() {
+  if (!threaded) {
+    step();
+
+    std::swap(output, current);
+
+    return;
+  }
+
+  if (busy) {
+    wait();
+
+    std::swap(output, current);
+  }
+
+  for (size_t c = 0U; c < 2U; c++) {
+    std::ranges::copy(pending.at(c), window.at(c).begin() + size);
+  }
+
+  submitted++;
+
+  submitted.notify_one();
+
+  busy = true;
+}
+
+void PartitionedConvolver::Stage::clear() {
+  wait();
+
+  busy = false;
+
+  position = 0U;
+
+  fdl_index = 0U;
+
+  for (size_t c = 0U; c < 2U; c++) {
+    std::ranges::fill(window.at(c), 0.0F);
+    std::ranges::fill(pending.at(c), 0.0F);
+    std::ranges::fill(output.at(c), 0.0F);
+    std::ranges::fill(current.at(c), 0.0F);
+    std::ranges::fill(fdl.at(c), std::complex<float>(0.0F, 0.0F));
+  }
+}
+
+PartitionedConvolver::~PartitionedConvolver() {
+  stages.clear();
+}
+
+void PartitionedConvolver::configure(std::span<const float> kernel_L, std::span<const float> kernel_R) {
+  stages.clear();
+
+  n_taps = std::max(kernel_L.size(), kernel_R.size());
+
+  const std::array<std::span<const float>, 2> kernels = {kernel_L, kernel_R};
+
+  for (size_t c = 0U; c < 2U; c++) {
+    auto& direct = direct_kernel.at(c);
+
+    direct.assign(head_size, 0.0F);
+
+    const auto n = std::min(head_size, kernels.at(c).size());
+
+    std::reverse_copy(kernels.at(c).begin(), kernels.at(c).begin() + n, direct.end() - n);
+  }
+
+  /*
+    The head partitions start right after the direct taps. A stage with partitions of S frames covers the taps from
+    2 * S up to where the next stage begins. The last one goes until the end of the kernel.
+  */
+
+  size_t size = head_size;
+  size_t first_tap = head_size;
+
+  while (true) {
+    const auto next_size = std::min(size * stage_growth, max_partition_size);
+
+    const bool last = size >= max_partition_size || 2U * next_size >= n_taps;
+
+    const auto last_tap = last ? n_taps : 2U * next_size;
+
+    stages.push_back(std::make_unique<Stage>(size, first_tap, last_tap, kernels, !stages.empty()));
+
+    if (last) {
+      break;
+    }
+
+    size = next_size;
+
+    first_tap = 2U * size;
+  }
+}
+
+void PartitionedConvolver::process(std::span<float> left, std::span<float> right) {
+  if (stages.empty()) {
+    return;
+  }
+
+  auto& head = *stages.front();
+
+  const std::array<std::span<float>, 2> channels = {left, right};
+
+  for (size_t offset = 0U; offset < left.size();) {
+    // no stage reaches the end of its block in the middle of a chunk. Their sizes are multiples of the head size
+
+    const auto n = std::min(left.size() - offset, head_size - head.position);
+
+    for (size_t c = 0U; c < 2U; c++) {
+      auto data = channels.at(c).subspan(offset, n);
+
+      std::ranges::copy(data, head.window.at(c).begin() + head.size + head.position);
+
+      for (size_t s = 1U; s < stages.size(); s++) {
+        std::ranges::copy(data, stages[s]->pending.at(c).begin() + stages[s]->position);
+      }
+
+      const std::span<const float> history = head.window.at(c);
+
+      for (size_t i = 0U; i < n; i++) {
+        auto y = dsp::dot(history.subspan(head.position + i + 1U, head_size), direct_kernel.at(c));
+
+        for (const auto& stage : stages) {
+          y += stage->current.at(c)[stage->position + i];
+        }
+
+        data[i] = y;
+      }
+    }
+
+    for (auto& stage : stages) {
+      stage->position += n;
+
+      if (stage->position == stage->size) {
+        stage->finish_block();
+
+        stage->position = 0U;
+      }
+    }
+
+    offset += n;
+  }
+}
+
+void PartitionedConvolver::reset() {
+  for (auto& stage : stages) {
+    stage->clear();
+  }
+}
+
+auto PartitionedConvolver::kernel_size() const -> size_t {
+  return n_taps;
+}
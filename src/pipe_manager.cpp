@@ -139,6 +139,19 @@ auto port_info_from_props(const spa_dict* props) -> PortInfo {
   return info;
 }
 
+/*
+  PipeWire may recycle the id of a removed node before we are told about the removal. In that case the id already maps
+  to the serial of the new node and must be kept.
+*/
+
+void erase_node_serial(PipeManager* pm, const NodeInfo& node) {
+  pm->update_graph([&] {
+    if (const auto it = pm->node_serials.find(node.id); it != pm->node_serials.end() && it->second == node.serial) {
+      pm->node_serials.erase(it);
+    }
+  });
+}
+
 void on_removed_node_proxy(void* data) {
   auto* const nd = static_cast<node_data*>(data);
 
@@ -164,6 +177,8 @@ void on_destroy_node_proxy(void* data) {
 
   spa_hook_remove(&nd->proxy_listener);
 
+  erase_node_serial(pm, node_it->second);
+
   pm->node_map.erase(node_it);
 
   if (!PipeManager::exiting) {
@@ -291,6 +306,8 @@ void on_node_info(void* object, const struct pw_node_info* info) {
 
     spa_hook_remove(&nd->proxy_listener);
 
+    erase_node_serial(pm, node_it->second);
+
     pm->node_map.erase(node_it);
 
     if (nd->nd_info->media_class == tags::pipewire::media_class::source) {
@@ -716,26 +733,26 @@ void on_link_info(void* object, const struct pw_link_info* info) {
   auto* const ld = static_cast<proxy_data*>(object);
   auto* const pm = ld->pm;
 
-  LinkInfo link_copy;
-
-  for (auto& l : ld->pm->list_links) {
-    if (l.serial == ld->serial) {
-      l.state = info->state;
+  std::optional<LinkInfo> link_copy;
 
-      link_copy = l;
+  pm->update_graph([&] {
+    if (auto* l = pm->links.find(ld->serial); l != nullptr) {
+      l->state = info->state;
 
-      util::idle_add([pm, link_copy] {
-        if (PipeManager::exiting) {
-          return;
-        }
+      link_copy = *l;
+    }
+  });
 
-        pm->link_changed.emit(link_copy);
-      });
+  if (link_copy.has_value()) {
+    util::idle_add([pm, link_copy] {
+      if (PipeManager::exiting) {
+        return;
+      }
 
-      // util::warning(pw_link_state_as_string(l.state));
+      pm->link_changed.emit(*link_copy);
+    });
 
-      break;
-    }
+    // util::warning(pw_link_state_as_string(l->state));
   }
 
   // const struct spa_dict_item* item = nullptr;
@@ -747,9 +764,7 @@ void on_destroy_link_proxy(void* data) {
 
   spa_hook_remove(&ld->proxy_listener);
 
-  ld->pm->list_links.erase(std::remove_if(ld->pm->list_links.begin(), ld->pm->list_links.end(),
-                                          [=](const auto& n) { return n.serial == ld->serial; }),
-                           ld->pm->list_links.end());
+  ld->pm->update_graph([=] { ld->pm->links.erase(ld->serial); });
 }
 
 void on_destroy_port_proxy(void* data) {
@@ -757,9 +772,7 @@ void on_destroy_port_proxy(void* data) {
 
   spa_hook_remove(&pd->proxy_listener);
 
-  pd->pm->list_ports.erase(std::remove_if(pd->pm->list_ports.begin(), pd->pm->list_ports.end(),
-                                          [=](const auto& n) { return n.serial == pd->serial; }),
-                           pd->pm->list_ports.end());
+  pd->pm->update_graph([=] { pd->pm->ports.erase(pd->serial); });
 }
 
 void on_module_info(void* object, const struct pw_module_info* info) {
@@ -1003,6 +1016,18 @@ auto on_metadata_property(void* data, uint32_t id, const char* key, const char*
 
 const struct pw_metadata_events metadata_events = {PW_VERSION_METADATA_EVENTS, on_metadata_property};
 
+void on_link_transaction_error(void* data, int seq, int res, const char* message) {
+  auto* const pl = static_cast<PipeManager::LinkTransaction::PendingLink*>(data);
+
+  pl->res = res;
+
+  util::warning("the server refused the link from node " + util::to_string(pl->edge.output_node_id) + " to node " +
+                util::to_string(pl->edge.input_node_id) + ": " + message);
+}
+
+const struct pw_proxy_events link_transaction_events = {.version = PW_VERSION_PROXY_EVENTS,
+                                                        .error = on_link_transaction_error};
+
 const struct pw_proxy_events link_proxy_events = {.destroy = on_destroy_link_proxy,
                                                   .bound = nullptr,
                                                   .removed = on_removed_proxy,
@@ -1171,6 +1196,8 @@ void on_registry_global(void* data,
       return;
     }
 
+    pm->update_graph([&] { pm->node_serials[id] = serial; });
+
     pw_node_add_listener(proxy, &nd->object_listener, &node_events, nd);
     pw_proxy_add_listener(proxy, &nd->proxy_listener, &node_proxy_events, nd);
 
@@ -1249,7 +1276,7 @@ void on_registry_global(void* data,
     link_info.id = id;
     link_info.serial = serial;
 
-    pm->list_links.push_back(link_info);
+    pm->update_graph([&] { pm->links.insert(link_info); });
 
     try {
       const auto input_node = pm->node_map_at_id(link_info.input_node_id);
@@ -1292,7 +1319,7 @@ void on_registry_global(void* data,
     // std::cout << port_info.name << "\t" << port_info.audio_channel << "\t" << port_info.direction << "\t"
     //           << port_info.format_dsp << "\t" << port_info.port_id << "\t" << port_info.node_id << std::endl;
 
-    pm->list_ports.push_back(port_info);
+    pm->update_graph([&] { pm->ports.insert(port_info); });
 
     return;
   }
@@ -1472,6 +1499,117 @@ const struct pw_registry_events registry_events = {
 
 }  // namespace
 
+void PortRegistry::insert(const PortInfo& port) {
+  ports.insert_or_assign(port.serial, port);
+
+  serials_by_node[port.node_id].push_back(port.serial);
+}
+
+void PortRegistry::erase(const uint64_t& serial) {
+  const auto it = ports.find(serial);
+
+  if (it == ports.end()) {
+    return;
+  }
+
+  if (const auto node_it = serials_by_node.find(it->second.node_id); node_it != serials_by_node.end()) {
+    std::erase(node_it->second, serial);
+
+    if (node_it->second.empty()) {
+      serials_by_node.erase(node_it);
+    }
+  }
+
+  ports.erase(it);
+}
+
+auto PortRegistry::of_node(const uint& node_id) const -> std::vector<PortInfo> {
+  std::vector<PortInfo> list;
+
+  if (const auto node_it = serials_by_node.find(node_id); node_it != serials_by_node.end()) {
+    for (const auto& serial : node_it->second) {
+      list.push_back(ports.at(serial));
+    }
+  }
+
+  return list;
+}
+
+auto PortRegistry::count(const uint& node_id) const -> uint {
+  const auto node_it = serials_by_node.find(node_id);
+
+  return (node_it != serials_by_node.end()) ? static_cast<uint>(node_it->second.size()) : 0U;
+}
+
+void LinkRegistry::insert(const LinkInfo& link) {
+  erase(link.serial);
+
+  links.insert({link.serial, link});
+
+  serials_by_output_node.insert({link.output_node_id, link.serial});
+  serials_by_input_node.insert({link.input_node_id, link.serial});
+}
+
+void LinkRegistry::erase(const uint64_t& serial) {
+  const auto it = links.find(serial);
+
+  if (it == links.end()) {
+    return;
+  }
+
+  auto erase_from = [&](std::unordered_multimap<uint, uint64_t>& index, const uint& node_id) {
+    auto [first, last] = index.equal_range(node_id);
+
+    for (; first != last; first++) {
+      if (first->second == serial) {
+        index.erase(first);
+
+        return;
+      }
+    }
+  };
+
+  erase_from(serials_by_output_node, it->second.output_node_id);
+  erase_from(serials_by_input_node, it->second.input_node_id);
+
+  links.erase(it);
+}
+
+auto LinkRegistry::find(const uint64_t& serial) -> LinkInfo* {
+  const auto it = links.find(serial);
+
+  return (it != links.end()) ? &it->second : nullptr;
+}
+
+auto LinkRegistry::collect(const std::unordered_multimap<uint, uint64_t>& index, const uint& node_id) const
+    -> std::vector<LinkInfo> {
+  std::vector<LinkInfo> list;
+
+  auto [first, last] = index.equal_range(node_id);
+
+  for (; first != last; first++) {
+    list.push_back(links.at(first->second));
+  }
+
+  return list;
+}
+
+auto LinkRegistry::from_node(const uint& node_id) const -> std::vector<LinkInfo> {
+  return collect(serials_by_output_node, node_id);
+}
+
+auto LinkRegistry::to_node(const uint& node_id) const -> std::vector<LinkInfo> {
+  return collect(serials_by_input_node, node_id);
+}
+
+auto LinkRegistry::between(const uint& output_node_id, const uint& input_node_id) const -> std::vector<LinkInfo> {
+  auto list = from_node(output_node_id);
+
+  std::erase_if(list, [&](const auto& link) { return link.input_node_id != input_node_id; });
+
+  return list;
+}
+
 PipeManager::PipeManager() : header_version(pw_get_headers_version()), library_version(pw_get_library_version()) {
   pw_init(nullptr, nullptr);
 
@@ -1624,28 +1762,24 @@ PipeManager::~PipeManager() {
 auto PipeManager::node_map_at_id(const uint& id) -> NodeInfo& {
   // Helper method to access easily a node by id, same functionality as map.at()
 
-  for (auto& [serial, node] : node_map) {
-    if (node.id == id) {
-      return node;
-    }
+  uint64_t serial = 0U;
+
+  {
+    std::scoped_lock<std::mutex> lock(graph_mutex);
+
+    serial = node_serials.at(id);
   }
 
-  throw std::out_of_range("");
+  return node_map.at(serial);
 }
 
 auto PipeManager::stream_is_connected(const uint& id, const std::string& media_class) -> bool {
   if (media_class == tags::pipewire::media_class::output_stream) {
-    for (const auto& link : list_links) {
-      if (link.output_node_id == id && link.input_node_id == ee_sink_node.id) {
-        return true;
-      }
-    }
-  } else if (media_class == tags::pipewire::media_class::input_stream) {
-    for (const auto& link : list_links) {
-      if (link.output_node_id == ee_source_node.id && link.input_node_id == id) {
-        return true;
-      }
-    }
+    return !links_between(id, ee_sink_node.id).empty();
+  }
+
+  if (media_class == tags::pipewire::media_class::input_stream) {
+    return !links_between(ee_source_node.id, id).empty();
   }
 
   return false;
@@ -1716,28 +1850,57 @@ void PipeManager::set_node_mute(pw_proxy* proxy, const bool& state) {
 }
 
 auto PipeManager::count_node_ports(const uint& node_id) -> uint {
-  uint count = 0U;
+  std::scoped_lock<std::mutex> lock(graph_mutex);
 
-  for (const auto& port : list_ports) {
-    if (port.node_id == node_id) {
-      count++;
-    }
-  }
+  return ports.count(node_id);
+}
+
+auto PipeManager::links_from_node(const uint& node_id) -> std::vector<LinkInfo> {
+  std::scoped_lock<std::mutex> lock(graph_mutex);
 
-  return count;
+  return links.from_node(node_id);
 }
 
-auto PipeManager::link_nodes(const uint& output_node_id,
-                             const uint& input_node_id,
-                             const bool& probe_link,
-                             const bool& link_passive) -> std::vector<pw_proxy*> {
-  std::vector<pw_proxy*> list;
+auto PipeManager::links_to_node(const uint& node_id) -> std::vector<LinkInfo> {
+  std::scoped_lock<std::mutex> lock(graph_mutex);
+
+  return links.to_node(node_id);
+}
+
+auto PipeManager::links_between(const uint& output_node_id, const uint& input_node_id) -> std::vector<LinkInfo> {
+  std::scoped_lock<std::mutex> lock(graph_mutex);
+
+  return links.between(output_node_id, input_node_id);
+}
+
+PipeManager::LinkTransaction::LinkTransaction(PipeManager* pipe_manager) : pm(pipe_manager) {}
+
+PipeManager::LinkTransaction::~LinkTransaction() {
+  if (!committed) {
+    release(true);
+  }
+}
+
+auto PipeManager::LinkTransaction::add(const uint& output_node_id,
+                                       const uint& input_node_id,
+                                       const bool& probe_link,
+                                       const bool& link_passive) -> uint {
   std::vector<PortInfo> list_output_ports;
   std::vector<PortInfo> list_input_ports;
   auto use_audio_channel = true;
 
-  for (const auto& port : list_ports) {
-    if (port.node_id == output_node_id && port.direction == "out") {
+  std::vector<PortInfo> output_node_ports;
+  std::vector<PortInfo> input_node_ports;
+
+  {
+    std::scoped_lock<std::mutex> lock(pm->graph_mutex);
+
+    output_node_ports = pm->ports.of_node(output_node_id);
+    input_node_ports = pm->ports.of_node(input_node_id);
+  }
+
+  for (const auto& port : output_node_ports) {
+    if (port.direction == "out") {
       list_output_ports.push_back(port);
 
       if (!probe_link) {
@@ -1746,8 +1909,10 @@ auto PipeManager::link_nodes(const uint& output_node_id,
         }
       }
     }
+  }
 
-    if (port.node_id == input_node_id && port.direction == "in") {
+  for (const auto& port : input_node_ports) {
+    if (port.direction == "in") {
       if (!probe_link) {
         list_input_ports.push_back(port);
 
@@ -1765,15 +1930,19 @@ auto PipeManager::link_nodes(const uint& output_node_id,
   if (list_input_ports.empty()) {
     util::debug("node " + util::to_string(input_node_id) + " has no input ports yet. Aborting the link");
 
-    return list;
+    return 0U;
   }
 
   if (list_output_ports.empty()) {
     util::debug("node " + util::to_string(output_node_id) + " has no output ports yet. Aborting the link");
 
-    return list;
+    return 0U;
   }
 
+  uint n_queued = 0U;
+
+  pm->lock();
+
   for (const auto& outp : list_output_ports) {
     for (const auto& inp : list_input_ports) {
       bool ports_match = false;
@@ -1794,39 +1963,105 @@ auto PipeManager::link_nodes(const uint& output_node_id,
         }
       }
 
-      if (ports_match) {
-        pw_properties* props = pw_properties_new(nullptr, nullptr);
+      if (!ports_match) {
+        continue;
+      }
+
+      pw_properties* props = pw_properties_new(nullptr, nullptr);
 
-        pw_properties_set(props, PW_KEY_LINK_PASSIVE, (link_passive) ? "true" : "false");
-        pw_properties_set(props, PW_KEY_OBJECT_LINGER, "false");
-        pw_properties_set(props, PW_KEY_LINK_OUTPUT_NODE, util::to_string(output_node_id).c_str());
-        pw_properties_set(props, PW_KEY_LINK_OUTPUT_PORT, util::to_string(outp.id).c_str());
-        pw_properties_set(props, PW_KEY_LINK_INPUT_NODE, util::to_string(input_node_id).c_str());
-        pw_properties_set(props, PW_KEY_LINK_INPUT_PORT, util::to_string(inp.id).c_str());
+      pw_properties_set(props, PW_KEY_LINK_PASSIVE, (link_passive) ? "true" : "false");
+      pw_properties_set(props, PW_KEY_OBJECT_LINGER, "false");
+      pw_properties_set(props, PW_KEY_LINK_OUTPUT_NODE, util::to_string(output_node_id).c_str());
+      pw_properties_set(props, PW_KEY_LINK_OUTPUT_PORT, util::to_string(outp.id).c_str());
+      pw_properties_set(props, PW_KEY_LINK_INPUT_NODE, util::to_string(input_node_id).c_str());
+      pw_properties_set(props, PW_KEY_LINK_INPUT_PORT, util::to_string(inp.id).c_str());
 
-        lock();
+      auto* proxy = static_cast<pw_proxy*>(
+          pw_core_create_object(pm->core, "link-factory", PW_TYPE_INTERFACE_Link, PW_VERSION_LINK, &props->dict, 0));
 
-        auto* proxy = static_cast<pw_proxy*>(
-            pw_core_create_object(core, "link-factory", PW_TYPE_INTERFACE_Link, PW_VERSION_LINK, &props->dict, 0));
+      pw_properties_free(props);
 
-        pw_properties_free(props);
+      if (proxy == nullptr) {
+        util::warning("failed to link the node " + util::to_string(output_node_id) + " to " +
+                      util::to_string(input_node_id));
 
-        if (proxy == nullptr) {
-          util::warning("failed to link the node " + util::to_string(output_node_id) + " to " +
-                        util::to_string(input_node_id));
+        break;
+      }
 
-          unlock();
+      auto pl = std::make_unique<PendingLink>();
 
-          return list;
-        }
+      pl->proxy = proxy;
+      pl->edge = {.output_node_id = output_node_id, .input_node_id = input_node_id, .probe_link = probe_link};
 
-        sync_wait_unlock();
+      pw_proxy_add_listener(proxy, &pl->listener, &link_transaction_events, pl.get());
 
-        list.push_back(proxy);
-      }
+      pending.push_back(std::move(pl));
+
+      n_queued++;
     }
   }
 
+  pm->unlock();
+
+  return n_queued;
+}
+
+auto PipeManager::LinkTransaction::commit() -> std::map<LinkEdge, std::vector<pw_proxy*>> {
+  std::map<LinkEdge, std::vector<pw_proxy*>> list;
+
+  committed = true;
+
+  if (pending.empty()) {
+    return list;
+  }
+
+  // the server handles our messages in order. When it answers this sync every link above was either created or refused
+
+  pm->lock();
+
+  pm->sync_wait_unlock();
+
+  for (const auto& pl : pending) {
+    if (pl->res >= 0) {
+      list[pl->edge].push_back(pl->proxy);
+    }
+  }
+
+  release(false);
+
+  return list;
+}
+
+void PipeManager::LinkTransaction::release(const bool& destroy_all) {
+  pm->lock();
+
+  for (const auto& pl : pending) {
+    spa_hook_remove(&pl->listener);
+
+    if (destroy_all || pl->res < 0) {
+      pw_proxy_destroy(pl->proxy);
+    }
+  }
+
+  pm->unlock();
+
+  pending.clear();
+}
+
+auto PipeManager::link_nodes(const uint& output_node_id,
+                             const uint& input_node_id,
+                             const bool& probe_link,
+                             const bool& link_passive) -> std::vector<pw_proxy*> {
+  LinkTransaction transaction(this);
+
+  transaction.add(output_node_id, input_node_id, probe_link, link_passive);
+
+  std::vector<pw_proxy*> list;
+
+  for (const auto& proxies : transaction.commit() | std::views::values) {
+    list.insert(list.end(), proxies.begin(), proxies.end());
+  }
+
   return list;
 }
 
@@ -1854,6 +2089,13 @@ auto PipeManager::wait_full() const -> int {
   return pw_thread_loop_timed_wait_full(thread_loop, &abstime);
 }
 
+auto PipeManager::wait_for_graph(const std::function<bool()>& predicate, const std::chrono::milliseconds& timeout)
+    -> bool {
+  std::unique_lock<std::mutex> lock(graph_mutex);
+
+  return graph_changed.wait_for(lock, timeout, predicate);
+}
+
 void PipeManager::destroy_object(const int& id) const {
   lock();
 
@@ -1863,15 +2105,19 @@ void PipeManager::destroy_object(const int& id) const {
 }
 
 void PipeManager::destroy_links(const std::vector<pw_proxy*>& list) const {
+  if (std::ranges::none_of(list, [](auto* proxy) { return proxy != nullptr; })) {
+    return;
+  }
+
+  lock();
+
   for (auto* proxy : list) {
     if (proxy != nullptr) {
-      lock();
-
       pw_proxy_destroy(proxy);
-
-      sync_wait_unlock();
     }
   }
+
+  sync_wait_unlock();
 }
 
 /*
@@ -50,6 +50,12 @@ struct _PipeManagerBox {
 
   GtkLabel *header_version, *library_version, *quantum, *max_quantum, *min_quantum, *server_rate;
 
+  GtkLabel *output_effects_quantum, *input_effects_quantum;
+
+  AdwActionRow *output_latency_row, *input_latency_row;
+
+  GtkLabel *output_latency_label, *input_latency_label;
+
   GtkSpinButton* spinbutton_test_signal_frequency;
 
   GListStore *input_devices_model, *output_devices_model, *modules_model, *clients_model, *autoloading_input_model,
@@ -103,6 +109,43 @@ void on_checkbutton_signal_gaussian(PipeManagerBox* self, GtkCheckButton* btn) {
   }
 }
 
+void on_measure_output_latency(PipeManagerBox* self, GtkButton* btn) {
+  const auto started = self->data->application->soe->start_latency_measurement(self->data->ts.get());
+
+  gtk_label_set_text(self->output_latency_label, started ? _("Measuring") : _("Unavailable"));
+}
+
+void on_measure_input_latency(PipeManagerBox* self, GtkButton* btn) {
+  const auto started = self->data->application->sie->start_latency_measurement(self->data->ts.get());
+
+  gtk_label_set_text(self->input_latency_label, started ? _("Measuring") : _("Unavailable"));
+}
+
+void show_latency_measurement(AdwActionRow* row, GtkLabel* label, const EffectsBase::LatencyMeasurement& result) {
+  if (!result.valid) {
+    gtk_label_set_text(label, _("Failed"));
+
+    adw_action_row_set_subtitle(row, "");
+
+    return;
+  }
+
+  gtk_label_set_text(label, fmt::format(ui::get_user_locale(), "{0:.1Lf} ms", result.total).c_str());
+
+  // the plugins whose reported latency is wrong are listed below the reported total
+
+  auto subtitle = fmt::format(ui::get_user_locale(), "{0} {1:.1Lf} ms", _("Reported"), result.reported_total);
+
+  for (const auto& stage : result.stages) {
+    if (stage.mismatch) {
+      subtitle += fmt::format(ui::get_user_locale(), "\n{0}: {1:.1Lf} ms ({2} {3:.1Lf} ms)", stage.name, stage.measured,
+                              _("reported"), stage.reported);
+    }
+  }
+
+  adw_action_row_set_subtitle(row, subtitle.c_str());
+}
+
 void on_autoloading_add_input_profile(PipeManagerBox* self, GtkButton* btn) {
   auto* holder = static_cast<ui::holders::NodeInfoHolder*>(
       gtk_drop_down_get_selected_item(self->dropdown_autoloading_input_devices));
@@ -392,6 +435,26 @@ void setup_dropdown_presets(PipeManagerBox* self) {
   g_object_unref(selection);
 }
 
+// the quantum the chain really runs with. The requested one is shown next to it when the graph did not honor it
+
+void set_effects_quantum_label(GtkLabel* label, const EffectsBase* effects) {
+  const auto negotiated = effects->get_negotiated_quantum();
+  const auto requested = effects->get_requested_quantum();
+
+  std::string text;
+
+  if (negotiated == 0U) {
+    text = (requested != 0U) ? fmt::format(ui::get_user_locale(), fmt::runtime(_("{0} Requested")), requested)
+                             : _("Default");
+  } else if (requested == 0U || requested == negotiated) {
+    text = util::to_string(negotiated);
+  } else {
+    text = fmt::format(ui::get_user_locale(), fmt::runtime(_("{0} ({1} Requested)")), negotiated, requested);
+  }
+
+  gtk_label_set_text(label, text.c_str());
+}
+
 void setup_dropdown_devices(PipeManagerBox* self, GtkDropDown* dropdown, GListStore* model) {
   auto* selection = gtk_single_selection_new(G_LIST_MODEL(model));
 
@@ -440,6 +503,31 @@ void setup(PipeManagerBox* self, app::Application* application) {
   gtk_label_set_text(self->max_quantum, pm->default_max_quantum.c_str());
   gtk_label_set_text(self->quantum, pm->default_quantum.c_str());
 
+  set_effects_quantum_label(self->output_effects_quantum, application->soe);
+  set_effects_quantum_label(self->input_effects_quantum, application->sie);
+
+  self->data->connections.push_back(application->soe->quantum_request.connect(
+      [=](const uint& quantum) { set_effects_quantum_label(self->output_effects_quantum, application->soe); }));
+
+  self->data->connections.push_back(application->soe->quantum_negotiated.connect(
+      [=](const uint& quantum) { set_effects_quantum_label(self->output_effects_quantum, application->soe); }));
+
+  self->data->connections.push_back(application->sie->quantum_request.connect(
+      [=](const uint& quantum) { set_effects_quantum_label(self->input_effects_quantum, application->sie); }));
+
+  self->data->connections.push_back(application->sie->quantum_negotiated.connect(
+      [=](const uint& quantum) { set_effects_quantum_label(self->input_effects_quantum, application->sie); }));
+
+  self->data->connections.push_back(
+      application->soe->latency_measured.connect([=](const EffectsBase::LatencyMeasurement& result) {
+        show_latency_measurement(self->output_latency_row, self->output_latency_label, result);
+      }));
+
+  self->data->connections.push_back(
+      application->sie->latency_measured.connect([=](const EffectsBase::LatencyMeasurement& result) {
+        show_latency_measurement(self->input_latency_row, self->input_latency_label, result);
+      }));
+
   setup_listview_modules(self);
   setup_listview_clients(self);
 
@@ -780,6 +868,11 @@ void setup(PipeManagerBox* self, app::Application* application) {
 void dispose(GObject* object) {
   auto* self = EE_PIPE_MANAGER_BOX(object);
 
+  // our test signals generator is destroyed with us
+
+  self->data->application->soe->cancel_latency_measurement();
+  self->data->application->sie->cancel_latency_measurement();
+
   for (auto& c : self->data->connections) {
     c.disconnect();
   }
@@ -847,11 +940,19 @@ void pipe_manager_box_class_init(PipeManagerBoxClass* klass) {
   gtk_widget_class_bind_template_child(widget_class, PipeManagerBox, quantum);
   gtk_widget_class_bind_template_child(widget_class, PipeManagerBox, max_quantum);
   gtk_widget_class_bind_template_child(widget_class, PipeManagerBox, min_quantum);
+  gtk_widget_class_bind_template_child(widget_class, PipeManagerBox, output_effects_quantum);
+  gtk_widget_class_bind_template_child(widget_class, PipeManagerBox, input_effects_quantum);
   gtk_widget_class_bind_template_child(widget_class, PipeManagerBox, server_rate);
 
   gtk_widget_class_bind_template_child(widget_class, PipeManagerBox, spinbutton_test_signal_frequency);
+  gtk_widget_class_bind_template_child(widget_class, PipeManagerBox, output_latency_row);
+  gtk_widget_class_bind_template_child(widget_class, PipeManagerBox, input_latency_row);
+  gtk_widget_class_bind_template_child(widget_class, PipeManagerBox, output_latency_label);
+  gtk_widget_class_bind_template_child(widget_class, PipeManagerBox, input_latency_label);
 
   gtk_widget_class_bind_template_callback(widget_class, on_enable_test_signal);
+  gtk_widget_class_bind_template_callback(widget_class, on_measure_output_latency);
+  gtk_widget_class_bind_template_callback(widget_class, on_measure_input_latency);
   gtk_widget_class_bind_template_callback(widget_class, on_checkbutton_channel_left);
   gtk_widget_class_bind_template_callback(widget_class, on_checkbutton_channel_right);
   gtk_widget_class_bind_template_callback(widget_class, on_checkbutton_channel_both);
@@ -24,17 +24,19 @@ Pitch::Pitch(const std::string& tag,
              const std::string& schema_path,
              PipeManager* pipe_manager)
     : PluginBase(tag, tags::plugin_name::pitch, tags::plugin_package::sound_touch, schema, schema_path, pipe_manager) {
-  quick_seek = g_settings_get_boolean(settings, "quick-seek") != 0;
-  anti_alias = g_settings_get_boolean(settings, "anti-alias") != 0;
+  params.update([&](Params& p) {
+    p.quick_seek = g_settings_get_boolean(settings, "quick-seek") != 0;
+    p.anti_alias = g_settings_get_boolean(settings, "anti-alias") != 0;
 
-  sequence_length_ms = g_settings_get_int(settings, "sequence-length");
-  seek_window_ms = g_settings_get_int(settings, "seek-window");
-  overlap_length_ms = g_settings_get_int(settings, "overlap-length");
+    p.sequence_length_ms = g_settings_get_int(settings, "sequence-length");
+    p.seek_window_ms = g_settings_get_int(settings, "seek-window");
+    p.overlap_length_ms = g_settings_get_int(settings, "overlap-length");
 
-  tempo_difference = g_settings_get_double(settings, "tempo-difference");
-  rate_difference = g_settings_get_double(settings, "rate-difference");
+    p.tempo_difference = g_settings_get_double(settings, "tempo-difference");
+    p.rate_difference = g_settings_get_double(settings, "rate-difference");
 
-  semitones = g_settings_get_double(settings, "semitones");
+    p.semitones = g_settings_get_double(settings, "semitones");
+  });
 
   // resetting soundtouch when bypass is pressed so its internal data is discarded
 
@@ -64,13 +66,11 @@ Pitch::Pitch(const std::string& tag,
                                           G_CALLBACK(+[](GSettings* settings, char* key, gpointer user_data) {
                                             auto* self = static_cast<Pitch*>(user_data);
 
-                                            self->quick_seek = g_settings_get_boolean(settings, key) != 0;
+                                            const auto v = g_settings_get_boolean(settings, key) != 0;
 
-                                            if (!self->soundtouch_ready) {
-                                              return;
-                                            }
+                                            self->params.update([&](Params& p) { p.quick_seek = v; });
 
-                                            self->set_quick_seek();
+                                            self->apply_settings();
                                           }),
                                           this));
 
@@ -78,13 +78,11 @@ Pitch::Pitch(const std::string& tag,
                                           G_CALLBACK(+[](GSettings* settings, char* key, gpointer user_data) {
                                             auto* self = static_cast<Pitch*>(user_data);
 
-                                            self->anti_alias = g_settings_get_boolean(settings, key) != 0;
+                                            const auto v = g_settings_get_boolean(settings, key) != 0;
 
-                                            if (!self->soundtouch_ready) {
-                                              return;
-                                            }
+                                            self->params.update([&](Params& p) { p.anti_alias = v; });
 
-                                            self->set_quick_seek();
+                                            self->apply_settings();
                                           }),
                                           this));
 
@@ -92,13 +90,11 @@ Pitch::Pitch(const std::string& tag,
                                           G_CALLBACK(+[](GSettings* settings, char* key, gpointer user_data) {
                                             auto* self = static_cast<Pitch*>(user_data);
 
-                                            self->sequence_length_ms = g_settings_get_int(settings, key);
+                                            const auto v = g_settings_get_int(settings, key);
 
-                                            if (!self->soundtouch_ready) {
-                                              return;
-                                            }
+                                            self->params.update([&](Params& p) { p.sequence_length_ms = v; });
 
-                                            self->set_sequence_length();
+                                            self->apply_settings();
                                           }),
                                           this));
 
@@ -106,13 +102,11 @@ Pitch::Pitch(const std::string& tag,
                                           G_CALLBACK(+[](GSettings* settings, char* key, gpointer user_data) {
                                             auto* self = static_cast<Pitch*>(user_data);
 
-                                            self->seek_window_ms = g_settings_get_int(settings, key);
+                                            const auto v = g_settings_get_int(settings, key);
 
-                                            if (!self->soundtouch_ready) {
-                                              return;
-                                            }
+                                            self->params.update([&](Params& p) { p.seek_window_ms = v; });
 
-                                            self->set_seek_window();
+                                            self->apply_settings();
                                           }),
                                           this));
 
@@ -120,13 +114,11 @@ Pitch::Pitch(const std::string& tag,
                                           G_CALLBACK(+[](GSettings* settings, char* key, gpointer user_data) {
                                             auto* self = static_cast<Pitch*>(user_data);
 
-                                            self->overlap_length_ms = g_settings_get_int(settings, key);
+                                            const auto v = g_settings_get_int(settings, key);
 
-                                            if (!self->soundtouch_ready) {
-                                              return;
-                                            }
+                                            self->params.update([&](Params& p) { p.overlap_length_ms = v; });
 
-                                            self->set_overlap_length();
+                                            self->apply_settings();
                                           }),
                                           this));
 
@@ -134,13 +126,11 @@ Pitch::Pitch(const std::string& tag,
                                           G_CALLBACK(+[](GSettings* settings, char* key, gpointer user_data) {
                                             auto* self = static_cast<Pitch*>(user_data);
 
-                                            self->tempo_difference = g_settings_get_double(settings, key);
+                                            const auto v = g_settings_get_double(settings, key);
 
-                                            if (!self->soundtouch_ready) {
-                                              return;
-                                            }
+                                            self->params.update([&](Params& p) { p.tempo_difference = v; });
 
-                                            self->set_tempo_difference();
+                                            self->apply_settings();
                                           }),
                                           this));
 
@@ -148,13 +138,11 @@ Pitch::Pitch(const std::string& tag,
                                           G_CALLBACK(+[](GSettings* settings, char* key, gpointer user_data) {
                                             auto* self = static_cast<Pitch*>(user_data);
 
-                                            self->rate_difference = g_settings_get_double(settings, key);
+                                            const auto v = g_settings_get_double(settings, key);
 
-                                            if (!self->soundtouch_ready) {
-                                              return;
-                                            }
+                                            self->params.update([&](Params& p) { p.rate_difference = v; });
 
-                                            self->set_rate_difference();
+                                            self->apply_settings();
                                           }),
                                           this));
 
@@ -162,13 +150,11 @@ Pitch::Pitch(const std::string& tag,
                                           G_CALLBACK(+[](GSettings* settings, char* key, gpointer user_data) {
                                             auto* self = static_cast<Pitch*>(user_data);
 
-                                            self->semitones = g_settings_get_double(settings, key);
+                                            const auto v = g_settings_get_double(settings, key);
 
-                                            if (!self->soundtouch_ready) {
-                                              return;
-                                            }
+                                            self->params.update([&](Params& p) { p.semitones = v; });
 
-                                            self->set_semitones();
+                                            self->apply_settings();
                                           }),
                                           this));
 
@@ -192,8 +178,15 @@ void Pitch::setup() {
     data.resize(2U * static_cast<size_t>(n_samples));
   }
 
-  deque_out_L.resize(0U);
-  deque_out_R.resize(0U);
+  data_L.resize(n_samples);
+  data_R.resize(n_samples);
+
+  /*
+    SoundTouch gives its output in bursts of about one sequence length. One second of room is more than enough to hold
+    them. If the tempo is lower than 1 the output grows faster than we consume it and the excess is discarded.
+  */
+
+  output_ring.resize(n_samples + rate);
 
   util::idle_add([&, this] {
     if (soundtouch_ready) {
@@ -212,23 +205,23 @@ void Pitch::process(std::span<float>& left_in,
                     std::span<float>& right_in,
                     std::span<float>& left_out,
                     std::span<float>& right_out) {
-  std::scoped_lock<std::mutex> lock(data_mutex);
+  /*
+    The mutex is only held by the main thread while soundtouch is being replaced. We do not wait for it. The audio is
+    passed through while that happens.
+  */
+
+  std::unique_lock<std::mutex> lock(data_mutex, std::try_to_lock);
 
-  if (bypass || !soundtouch_ready) {
+  if (!lock.owns_lock() || bypass || !soundtouch_ready) {
     std::copy(left_in.begin(), left_in.end(), left_out.begin());
     std::copy(right_in.begin(), right_in.end(), right_out.begin());
 
     return;
   }
 
-  if (input_gain != 1.0F) {
-    apply_gain(left_in, right_in, input_gain);
-  }
+  apply_input_gain(left_in, right_in);
 
-  for (size_t n = 0U; n < left_in.size(); n++) {
-    data[n * 2U] = left_in[n];
-    data[n * 2U + 1U] = right_in[n];
-  }
+  dsp::interleave(left_in, right_in, data);
 
   snd_touch->putSamples(data.data(), n_samples);
 
@@ -237,157 +230,62 @@ void Pitch::process(std::span<float>& left_in,
   do {
     n_received = snd_touch->receiveSamples(data.data(), n_samples);
 
-    for (size_t n = 0U; n < n_received; n++) {
-      deque_out_L.push_back(data[n * 2U]);
-      deque_out_R.push_back(data[n * 2U + 1U]);
-    }
+    dsp::deinterleave(std::span(data).first(2U * n_received), data_L, data_R);
 
+    output_ring.push(std::span(data_L).first(n_received), std::span(data_R).first(n_received));
   } while (n_received != 0);
 
-  if (deque_out_L.size() >= left_out.size()) {
-    for (float& v : left_out) {
-      v = deque_out_L.front();
+  // the latency reported is the size of the last gap we had to fill with silence
 
-      deque_out_L.pop_front();
-    }
+  if (const auto padded = output_ring.pop_or_pad(left_out, right_out); padded != 0U && padded != latency_n_frames) {
+    latency_n_frames = padded;
 
-    for (float& v : right_out) {
-      v = deque_out_R.front();
-
-      deque_out_R.pop_front();
-    }
-  } else {
-    const uint offset = left_out.size() - deque_out_L.size();
-
-    if (offset != latency_n_frames) {
-      latency_n_frames = offset;
-
-      notify_latency = true;
-    }
-
-    for (uint n = 0U; !deque_out_L.empty() && n < left_out.size(); n++) {
-      if (n < offset) {
-        left_out[n] = 0.0F;
-        right_out[n] = 0.0F;
-      } else {
-        left_out[n] = deque_out_L.front();
-        right_out[n] = deque_out_R.front();
-
-        deque_out_R.pop_front();
-        deque_out_L.pop_front();
-      }
-    }
+    notify_latency = true;
   }
 
-  if (output_gain != 1.0F) {
-    apply_gain(left_out, right_out, output_gain);
-  }
+  apply_output_gain(left_out, right_out);
 
   if (notify_latency) {
     latency_value = static_cast<float>(latency_n_frames) / static_cast<float>(rate);
 
     util::debug(log_tag + name + " latency: " + util::to_string(latency_value, "") + " s");
 
-    util::idle_add([=, this]() {
-      if (!post_messages || latency.empty()) {
-        return;
-      }
-
-      latency.emit();
-    });
+    notify_latency_change();
 
     update_filter_params();
 
     notify_latency = false;
   }
 
-  if (post_messages) {
-    get_peaks(left_in, right_in, left_out, right_out);
-
-    if (send_notifications) {
-      notify();
-    }
+  if (post_messages && send_notifications) {
+    notify();
   }
 }
 
-void Pitch::set_semitones() {
-  if (snd_touch == nullptr) {
-    return;
-  }
+void Pitch::apply_settings() {
+  /*
+    SoundTouch reallocates its buffers when some of these values change. So they are applied here in the main thread.
+    process() does not wait for the mutex and passes the audio through while we hold it.
+  */
 
   std::scoped_lock<std::mutex> lock(data_mutex);
 
-  snd_touch->setPitchSemiTones(semitones);
-}
-
-void Pitch::set_sequence_length() {
-  if (snd_touch == nullptr) {
-    return;
+  if (snd_touch != nullptr) {
+    apply_params(params.get());
   }
-
-  std::scoped_lock<std::mutex> lock(data_mutex);
-
-  snd_touch->setSetting(SETTING_SEQUENCE_MS, sequence_length_ms);
 }
 
-void Pitch::set_seek_window() {
-  if (snd_touch == nullptr) {
-    return;
-  }
+void Pitch::apply_params(const Params& p) {
+  snd_touch->setPitchSemiTones(p.semitones);
 
-  std::scoped_lock<std::mutex> lock(data_mutex);
+  snd_touch->setSetting(SETTING_USE_QUICKSEEK, static_cast<int>(p.quick_seek));
+  snd_touch->setSetting(SETTING_USE_AA_FILTER, static_cast<int>(p.anti_alias));
+  snd_touch->setSetting(SETTING_SEQUENCE_MS, p.sequence_length_ms);
+  snd_touch->setSetting(SETTING_SEEKWINDOW_MS, p.seek_window_ms);
+  snd_touch->setSetting(SETTING_OVERLAP_MS, p.overlap_length_ms);
 
-  snd_touch->setSetting(SETTING_SEEKWINDOW_MS, seek_window_ms);
-}
-
-void Pitch::set_overlap_length() {
-  if (snd_touch == nullptr) {
-    return;
-  }
-
-  std::scoped_lock<std::mutex> lock(data_mutex);
-
-  snd_touch->setSetting(SETTING_OVERLAP_MS, overlap_length_ms);
-}
-
-void Pitch::set_quick_seek() {
-  if (snd_touch == nullptr) {
-    return;
-  }
-
-  std::scoped_lock<std::mutex> lock(data_mutex);
-
-  snd_touch->setSetting(SETTING_USE_QUICKSEEK, static_cast<int>(quick_seek));
-}
-
-void Pitch::set_anti_alias() {
-  if (snd_touch == nullptr) {
-    return;
-  }
-
-  std::scoped_lock<std::mutex> lock(data_mutex);
-
-  snd_touch->setSetting(SETTING_USE_AA_FILTER, static_cast<int>(anti_alias));
-}
-
-void Pitch::set_tempo_difference() {
-  if (snd_touch == nullptr) {
-    return;
-  }
-
-  std::scoped_lock<std::mutex> lock(data_mutex);
-
-  snd_touch->setTempoChange(tempo_difference);
-}
-
-void Pitch::set_rate_difference() {
-  if (snd_touch == nullptr) {
-    return;
-  }
-
-  std::scoped_lock<std::mutex> lock(data_mutex);
-
-  snd_touch->setRateChange(rate_difference);
+  snd_touch->setTempoChange(p.tempo_difference);
+  snd_touch->setRateChange(p.rate_difference);
 }
 
 void Pitch::init_soundtouch() {
@@ -398,14 +296,12 @@ void Pitch::init_soundtouch() {
   snd_touch->setSampleRate(rate);
   snd_touch->setChannels(2);
 
-  set_semitones();
-  set_quick_seek();
-  set_anti_alias();
-  set_sequence_length();
-  set_seek_window();
-  set_overlap_length();
-  set_tempo_difference();
-  set_rate_difference();
+  /*
+    The realtime thread can not see this instance yet. So it is safe to configure it here. Later changes are applied by
+    apply_settings().
+  */
+
+  apply_params(params.get());
 }
 
 auto Pitch::get_latency_seconds() -> float {
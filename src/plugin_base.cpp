@@ -21,36 +21,66 @@
 
 namespace {
 
-void on_process(void* userdata, spa_io_position* position) {
-  auto* d = static_cast<PluginBase::data*>(userdata);
+std::vector<PluginBase*> notification_sources;
 
-  const auto n_samples = position->clock.duration;
-  const auto rate = position->clock.rate.denom;
+guint notification_timer = 0U;
 
-  if (n_samples == 0 || rate == 0) {
+/*
+  Plugins are created and destroyed by worker threads too. The drain holds this lock while it dispatches so that no
+  plugin is freed in the middle of its dispatch. It is recursive because a signal handler running inside the drain may
+  destroy plugins on the main thread.
+*/
+
+std::recursive_mutex notification_mutex;
+
+constexpr guint notification_timer_interval = 16U;  // milliseconds
+
+void register_notification_source(PluginBase* plugin) {
+  std::scoped_lock<std::recursive_mutex> lock(notification_mutex);
+
+  notification_sources.push_back(plugin);
+
+  if (notification_timer != 0U) {
     return;
   }
 
-  if (rate != d->pb->rate || n_samples != d->pb->n_samples) {
-    d->pb->rate = rate;
-    d->pb->n_samples = n_samples;
+  notification_timer = g_timeout_add(notification_timer_interval, GSourceFunc(+[](gpointer user_data) {
+                                       std::scoped_lock<std::recursive_mutex> lock(notification_mutex);
+
+                                       // a signal handler may destroy plugins. So we do not hold iterators here
 
-    d->pb->dummy_left.resize(n_samples);
-    d->pb->dummy_right.resize(n_samples);
+                                       for (size_t n = 0U; n < notification_sources.size(); n++) {
+                                         notification_sources[n]->dispatch_notifications();
+                                       }
 
-    std::ranges::fill(d->pb->dummy_left, 0.0F);
-    std::ranges::fill(d->pb->dummy_right, 0.0F);
+                                       return G_SOURCE_CONTINUE;
+                                     }),
+                                     nullptr);
+}
+
+void unregister_notification_source(PluginBase* plugin) {
+  std::scoped_lock<std::recursive_mutex> lock(notification_mutex);
 
-    d->pb->clock_start = std::chrono::system_clock::now();
+  std::erase(notification_sources, plugin);
 
-    d->pb->setup();
+  if (notification_sources.empty() && notification_timer != 0U) {
+    g_source_remove(notification_timer);
+
+    notification_timer = 0U;
   }
+}
 
-  d->pb->delta_t = 0.001F * static_cast<float>(std::chrono::duration_cast<std::chrono::milliseconds>(
-                                                   std::chrono::system_clock::now() - d->pb->clock_start)
-                                                   .count());
+void on_process(void* userdata, spa_io_position* position) {
+  auto* d = static_cast<PluginBase::data*>(userdata);
+
+  const auto n_samples = position->clock.duration;
+  const auto rate = position->clock.rate.denom;
 
-  d->pb->send_notifications = d->pb->delta_t >= d->pb->notification_time_window;
+  if (n_samples == 0 || rate == 0) {
+    return;
+  }
+
+  d->pb->begin_quantum(n_samples, rate, position->clock.position);
 
   // util::warning("processing: " + util::to_string(n_samples));
 
@@ -89,8 +119,14 @@ void on_process(void* userdata, spa_io_position* position) {
     right_out = d->pb->dummy_right;
   }
 
+  d->pb->probe_latency(left_in, right_in, false);
+
+  const auto process_start = std::chrono::steady_clock::now();
+
   if (!d->pb->enable_probe) {
-    d->pb->process(left_in, right_in, left_out, right_out);
+    if (!d->pb->skip_silent_quantum(left_in, right_in, left_out, right_out)) {
+      d->pb->process(left_in, right_in, left_out, right_out);
+    }
   } else {
     auto* probe_left = static_cast<float*>(pw_filter_get_dsp_buffer(d->probe_left, n_samples));
     auto* probe_right = static_cast<float*>(pw_filter_get_dsp_buffer(d->probe_right, n_samples));
@@ -108,11 +144,11 @@ void on_process(void* userdata, spa_io_position* position) {
     }
   }
 
-  if (d->pb->send_notifications) {
-    d->pb->clock_start = std::chrono::system_clock::now();
+  d->pb->record_dsp_load(std::chrono::steady_clock::now() - process_start);
 
-    d->pb->send_notifications = false;
-  }
+  d->pb->probe_latency(left_out, right_out, true);
+
+  d->pb->end_quantum();
 }
 
 auto update_filter(struct spa_loop* loop, bool async, uint32_t seq, const void* data, size_t size, void* user_data)
@@ -139,31 +175,53 @@ auto update_filter(struct spa_loop* loop, bool async, uint32_t seq, const void*
 void on_filter_state_changed(void* userdata, pw_filter_state old, pw_filter_state state, const char* error) {
   auto* d = static_cast<PluginBase::data*>(userdata);
 
-  d->pb->state = state;
-
-  switch (state) {
-    case PW_FILTER_STATE_ERROR:
-      d->pb->can_get_node_id = false;
-      break;
-    case PW_FILTER_STATE_UNCONNECTED:
-      d->pb->can_get_node_id = false;
-      break;
-    case PW_FILTER_STATE_CONNECTING:
-      d->pb->can_get_node_id = false;
-      break;
-    case PW_FILTER_STATE_STREAMING:
-      d->pb->can_get_node_id = true;
-      break;
-    case PW_FILTER_STATE_PAUSED:
-      d->pb->can_get_node_id = true;
-      break;
-    default:
-      break;
-  }
+  // connect_to_pw() may be waiting for this state
+
+  d->pm->update_graph([&] {
+    d->pb->state = state;
+
+    switch (state) {
+      case PW_FILTER_STATE_ERROR:
+        d->pb->can_get_node_id = false;
+        break;
+      case PW_FILTER_STATE_UNCONNECTED:
+        d->pb->can_get_node_id = false;
+        break;
+      case PW_FILTER_STATE_CONNECTING:
+        d->pb->can_get_node_id = false;
+        break;
+      case PW_FILTER_STATE_STREAMING:
+        d->pb->can_get_node_id = true;
+        break;
+      case PW_FILTER_STATE_PAUSED:
+        d->pb->can_get_node_id = true;
+        break;
+      default:
+        break;
+    }
+  });
 }
 
 const struct pw_filter_events filter_events = {.state_changed = on_filter_state_changed, .process = on_process};
 
+void gain_and_peak(std::span<float> data, const float& gain, const bool& measure_peak, float& peak) {
+  if (gain == 1.0F) {
+    if (measure_peak) {
+      peak = std::max(peak, dsp::abs_peak(data));
+    }
+
+    return;
+  }
+
+  if (!measure_peak) {
+    dsp::apply_gain(data, gain);
+
+    return;
+  }
+
+  peak = std::max(peak, dsp::apply_gain_abs_peak(data, gain));
+}
+
 }  // namespace
 
 PluginBase::PluginBase(std::string tag,
@@ -181,7 +239,7 @@ PluginBase::PluginBase(std::string tag,
       pm(pipe_manager) {
   std::string description;
 
-  if (name != "output_level" && name != "spectrum") {
+  if (name != "output_level" && name != "spectrum" && name != "fused_chain") {
     description = tags::plugin_name::get_translated()[name];
 
     bypass = g_settings_get_boolean(settings, "bypass") != 0;
@@ -197,9 +255,23 @@ PluginBase::PluginBase(std::string tag,
     description = _("Output Level Meter");
   } else if (name == "spectrum") {
     description = _("Spectrum");
+  } else if (name == "fused_chain") {
+    description = _("Fused Effects Chain");
   }
 
   pf_data.pb = this;
+  pf_data.pm = pm;
+
+  /*
+    Without a PipeManager there is no PipeWire filter. The plugin is then driven directly through process_quantum().
+    This is how the offline tools use it.
+  */
+
+  if (pm == nullptr) {
+    register_notification_source(this);
+
+    return;
+  }
 
   const auto filter_name = "ee_" + log_tag.substr(0U, log_tag.size() - 2U) + "_" + name;
 
@@ -289,20 +361,28 @@ PluginBase::PluginBase(std::string tag,
   }
 
   pm->sync_wait_unlock();
+
+  register_notification_source(this);
 }
 
 PluginBase::~PluginBase() {
   post_messages = false;
 
-  pm->lock();
+  // a no-op for the subclasses that already called stop_notifications() in their destructors
 
-  if (listener.link.next != nullptr || listener.link.prev != nullptr) {
-    spa_hook_remove(&listener);
-  }
+  unregister_notification_source(this);
 
-  pw_filter_destroy(filter);
+  if (filter != nullptr) {
+    pm->lock();
 
-  pm->sync_wait_unlock();
+    if (listener.link.next != nullptr || listener.link.prev != nullptr) {
+      spa_hook_remove(&listener);
+    }
+
+    pw_filter_destroy(filter);
+
+    pm->sync_wait_unlock();
+  }
 
   for (auto& handler_id : gconnections) {
     g_signal_handler_disconnect(settings, handler_id);
@@ -322,9 +402,19 @@ void PluginBase::reset_settings() {
 }
 
 auto PluginBase::connect_to_pw() -> bool {
-  connected_to_pw = false;
-  can_get_node_id = false;
-  state = PW_FILTER_STATE_UNCONNECTED;
+  return start_connect_to_pw() && wait_connected_to_pw();
+}
+
+auto PluginBase::start_connect_to_pw() -> bool {
+  if (filter == nullptr) {
+    return false;
+  }
+
+  pm->update_graph([&] {
+    connected_to_pw = false;
+    can_get_node_id = false;
+    state = PW_FILTER_STATE_UNCONNECTED;
+  });
 
   pm->lock();
 
@@ -338,31 +428,41 @@ auto PluginBase::connect_to_pw() -> bool {
 
   initialize_listener();
 
-  pm->sync_wait_unlock();
+  pm->unlock();
+
+  return true;
+}
 
-  while (!can_get_node_id) {
-    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+auto PluginBase::wait_connected_to_pw() -> bool {
+  using namespace std::chrono_literals;
 
-    if (state == PW_FILTER_STATE_ERROR) {
-      util::warning(log_tag + name + " is in an error");
+  if (filter == nullptr) {
+    return false;
+  }
 
-      return false;
-    }
+  const auto has_state = pm->wait_for_graph([&] { return can_get_node_id || state == PW_FILTER_STATE_ERROR; }, 10s);
+
+  if (!has_state || state == PW_FILTER_STATE_ERROR) {
+    util::warning(log_tag + name + (has_state ? " is in an error" : " is taking too long to connect to PipeWire"));
+
+    return false;
   }
 
   pm->lock();
 
   node_id = pw_filter_get_node_id(filter);
 
-  pm->sync_wait_unlock();
+  pm->unlock();
 
   /*
     The filter we link in our pipeline have at least 4 ports. Some have six. Before we try to link filters we have to
-    wait until the information about their ports is available in PipeManager's list_ports vector.
+    wait until the information about their ports is available in PipeManager's port registry.
   */
 
-  while (pm->count_node_ports(node_id) != n_ports) {
-    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  if (!pm->wait_for_graph([&] { return pm->ports.count(node_id) == n_ports; }, 10s)) {
+    util::warning(log_tag + name + " ports are taking too long to be available");
+
+    return false;
   }
 
   connected_to_pw = true;
@@ -381,6 +481,10 @@ auto PluginBase::get_node_id() const -> uint {
 }
 
 void PluginBase::set_active(const bool& state) const {
+  if (filter == nullptr) {
+    return;
+  }
+
   pw_filter_set_active(filter, state);
 }
 
@@ -403,8 +507,95 @@ void PluginBase::disconnect_from_pw() {
   node_id = SPA_ID_INVALID;
 }
 
+void PluginBase::begin_quantum(const uint& n_samples, const uint& rate, const uint64_t& position) {
+  clock_position = position;
+
+  if (rate != this->rate || n_samples != this->n_samples) {
+    this->rate = rate;
+    this->n_samples = n_samples;
+
+    dummy_left.resize(n_samples);
+    dummy_right.resize(n_samples);
+
+    std::ranges::fill(dummy_left, 0.0F);
+    std::ranges::fill(dummy_right, 0.0F);
+
+    clock_start = std::chrono::system_clock::now();
+
+    changed_quantum = n_samples;
+
+    setup();
+  }
+
+  if (reset_requested.exchange(false)) {
+    clear_state();
+  }
+
+  const auto elapsed = std::chrono::system_clock::now() - clock_start;
+
+  delta_t = 0.001F * static_cast<float>(std::chrono::duration_cast<std::chrono::milliseconds>(elapsed).count());
+
+  send_notifications = delta_t >= notification_time_window;
+}
+
+void PluginBase::end_quantum() {
+  if (send_notifications) {
+    clock_start = std::chrono::system_clock::now();
+
+    send_notifications = false;
+  }
+}
+
+void PluginBase::process_quantum(std::span<float>& left_in,
+                                 std::span<float>& right_in,
+                                 std::span<float>& left_out,
+                                 std::span<float>& right_out,
+                                 const uint& rate,
+                                 const uint64_t& position) {
+  begin_quantum(left_in.size(), rate, position);
+
+  const auto process_start = std::chrono::steady_clock::now();
+
+  if (!enable_probe) {
+    if (!skip_silent_quantum(left_in, right_in, left_out, right_out)) {
+      process(left_in, right_in, left_out, right_out);
+    }
+  } else {
+    std::span l(dummy_left.data(), n_samples);
+    std::span r(dummy_right.data(), n_samples);
+
+    process(left_in, right_in, left_out, right_out, l, r);
+  }
+
+  record_dsp_load(std::chrono::steady_clock::now() - process_start);
+
+  end_quantum();
+}
+
 void PluginBase::setup() {}
 
+void PluginBase::wait_for_setup() {}
+
+void PluginBase::reset() {
+  if (lv2_wrapper != nullptr) {
+    lv2_wrapper->reset();
+  }
+
+  // nothing was set up if the instance never processed a quantum
+
+  if (rate != 0U && n_samples != 0U) {
+    setup();
+  }
+
+  reset_requested = true;
+}
+
+void PluginBase::clear_state() {
+  silent_frames = 0U;
+
+  suspended_by_silence = false;
+}
+
 void PluginBase::process(std::span<float>& left_in,
                          std::span<float>& right_in,
                          std::span<float>& left_out,
@@ -458,16 +649,16 @@ void PluginBase::get_peaks(const std::span<float>& left_in,
 
   // input level
 
-  float peak_l = std::ranges::max(left_in);
-  float peak_r = std::ranges::max(right_in);
+  float peak_l = dsp::abs_peak(left_in);
+  float peak_r = dsp::abs_peak(right_in);
 
   input_peak_left = (peak_l > input_peak_left) ? peak_l : input_peak_left;
   input_peak_right = (peak_r > input_peak_right) ? peak_r : input_peak_right;
 
   // output level
 
-  peak_l = std::ranges::max(left_out);
-  peak_r = std::ranges::max(right_out);
+  peak_l = dsp::abs_peak(left_out);
+  peak_r = dsp::abs_peak(right_out);
 
   output_peak_left = (peak_l > output_peak_left) ? peak_l : output_peak_left;
   output_peak_right = (peak_r > output_peak_right) ? peak_r : output_peak_right;
@@ -493,24 +684,211 @@ void PluginBase::setup_input_output_gain() {
                    this);
 }
 
+void PluginBase::apply_input_gain(std::span<float>& left, std::span<float>& right) {
+  gain_and_peak(left, input_gain, post_messages, input_peak_left);
+  gain_and_peak(right, input_gain, post_messages, input_peak_right);
+}
+
+void PluginBase::apply_output_gain(std::span<float>& left, std::span<float>& right) {
+  gain_and_peak(left, output_gain, post_messages, output_peak_left);
+  gain_and_peak(right, output_gain, post_messages, output_peak_right);
+}
+
+void PluginBase::passthrough(const std::span<float>& left_in,
+                             const std::span<float>& right_in,
+                             std::span<float>& left_out,
+                             std::span<float>& right_out) {
+  if (left_in.data() != left_out.data()) {
+    std::copy(left_in.begin(), left_in.end(), left_out.begin());
+  }
+
+  if (right_in.data() != right_out.data()) {
+    std::copy(right_in.begin(), right_in.end(), right_out.begin());
+  }
+}
+
+auto PluginBase::can_process_in_place() const -> bool {
+  return lv2_wrapper != nullptr && lv2_wrapper->found_plugin && !lv2_wrapper->is_in_place_broken();
+}
+
+auto PluginBase::needs_power_of_2_blocks() const -> bool {
+  return false;
+}
+
+auto PluginBase::is_silence_stable() const -> bool {
+  return false;
+}
+
+auto PluginBase::get_tail_seconds() -> float {
+  return 0.0F;
+}
+
+auto PluginBase::skip_silent_quantum(const std::span<float>& left_in,
+                                     const std::span<float>& right_in,
+                                     std::span<float>& left_out,
+                                     std::span<float>& right_out) -> bool {
+  if (bypass || !is_silence_stable() || dsp::abs_peak(left_in) != 0.0F || dsp::abs_peak(right_in) != 0.0F) {
+    silent_frames = 0U;
+
+    suspended_by_silence = false;
+
+    return false;
+  }
+
+  if (!suspended_by_silence) {
+    silent_frames += static_cast<uint>(left_in.size());
+
+    // one extra quantum for the delays that are smaller than the reported latency
+
+    const auto tail = (latency_value + get_tail_seconds()) * static_cast<float>(rate) + static_cast<float>(n_samples);
+
+    if (static_cast<float>(silent_frames) < tail) {
+      return false;
+    }
+
+    suspended_by_silence = true;
+  }
+
+  std::ranges::fill(left_out, 0.0F);
+  std::ranges::fill(right_out, 0.0F);
+
+  // the peaks were reset by the last notification. Sending a new one drops the meters to silence
+
+  if (post_messages && send_notifications) {
+    notify();
+  }
+
+  return true;
+}
+
+void PluginBase::arm_latency_probe(const size_t& capacity, const bool& silence_output) {
+  disarm_latency_probe();
+
+  latency_probe.input.assign(capacity, 0.0F);
+  latency_probe.output.assign(capacity, 0.0F);
+
+  latency_probe.input_count = 0U;
+  latency_probe.output_count = 0U;
+  latency_probe.input_started = false;
+  latency_probe.output_started = false;
+
+  latency_probe.silence_output = silence_output;
+
+  latency_probe.armed = true;
+}
+
+void PluginBase::disarm_latency_probe() {
+  latency_probe.armed = false;
+
+  // the realtime thread sets writing before checking armed again. So once writing is false it will not touch the data
+
+  while (latency_probe.writing) {
+    std::this_thread::yield();
+  }
+}
+
+void PluginBase::probe_latency(const std::span<float>& left, const std::span<float>& right, const bool& output) {
+  if (!latency_probe.armed.load(std::memory_order_relaxed)) {
+    return;
+  }
+
+  latency_probe.writing = true;
+
+  if (!latency_probe.armed) {
+    latency_probe.writing = false;
+
+    return;
+  }
+
+  auto& buffer = output ? latency_probe.output : latency_probe.input;
+  auto& count = output ? latency_probe.output_count : latency_probe.input_count;
+  auto& start = output ? latency_probe.output_start : latency_probe.input_start;
+  auto& started = output ? latency_probe.output_started : latency_probe.input_started;
+
+  if (!started) {
+    start = clock_position;
+    started = true;
+  }
+
+  const auto offset = clock_position - start;
+
+  const auto n_frames = std::min(left.size(), right.size());
+
+  if (offset < buffer.size()) {
+    const auto n_copy = std::min(n_frames, static_cast<size_t>(buffer.size() - offset));
+
+    for (size_t n = 0U; n < n_copy; n++) {
+      buffer[offset + n] = 0.5F * (left[n] + right[n]);
+    }
+
+    count.store(offset + n_copy, std::memory_order_release);
+  }
+
+  if (output && latency_probe.silence_output) {
+    std::ranges::fill(left, 0.0F);
+    std::ranges::fill(right, 0.0F);
+  }
+
+  latency_probe.writing = false;
+}
+
+void PluginBase::record_dsp_load(const std::chrono::steady_clock::duration& elapsed) {
+  const auto elapsed_ns = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count());
+
+  const auto budget_ns = (rate != 0U) ? 1000000000ULL * n_samples / rate : 0U;
+
+  dsp_load.record(elapsed_ns, budget_ns);
+
+  if (dsp_cycle != nullptr) {
+    dsp_cycle->add(clock_position, elapsed_ns, budget_ns, &dsp_load);
+  }
+}
+
+void PluginBase::request_quantum(const uint& quantum, const uint& rate) {
+  if (quantum == requested_quantum || filter == nullptr) {
+    return;
+  }
+
+  requested_quantum = quantum;
+
+  const auto node_latency = util::to_string(quantum) + "/" + util::to_string(rate);
+
+  // a null value removes the property
+
+  const spa_dict_item item{.key = PW_KEY_NODE_LATENCY, .value = (quantum != 0U) ? node_latency.c_str() : nullptr};
+
+  const spa_dict dict{.flags = 0U, .n_items = 1U, .items = &item};
+
+  pm->lock();
+
+  pw_filter_update_properties(filter, nullptr, &dict);
+
+  pm->sync_wait_unlock();
+}
+
 void PluginBase::apply_gain(std::span<float>& left, std::span<float>& right, const float& gain) {
   if (left.empty() || right.empty()) {
     return;
   }
 
-  std::ranges::for_each(left, [&](auto& v) { v *= gain; });
-  std::ranges::for_each(right, [&](auto& v) { v *= gain; });
+  dsp::apply_gain(left, gain);
+  dsp::apply_gain(right, gain);
 }
 
 void PluginBase::notify() {
-  const auto input_peak_db_l = util::linear_to_db(input_peak_left);
-  const auto input_peak_db_r = util::linear_to_db(input_peak_right);
+  Notification n;
+
+  n.input_left = util::linear_to_db(input_peak_left);
+  n.input_right = util::linear_to_db(input_peak_right);
 
-  const auto output_peak_db_l = util::linear_to_db(output_peak_left);
-  const auto output_peak_db_r = util::linear_to_db(output_peak_right);
+  n.output_left = util::linear_to_db(output_peak_left);
+  n.output_right = util::linear_to_db(output_peak_right);
 
-  input_level.emit(input_peak_db_l, input_peak_db_r);
-  output_level.emit(output_peak_db_l, output_peak_db_r);
+  pack_meters(n.meters);
+
+  // if the main thread is not keeping up this record is dropped. The next one will have fresher values anyway
+
+  notifications.push(n);
 
   input_peak_left = util::minimum_linear_level;
   input_peak_right = util::minimum_linear_level;
@@ -518,8 +896,58 @@ void PluginBase::notify() {
   output_peak_right = util::minimum_linear_level;
 }
 
+void PluginBase::notify_latency_change() {
+  latency_changed = true;
+}
+
+void PluginBase::pack_meters(std::span<double> values) {}
+
+void PluginBase::emit_meters(std::span<const double> values) {}
+
+void PluginBase::stop_notifications() {
+  unregister_notification_source(this);
+}
+
+void PluginBase::dispatch_notifications() {
+  /*
+    Only the newest levels record matters for the widgets. Older ones that piled up between two timer calls are
+    discarded so each plugin updates its interface at most once per call.
+  */
+
+  bool levels_changed = false;
+
+  while (notifications.pop(last_notification)) {
+    levels_changed = true;
+  }
+
+  if (const auto quantum = changed_quantum.exchange(0U); quantum != 0U) {
+    negotiated_quantum.emit(quantum);
+  }
+
+  const auto new_latency = latency_changed.exchange(false);
+
+  if (!post_messages) {
+    return;
+  }
+
+  if (new_latency && !latency.empty()) {
+    latency.emit();
+  }
+
+  if (levels_changed) {
+    input_level.emit(last_notification.input_left, last_notification.input_right);
+    output_level.emit(last_notification.output_left, last_notification.output_right);
+
+    emit_meters(last_notification.meters);
+  }
+}
+
 void PluginBase::update_probe_links() {}
 
 void PluginBase::update_filter_params() {
+  if (filter == nullptr) {
+    return;
+  }
+
   pw_loop_invoke(pw_thread_loop_get_loop(pm->thread_loop), update_filter, 1, nullptr, 0, false, this);
 }
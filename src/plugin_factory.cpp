@@ -0,0 +1,126 @@
+/*
+ *  Copyright © 2017-2023 Wellington Wallace
+ *
+ *  This file is part of Easy Effects.
+ *
+ *  Easy Effects is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Easy Effects is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Easy Effects. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "plugin_factory.hpp"
+#include "autogain.hpp"
+#include "bass_enhancer.hpp"
+#include "bass_loudness.hpp"
+#include "compressor.hpp"
+#include "convolver.hpp"
+#include "crossfeed.hpp"
+#include "crystalizer.hpp"
+#include "deepfilternet.hpp"
+#include "deesser.hpp"
+#include "delay.hpp"
+#include "echo_canceller.hpp"
+#include "equalizer.hpp"
+#include "exciter.hpp"
+#include "expander.hpp"
+#include "filter.hpp"
+#include "gate.hpp"
+#include "level_meter.hpp"
+#include "limiter.hpp"
+#include "loudness.hpp"
+#include "maximizer.hpp"
+#include "multiband_compressor.hpp"
+#include "multiband_gate.hpp"
+#include "pitch.hpp"
+#include "reverb.hpp"
+#include "rnnoise.hpp"
+#include "speex.hpp"
+#include "stereo_tools.hpp"
+#include "tags_schema.hpp"
+
+namespace plugin_factory {
+
+auto create(const std::string& name,
+            const std::string& log_tag,
+            const std::string& schema_base_path,
+            PipeManager* pm) -> std::shared_ptr<PluginBase> {
+  auto instance_id = util::to_string(tags::plugin_name::get_id(name));
+
+  auto path = schema_base_path + tags::plugin_name::get_base_name(name) + "/" + instance_id + "/";
+
+  path.erase(std::remove(path.begin(), path.end(), '_'), path.end());
+
+  std::shared_ptr<PluginBase> filter;
+
+  if (name.starts_with(tags::plugin_name::autogain)) {
+    filter = std::make_shared<AutoGain>(log_tag, tags::schema::autogain::id, path, pm);
+  } else if (name.starts_with(tags::plugin_name::bass_enhancer)) {
+    filter = std::make_shared<BassEnhancer>(log_tag, tags::schema::bass_enhancer::id, path, pm);
+  } else if (name.starts_with(tags::plugin_name::bass_loudness)) {
+    filter = std::make_shared<BassLoudness>(log_tag, tags::schema::bass_loudness::id, path, pm);
+  } else if (name.starts_with(tags::plugin_name::compressor)) {
+    filter = std::make_shared<Compressor>(log_tag, tags::schema::compressor::id, path, pm);
+  } else if (name.starts_with(tags::plugin_name::convolver)) {
+    filter = std::make_shared<Convolver>(log_tag, tags::schema::convolver::id, path, pm);
+  } else if (name.starts_with(tags::plugin_name::crossfeed)) {
+    filter = std::make_shared<Crossfeed>(log_tag, tags::schema::crossfeed::id, path, pm);
+  } else if (name.starts_with(tags::plugin_name::crystalizer)) {
+    filter = std::make_shared<Crystalizer>(log_tag, tags::schema::crystalizer::id, path, pm);
+  } else if (name.starts_with(tags::plugin_name::deepfilternet)) {
+    filter = std::make_shared<DeepFilterNet>(log_tag, tags::schema::deepfilternet::id, path, pm);
+  } else if (name.starts_with(tags::plugin_name::deesser)) {
+    filter = std::make_shared<Deesser>(log_tag, tags::schema::deesser::id, path, pm);
+  } else if (name.starts_with(tags::plugin_name::delay)) {
+    filter = std::make_shared<Delay>(log_tag, tags::schema::delay::id, path, pm);
+  } else if (name.starts_with(tags::plugin_name::echo_canceller)) {
+    filter = std::make_shared<EchoCanceller>(log_tag, tags::schema::echo_canceller::id, path, pm);
+  } else if (name.starts_with(tags::plugin_name::exciter)) {
+    filter = std::make_shared<Exciter>(log_tag, tags::schema::exciter::id, path, pm);
+  } else if (name.starts_with(tags::plugin_name::expander)) {
+    filter = std::make_shared<Expander>(log_tag, tags::schema::expander::id, path, pm);
+  } else if (name.starts_with(tags::plugin_name::equalizer)) {
+    filter =
+        std::make_shared<Equalizer>(log_tag, tags::schema::equalizer::id, path, tags::schema::equalizer::channel_id,
+                                    schema_base_path + "equalizer/" + instance_id + "/leftchannel/",
+                                    schema_base_path + "equalizer/" + instance_id + "/rightchannel/", pm);
+  } else if (name.starts_with(tags::plugin_name::filter)) {
+    filter = std::make_shared<Filter>(log_tag, tags::schema::filter::id, path, pm);
+  } else if (name.starts_with(tags::plugin_name::gate)) {
+    filter = std::make_shared<Gate>(log_tag, tags::schema::gate::id, path, pm);
+  } else if (name.starts_with(tags::plugin_name::level_meter)) {
+    filter = std::make_shared<LevelMeter>(log_tag, tags::schema::level_meter::id, path, pm);
+  } else if (name.starts_with(tags::plugin_name::limiter)) {
+    filter = std::make_shared<Limiter>(log_tag, tags::schema::limiter::id, path, pm);
+  } else if (name.starts_with(tags::plugin_name::loudness)) {
+    filter = std::make_shared<Loudness>(log_tag, tags::schema::loudness::id, path, pm);
+  } else if (name.starts_with(tags::plugin_name::maximizer)) {
+    filter = std::make_shared<Maximizer>(log_tag, tags::schema::maximizer::id, path, pm);
+  } else if (name.starts_with(tags::plugin_name::multiband_compressor)) {
+    filter = std::make_shared<MultibandCompressor>(log_tag, tags::schema::multiband_compressor::id, path, pm);
+  } else if (name.starts_with(tags::plugin_name::multiband_gate)) {
+    filter = std::make_shared<MultibandGate>(log_tag, tags::schema::multiband_gate::id, path, pm);
+  } else if (name.starts_with(tags::plugin_name::pitch)) {
+    filter = std::make_shared<Pitch>(log_tag, tags::schema::pitch::id, path, pm);
+  } else if (name.starts_with(tags::plugin_name::reverb)) {
+    filter = std::make_shared<Reverb>(log_tag, tags::schema::reverb::id, path, pm);
+  } else if (name.starts_with(tags::plugin_name::rnnoise)) {
+    filter = std::make_shared<RNNoise>(log_tag, tags::schema::rnnoise::id, path, pm);
+  } else if (name.starts_with(tags::plugin_name::speex)) {
+    filter = std::make_shared<Speex>(log_tag, tags::schema::speex::id, path, pm);
+  } else if (name.starts_with(tags::plugin_name::stereo_tools)) {
+    filter = std::make_shared<StereoTools>(log_tag, tags::schema::stereo_tools::id, path, pm);
+  }
+
+  return filter;
+}
+
+}  // namespace plugin_factory
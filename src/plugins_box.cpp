@@ -476,6 +476,38 @@ void add_plugins_to_stack(PluginsBox* self) {
   }
 }
 
+struct LoadLabel {
+  PluginsBox* self;
+
+  GtkLabel* label;
+
+  std::string name;
+};
+
+void update_load_label(const LoadLabel& d) {
+  auto* effects_base = (d.self->data->pipeline_type == PipelineType::input)
+                           ? static_cast<EffectsBase*>(d.self->data->application->sie)
+                           : static_cast<EffectsBase*>(d.self->data->application->soe);
+
+  const auto s = effects_base->get_dsp_load(d.name);
+
+  if (s.count == 0U) {
+    gtk_label_set_text(d.label, "");
+
+    gtk_widget_set_tooltip_text(GTK_WIDGET(d.label), nullptr);
+
+    return;
+  }
+
+  gtk_label_set_text(d.label, fmt::format(ui::get_user_locale(), "{0:.1Lf}%", s.load).c_str());
+
+  gtk_widget_set_tooltip_text(
+      GTK_WIDGET(d.label),
+      fmt::format(ui::get_user_locale(), "{0}: {1:.0Lf} µs\n{2}: {3:.0Lf} µs\n{4}: {5:.0Lf} µs\n{6}: {7:Ld}", _("Mean"),
+                  s.mean, _("99th Percentile"), s.p99, _("Maximum"), s.max, _("Overruns"), s.overruns)
+          .c_str());
+}
+
 void setup_listview(PluginsBox* self) {
   auto* factory = gtk_signal_list_item_factory_new();
 
@@ -494,6 +526,7 @@ void setup_listview(PluginsBox* self) {
         g_object_set_data(G_OBJECT(item), "top_box", top_box);
         g_object_set_data(G_OBJECT(item), "plugin_icon", plugin_icon);
         g_object_set_data(G_OBJECT(item), "name", gtk_builder_get_object(builder, "name"));
+        g_object_set_data(G_OBJECT(item), "load", gtk_builder_get_object(builder, "load"));
         g_object_set_data(G_OBJECT(item), "remove", remove);
         g_object_set_data(G_OBJECT(item), "enable", enable);
         g_object_set_data(G_OBJECT(item), "drag_handle", drag_handle);
@@ -657,9 +690,38 @@ void setup_listview(PluginsBox* self) {
         gsettings_bind_widget(settings, "bypass", enable, G_SETTINGS_BIND_INVERT_BOOLEAN);
 
         g_object_unref(settings);
+
+        // the DSP load shown in the row is refreshed every second until the row is unbound
+
+        auto* load_label = new LoadLabel{.self = self,
+                                         .label = static_cast<GtkLabel*>(g_object_get_data(G_OBJECT(item), "load")),
+                                         .name = page_name};
+
+        update_load_label(*load_label);
+
+        const auto timer = g_timeout_add_seconds_full(
+            G_PRIORITY_DEFAULT, 1U, GSourceFunc(+[](gpointer user_data) {
+              update_load_label(*static_cast<LoadLabel*>(user_data));
+
+              return G_SOURCE_CONTINUE;
+            }),
+            load_label, +[](gpointer user_data) { delete static_cast<LoadLabel*>(user_data); });
+
+        g_object_set_data(G_OBJECT(item), "load-timer", GUINT_TO_POINTER(timer));
       }),
       self);
 
+  g_signal_connect(factory, "unbind",
+                   G_CALLBACK(+[](GtkSignalListItemFactory* factory, GtkListItem* item, PluginsBox* self) {
+                     if (const auto timer = GPOINTER_TO_UINT(g_object_get_data(G_OBJECT(item), "load-timer"));
+                         timer != 0U) {
+                       g_source_remove(timer);
+
+                       g_object_set_data(G_OBJECT(item), "load-timer", nullptr);
+                     }
+                   }),
+                   self);
+
   gtk_list_view_set_factory(self->listview, factory);
 
   g_object_unref(factory);
@@ -387,138 +387,68 @@ void PresetsManager::remove(const PresetType& preset_type, const std::string& na
 }
 
 auto PresetsManager::load_preset_file(const PresetType& preset_type, const std::string& name) -> bool {
-  nlohmann::json json;
-
-  std::vector<std::string> plugins;
-
-  std::vector<std::filesystem::path> conf_dirs;
+  const auto& user_dir = (preset_type == PresetType::output) ? user_output_dir : user_input_dir;
 
-  std::filesystem::path input_file;
+  const auto input_file = user_dir / std::filesystem::path{name + json_ext};
 
-  auto preset_found = false;
+  if (!std::filesystem::exists(input_file)) {
+    util::debug("can't find the preset " + name + " on the filesystem");
 
-  // Load the plugin order based on the input/output pipeline.
-  switch (preset_type) {
-    case PresetType::output: {
-      conf_dirs.push_back(user_output_dir);
+    return false;
+  }
 
-      for (const auto& dir : conf_dirs) {
-        input_file = dir / std::filesystem::path{name + json_ext};
+  return load_preset_from_path(preset_type, input_file);
+}
 
-        if (std::filesystem::exists(input_file)) {
-          preset_found = true;
+auto PresetsManager::load_preset_from_path(const PresetType& preset_type, const std::filesystem::path& input_file)
+    -> bool {
+  nlohmann::json json;
 
-          break;
-        }
-      }
+  std::vector<std::string> plugins;
 
-      if (preset_found) {
-        try {
-          std::ifstream is(input_file);
+  const auto* section = (preset_type == PresetType::output) ? "output" : "input";
 
-          is >> json;
+  // Load the plugin order based on the input/output pipeline.
 
-          for (const auto& p : json.at("output").at("plugins_order").get<std::vector<std::string>>()) {
-            for (const auto& v : tags::plugin_name::list) {
-              if (p.starts_with(v)) {
-                /*
-                  Old format presets do not have the instance id number in the filter names. They are equal to the
-                  base name.
-                */
-
-                if (p != v) {
-                  plugins.push_back(p);
-                } else {
-                  plugins.push_back(p + "#0");
-                }
-
-                break;
-              }
-            }
+  try {
+    std::ifstream is(input_file);
+
+    is >> json;
+
+    for (const auto& p : json.at(section).at("plugins_order").get<std::vector<std::string>>()) {
+      for (const auto& v : tags::plugin_name::list) {
+        if (p.starts_with(v)) {
+          /*
+            Old format presets do not have the instance id number in the filter names. They are equal to the base
+            name.
+          */
+
+          if (p != v) {
+            plugins.push_back(p);
+          } else {
+            plugins.push_back(p + "#0");
           }
 
-        } catch (const nlohmann::json::exception& e) {
-          notify_error(PresetError::pipeline_format);
-
-          util::warning(e.what());
-
-          return false;
-        } catch (...) {
-          notify_error(PresetError::pipeline_generic);
-
-          return false;
-        }
-
-        g_settings_set_strv(soe_settings, "plugins", util::make_gchar_pointer_vector(plugins).data());
-      } else {
-        util::debug("can't find the preset " + name + " on the filesystem");
-
-        return false;
-      }
-
-      break;
-    }
-    case PresetType::input: {
-      conf_dirs.push_back(user_input_dir);
-
-      for (const auto& dir : conf_dirs) {
-        input_file = dir / std::filesystem::path{name + json_ext};
-
-        if (std::filesystem::exists(input_file)) {
-          preset_found = true;
-
           break;
         }
       }
+    }
 
-      if (preset_found) {
-        try {
-          std::ifstream is(input_file);
-
-          is >> json;
-
-          for (const auto& p : json.at("input").at("plugins_order").get<std::vector<std::string>>()) {
-            for (const auto& v : tags::plugin_name::list) {
-              if (p.starts_with(v)) {
-                /*
-                  Old format presets do not have the instance id number in the filter names. They are equal to the
-                  base name.
-                */
-
-                if (p != v) {
-                  plugins.push_back(p);
-                } else {
-                  plugins.push_back(p + "#0");
-                }
-
-                break;
-              }
-            }
-          }
-
-        } catch (const nlohmann::json::exception& e) {
-          notify_error(PresetError::pipeline_format);
-
-          util::warning(e.what());
-
-          return false;
-        } catch (...) {
-          notify_error(PresetError::pipeline_generic);
-
-          return false;
-        }
+  } catch (const nlohmann::json::exception& e) {
+    notify_error(PresetError::pipeline_format);
 
-        g_settings_set_strv(sie_settings, "plugins", util::make_gchar_pointer_vector(plugins).data());
-      } else {
-        util::debug("can't find the preset " + name + " on the filesystem");
+    util::warning(e.what());
 
-        return false;
-      }
+    return false;
+  } catch (...) {
+    notify_error(PresetError::pipeline_generic);
 
-      break;
-    }
+    return false;
   }
 
+  g_settings_set_strv((preset_type == PresetType::output) ? soe_settings : sie_settings, "plugins",
+                      util::make_gchar_pointer_vector(plugins).data());
+
   // After the plugin order list, load the blocklist and then apply the parameters of the loaded plugins.
   if (load_blocklist(preset_type, json) && read_plugins_preset(preset_type, plugins, json)) {
     util::debug("successfully loaded preset: " + input_file.string());
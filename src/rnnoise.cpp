@@ -24,39 +24,26 @@ RNNoise::RNNoise(const std::string& tag,
                  const std::string& schema_path,
                  PipeManager* pipe_manager)
     : PluginBase(tag, tags::plugin_name::rnnoise, tags::plugin_package::rnnoise, schema, schema_path, pipe_manager),
-      enable_vad(g_settings_get_boolean(settings, "enable-vad")),
-      vad_thres(g_settings_get_double(settings, "vad-thres") / 100.0F),
-      data_L(0),
-      data_R(0) {
-  data_L.reserve(blocksize);
-  data_R.reserve(blocksize);
+      data_L(blocksize),
+      data_R(blocksize) {
   data_tmp.reserve(blocksize);
 
-  const auto key_v = g_settings_get_double(settings, "wet");
+  params.update([&](Params& p) {
+    p.enable_vad = g_settings_get_boolean(settings, "enable-vad") != 0;
 
-  wet_ratio = (key_v <= util::minimum_db_d_level) ? 0.0F : static_cast<float>(util::db_to_linear(key_v));
+    p.vad_thres = static_cast<float>(g_settings_get_double(settings, "vad-thres")) / 100.0F;
+
+    const auto key_v = g_settings_get_double(settings, "wet");
+
+    p.wet_ratio = (key_v <= util::minimum_db_d_level) ? 0.0F : static_cast<float>(util::db_to_linear(key_v));
+  });
 
   gconnections.push_back(g_signal_connect(settings, "changed::model-path",
                                           G_CALLBACK(+[](GSettings* settings, char* key, gpointer user_data) {
                                             auto* self = static_cast<RNNoise*>(user_data);
 
-                                            self->data_mutex.lock();
-
-                                            self->rnnoise_ready = false;
-
-                                            self->data_mutex.unlock();
-
 #ifdef ENABLE_RNNOISE
-                                            self->free_rnnoise();
-
-                                            auto* m = self->get_model_from_file();
-
-                                            self->model = m;
-
-                                            self->state_left = rnnoise_create(self->model);
-                                            self->state_right = rnnoise_create(self->model);
-
-                                            self->rnnoise_ready = true;
+                                            self->load_model();
 #endif
                                           }),
                                           this));
@@ -68,52 +55,60 @@ RNNoise::RNNoise(const std::string& tag,
   init_release();
 
   gconnections.push_back(g_signal_connect(settings, "changed::enable-vad",
-                                          G_CALLBACK(+[](GSettings* settings, char* key, RNNoise* self) {
-                                            self->enable_vad = g_settings_get_boolean(settings, key);
+                                          G_CALLBACK(+[](GSettings* settings, char* key, gpointer user_data) {
+                                            auto* self = static_cast<RNNoise*>(user_data);
+
+                                            const auto v = g_settings_get_boolean(settings, key) != 0;
+
+                                            self->params.update([&](Params& p) { p.enable_vad = v; });
                                           }),
                                           this));
 
-  g_signal_connect(settings, "changed::vad-thres", G_CALLBACK(+[](GSettings* settings, char* key, gpointer user_data) {
-                     auto self = static_cast<RNNoise*>(user_data);
+  gconnections.push_back(g_signal_connect(settings, "changed::vad-thres",
+                                          G_CALLBACK(+[](GSettings* settings, char* key, gpointer user_data) {
+                                            auto* self = static_cast<RNNoise*>(user_data);
 
-                     self->vad_thres = static_cast<float>(g_settings_get_double(settings, key)) / 100.0F;
-                   }),
-                   this);
+                                            const auto v = static_cast<float>(g_settings_get_double(settings, key));
 
-  g_signal_connect(settings, "changed::wet", G_CALLBACK(+[](GSettings* settings, char* key, gpointer user_data) {
-                     auto self = static_cast<RNNoise*>(user_data);
+                                            self->params.update([&](Params& p) { p.vad_thres = v / 100.0F; });
+                                          }),
+                                          this));
 
-                     const auto key_v = g_settings_get_double(settings, key);
+  gconnections.push_back(g_signal_connect(
+      settings, "changed::wet", G_CALLBACK(+[](GSettings* settings, char* key, gpointer user_data) {
+        auto* self = static_cast<RNNoise*>(user_data);
 
-                     self->wet_ratio =
-                         (key_v <= util::minimum_db_d_level) ? 0.0F : static_cast<float>(util::db_to_linear(key_v));
-                   }),
-                   this);
+        const auto key_v = g_settings_get_double(settings, key);
 
-  g_signal_connect(settings, "changed::release", G_CALLBACK(+[](GSettings* settings, char* key, gpointer user_data) {
-                     auto self = static_cast<RNNoise*>(user_data);
+        const auto v = (key_v <= util::minimum_db_d_level) ? 0.0F : static_cast<float>(util::db_to_linear(key_v));
 
-                     self->init_release();
-                   }),
-                   this);
+        self->params.update([&](Params& p) { p.wet_ratio = v; });
+      }),
+      this));
 
-  auto* m = get_model_from_file();
+  gconnections.push_back(g_signal_connect(settings, "changed::release",
+                                          G_CALLBACK(+[](GSettings* settings, char* key, gpointer user_data) {
+                                            auto* self = static_cast<RNNoise*>(user_data);
+
+                                            self->init_release();
+                                          }),
+                                          this));
 
-  model = m;
+  model = get_model_from_file();
 
   state_left = rnnoise_create(model);
   state_right = rnnoise_create(model);
 
   vad_prob_left = 1.0F;
   vad_prob_right = 1.0F;
-  vad_grace_left = release;
-  vad_grace_right = release;
+  vad_grace_left = params.get().release;
+  vad_grace_right = params.get().release;
 
   rnnoise_ready = true;
 #else
   util::warning("The RNNoise library was not available at compilation time. The noise reduction filter won't work");
 
-  enable_vad = false;
+  params.update([&](Params& p) { p.enable_vad = false; });
 #endif
 }
 
@@ -133,20 +128,28 @@ RNNoise::~RNNoise() {
   util::debug(log_tag + name + " destroyed");
 }
 
-void RNNoise::setup() {
-  std::scoped_lock<std::mutex> lock(data_mutex);
+// setup() and process() run in the same thread. The mutex only protects the model and its states
 
+void RNNoise::setup() {
   resampler_ready = false;
 
   latency_n_frames = 0U;
 
   resample = rate != rnnoise_rate;
 
-  data_L.resize(0U);
-  data_R.resize(0U);
+  /*
+    Room for two quanta at the rnnoise rate plus one rnnoise block. It is more than the resamplers can give us in one
+    process call.
+  */
 
-  deque_out_L.resize(0U);
-  deque_out_R.resize(0U);
+  const auto max_frames = 2U * (std::max(n_samples, n_samples * rnnoise_rate / rate) + blocksize);
+
+  input_ring.resize(max_frames);
+  denoised_ring.resize(max_frames);
+  output_ring.resize(max_frames);
+
+  resampled_data_L.reserve(max_frames);
+  resampled_data_R.reserve(max_frames);
 
   resampler_inL = std::make_unique<Resampler>(rate, rnnoise_rate);
   resampler_inR = std::make_unique<Resampler>(rate, rnnoise_rate);
@@ -161,119 +164,71 @@ void RNNoise::process(std::span<float>& left_in,
                       std::span<float>& right_in,
                       std::span<float>& left_out,
                       std::span<float>& right_out) {
-  std::scoped_lock<std::mutex> lock(data_mutex);
+  /*
+    The mutex is only held by the main thread while the model and the states are swapped. We do not wait for it. The
+    audio is passed through while that happens.
+  */
+
+  std::unique_lock<std::mutex> lock(data_mutex, std::try_to_lock);
 
-  if (bypass || !rnnoise_ready) {
+  if (!lock.owns_lock() || bypass || !rnnoise_ready) {
     std::copy(left_in.begin(), left_in.end(), left_out.begin());
     std::copy(right_in.begin(), right_in.end(), right_out.begin());
 
     return;
   }
 
-  if (input_gain != 1.0F) {
-    apply_gain(left_in, right_in, input_gain);
-  }
+  apply_input_gain(left_in, right_in);
 
   if (resample) {
     if (resampler_ready) {
-      const auto resampled_inL = resampler_inL->process(left_in, false);
-      const auto resampled_inR = resampler_inR->process(right_in, false);
-
-      resampled_data_L.resize(0U);
-      resampled_data_R.resize(0U);
+      const auto& resampled_inL = resampler_inL->process(left_in, false);
+      const auto& resampled_inR = resampler_inR->process(right_in, false);
 
 #ifdef ENABLE_RNNOISE
-      remove_noise(resampled_inL, resampled_inR, resampled_data_L, resampled_data_R);
+      remove_noise(resampled_inL, resampled_inR, denoised_ring, *params.read());
 #endif
 
-      auto resampled_outL = resampler_outL->process(resampled_data_L, false);
-      auto resampled_outR = resampler_outR->process(resampled_data_R, false);
+      resampled_data_L.resize(denoised_ring.size());
+      resampled_data_R.resize(denoised_ring.size());
 
-      for (const auto& v : resampled_outL) {
-        deque_out_L.push_back(v);
-      }
+      denoised_ring.pop(resampled_data_L, resampled_data_R);
 
-      for (const auto& v : resampled_outR) {
-        deque_out_R.push_back(v);
-      }
-    } else {
-      for (const auto& v : left_in) {
-        deque_out_L.push_back(v);
-      }
+      const auto& resampled_outL = resampler_outL->process(resampled_data_L, false);
+      const auto& resampled_outR = resampler_outR->process(resampled_data_R, false);
 
-      for (const auto& v : right_in) {
-        deque_out_R.push_back(v);
-      }
+      output_ring.push(resampled_outL, resampled_outR);
+    } else {
+      output_ring.push(left_in, right_in);
     }
   } else {
 #ifdef ENABLE_RNNOISE
-    remove_noise(left_in, right_in, deque_out_L, deque_out_R);
+    remove_noise(left_in, right_in, output_ring, *params.read());
 #endif
   }
 
-  if (deque_out_L.size() >= left_out.size()) {
-    for (float& v : left_out) {
-      v = deque_out_L.front();
+  if (const auto padded = output_ring.pop_or_pad(left_out, right_out); padded != 0U) {
+    latency_n_frames += padded;
 
-      deque_out_L.pop_front();
-    }
-
-    for (float& v : right_out) {
-      v = deque_out_R.front();
-
-      deque_out_R.pop_front();
-    }
-  } else {
-    const uint offset = 2U * (left_out.size() - deque_out_L.size());
-
-    if (offset != latency_n_frames) {
-      latency_n_frames = offset;
-
-      notify_latency = true;
-    }
-
-    for (uint n = 0U; !deque_out_L.empty() && n < left_out.size(); n++) {
-      if (n < offset) {
-        left_out[n] = 0.0F;
-        right_out[n] = 0.0F;
-      } else {
-        left_out[n] = deque_out_L.front();
-        right_out[n] = deque_out_R.front();
-
-        deque_out_R.pop_front();
-        deque_out_L.pop_front();
-      }
-    }
+    notify_latency = true;
   }
 
-  if (output_gain != 1.0F) {
-    apply_gain(left_out, right_out, output_gain);
-  }
+  apply_output_gain(left_out, right_out);
 
   if (notify_latency) {
     latency_value = static_cast<float>(latency_n_frames) / static_cast<float>(rate);
 
     util::debug(log_tag + name + " latency: " + util::to_string(latency_value, "") + " s");
 
-    util::idle_add([=, this]() {
-      if (!post_messages || latency.empty()) {
-        return;
-      }
-
-      latency.emit();
-    });
+    notify_latency_change();
 
     update_filter_params();
 
     notify_latency = false;
   }
 
-  if (post_messages) {
-    get_peaks(left_in, right_in, left_out, right_out);
-
-    if (send_notifications) {
-      notify();
-    }
+  if (post_messages && send_notifications) {
+    notify();
   }
 }
 
@@ -315,6 +270,35 @@ auto RNNoise::get_model_from_file() -> RNNModel* {
   return m;
 }
 
+void RNNoise::load_model() {
+  // the new model and states are created before taking the lock. The old ones are destroyed after releasing it
+
+  auto* new_model = get_model_from_file();
+
+  auto* new_left = rnnoise_create(new_model);
+  auto* new_right = rnnoise_create(new_model);
+
+  {
+    std::scoped_lock<std::mutex> lock(data_mutex);
+
+    std::swap(model, new_model);
+    std::swap(state_left, new_left);
+    std::swap(state_right, new_right);
+  }
+
+  if (new_left != nullptr) {
+    rnnoise_destroy(new_left);
+  }
+
+  if (new_right != nullptr) {
+    rnnoise_destroy(new_right);
+  }
+
+  if (new_model != nullptr) {
+    rnnoise_model_free(new_model);
+  }
+}
+
 void RNNoise::free_rnnoise() {
   rnnoise_ready = false;
 
@@ -351,10 +335,21 @@ void RNNoise::init_release() {
   const auto bs = static_cast<double>(blocksize);
 
   // std::lrint returns a long type
-  const auto release = static_cast<int>(std::lrint(rate * key_v / 1000.0 / bs));
+  const auto v = static_cast<int>(std::lrint(rate * key_v / 1000.0 / bs));
 
-  vad_grace_left = release;
-  vad_grace_right = release;
+  // the grace counters pick the new value the next time voice is detected
+
+  params.update([&](Params& p) { p.release = v; });
 
 #endif
 }
+
+auto RNNoise::is_silence_stable() const -> bool {
+  return true;
+}
+
+auto RNNoise::get_tail_seconds() -> float {
+  // one block inside the network state and one in the resamplers
+
+  return 2.0F * static_cast<float>(blocksize) / static_cast<float>(rnnoise_rate);
+}
@@ -25,7 +25,23 @@ Spectrum::Spectrum(const std::string& tag,
                    PipeManager* pipe_manager)
     : PluginBase(tag, "spectrum", tags::plugin_package::ee, schema, schema_path, pipe_manager), fftw_ready(true) {
   real_input.resize(n_bands);
-  output.resize(n_bands / 2U + 1U);
+  hann_window.resize(n_bands);
+  history.resize(n_bands);
+
+  /*
+    real_input size is hardcoded to 8192. The same maxium buffer size hardcoded in PipeWire
+    https://gitlab.freedesktop.org/pipewire/pipewire/-/blob/master/src/pipewire/filter.c#L48. So the realtime thread
+    never needs a bigger buffer for the downmix.
+  */
+
+  rt_mono.resize(n_bands);
+
+  // https://en.wikipedia.org/wiki/Hann_function
+
+  for (size_t n = 0U; n < hann_window.size(); n++) {
+    hann_window[n] = 0.5F * (1.0F - std::cos(2.0F * std::numbers::pi_v<float> * static_cast<float>(n) /
+                                             static_cast<float>(hann_window.size() - 1U)));
+  }
 
   complex_output = fftwf_alloc_complex(n_bands);
 
@@ -34,19 +50,27 @@ Spectrum::Spectrum(const std::string& tag,
   g_signal_connect(settings, "changed::show", G_CALLBACK(+[](GSettings* settings, char* key, gpointer user_data) {
                      auto* self = static_cast<Spectrum*>(user_data);
 
-                     std::scoped_lock<std::mutex> lock(self->data_mutex);
-
                      self->bypass = g_settings_get_boolean(settings, key) == 0;
                    }),
                    this);
+
+  analysis_thread = std::thread([this] { analysis_loop(); });
 }
 
 Spectrum::~Spectrum() {
+  stop_notifications();
+
   if (connected_to_pw) {
     disconnect_from_pw();
   }
 
-  std::scoped_lock<std::mutex> lock(data_mutex);
+  analysis_running = false;
+
+  wake_analysis();
+
+  if (analysis_thread.joinable()) {
+    analysis_thread.join();
+  }
 
   fftw_ready = false;
 
@@ -60,29 +84,13 @@ Spectrum::~Spectrum() {
 }
 
 void Spectrum::setup() {
-  deque_in_mono.resize(0U);
-
-  std::ranges::fill(real_input, 0.0F);
-
-  /*
-    real_input size is hardcoded to 8192. THe same maxium buffer size hardcoded in PipeWire
-    https://gitlab.freedesktop.org/pipewire/pipewire/-/blob/master/src/pipewire/filter.c#L48. If we reevei a smaller
-    array we have to insert some zeros in the beginning.
-  */
-
-  if (n_samples < real_input.size()) {
-    while (deque_in_mono.size() != real_input.size() - n_samples) {
-      deque_in_mono.push_back(0.0F);
-    }
-  }
+  analysis_rate = rate;
 }
 
 void Spectrum::process(std::span<float>& left_in,
                        std::span<float>& right_in,
                        std::span<float>& left_out,
                        std::span<float>& right_out) {
-  std::scoped_lock<std::mutex> lock(data_mutex);
-
   std::copy(left_in.begin(), left_in.end(), left_out.begin());
   std::copy(right_in.begin(), right_in.end(), right_out.begin());
 
@@ -90,48 +98,123 @@ void Spectrum::process(std::span<float>& left_in,
     return;
   }
 
-  for (uint n = 0U; n < left_in.size(); n++) {
-    deque_in_mono.push_back(0.5F * (left_in[n] + right_in[n]));
+  /*
+    Once the whole history is digital silence and one transform of it was requested the next ones would give the same
+    frame. So we stop feeding the analysis thread until the signal comes back.
+  */
+
+  if (dsp::abs_peak(left_in) == 0.0F && dsp::abs_peak(right_in) == 0.0F) {
+    if (suspended_by_silence) {
+      return;
+    }
+
+    silent_frames += static_cast<uint>(left_in.size());
+
+    suspended_by_silence = silent_frames > n_bands && send_notifications;
+  } else {
+    silent_frames = 0U;
+
+    suspended_by_silence = false;
   }
 
-  for (size_t n = 0; n < deque_in_mono.size(); n++) {
-    if (n < real_input.size()) {
-      // https :  // en.wikipedia.org/wiki/Hann_function
+  const auto count = std::min(left_in.size(), rt_mono.size());
 
-      const float w = 0.5F * (1.0F - std::cos(2.0F * std::numbers::pi_v<float> * static_cast<float>(n) /
-                                              static_cast<float>(real_input.size() - 1U)));
+  for (size_t n = 0U; n < count; n++) {
+    rt_mono[n] = 0.5F * (left_in[n] + right_in[n]);
+  }
 
-      real_input[n] = deque_in_mono[n] * w;
-    }
+  unannounced_samples += samples.push(std::span<const float>(rt_mono.data(), count));
+
+  if (send_notifications) {
+    analysis_requested = true;
   }
 
-  size_t count = 0U;
+  // the ring holds 2 * n_bands samples. Waking the analysis thread when half of it is used keeps it from filling
 
-  while (count < n_samples && !deque_in_mono.empty()) {
-    deque_in_mono.pop_front();
+  if (send_notifications || unannounced_samples >= n_bands) {
+    unannounced_samples = 0U;
 
-    count++;
+    wake_analysis();
+  }
+}
+
+void Spectrum::wake_analysis() {
+  if (!wake_pending.exchange(true)) {
+    analysis_wakeup.release();
+  }
+}
+
+void Spectrum::analysis_loop() {
+  /*
+    This is a normal priority thread. It sleeps until the realtime thread wakes it up. The transform is only done when
+    the meters have to be updated. The other wakeups only move the samples to the history.
+  */
+
+  std::vector<float> chunk(n_bands);
+
+  while (true) {
+    analysis_wakeup.acquire();
+
+    // cleared before the ring is read so the samples pushed from now on trigger a new wakeup
+
+    wake_pending = false;
+
+    if (!analysis_running) {
+      break;
+    }
+
+    for (auto count = samples.pop(chunk); count != 0U; count = samples.pop(chunk)) {
+      for (size_t n = 0U; n < count; n++) {
+        history[history_position] = chunk[n];
+
+        history_position = (history_position + 1U) % history.size();
+      }
+    }
+
+    if (analysis_requested.exchange(false)) {
+      analyze();
+    }
+  }
+}
+
+void Spectrum::analyze() {
+  // history is a circular buffer. Its oldest sample is the one at history_position
+
+  for (size_t n = 0U; n < real_input.size(); n++) {
+    real_input[n] = history[(history_position + n) % history.size()] * hann_window[n];
   }
 
   fftwf_execute(plan);
 
-  for (uint i = 0U; i < output.size(); i++) {
+  analysis_frame.rate = analysis_rate;
+
+  const auto n_outputs = analysis_frame.magnitudes.size();
+
+  for (size_t i = 0U; i < n_outputs; i++) {
     float sqr = complex_output[i][0] * complex_output[i][0] + complex_output[i][1] * complex_output[i][1];
 
-    sqr /= static_cast<float>(output.size() * output.size());
+    sqr /= static_cast<float>(n_outputs * n_outputs);
 
-    output[i] = static_cast<double>(sqr);
+    analysis_frame.magnitudes[i] = static_cast<double>(sqr);
   }
 
-  if (send_notifications) {
-    util::idle_add([=, this]() {
-      if (bypass) {
-        return;
-      }
+  frames.push(analysis_frame);
+}
+
+void Spectrum::dispatch_notifications() {
+  PluginBase::dispatch_notifications();
+
+  bool has_frame = false;
 
-      power.emit(rate, output.size(), output);
-    });
+  while (frames.pop(last_frame)) {
+    has_frame = true;
   }
+
+  if (!has_frame || bypass) {
+    return;
+  }
+
+  power.emit(last_frame.rate, last_frame.magnitudes.size(), last_frame.magnitudes);
 }
 
 auto Spectrum::get_latency_seconds() -> float {
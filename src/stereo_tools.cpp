@@ -126,9 +126,7 @@ void StereoTools::process(std::span<float>& left_in,
     return;
   }
 
-  if (input_gain != 1.0F) {
-    apply_gain(left_in, right_in, input_gain);
-  }
+  apply_input_gain(left_in, right_in);
 
   lv2_wrapper->connect_data_ports(left_in, right_in, left_out, right_out);
   lv2_wrapper->run();
@@ -139,19 +137,17 @@ void StereoTools::process(std::span<float>& left_in,
     right_out[n] = wet * right_out[n] + dry * right_in[n];
   }
 
-  if (output_gain != 1.0F) {
-    apply_gain(left_out, right_out, output_gain);
-  }
-
-  if (post_messages) {
-    get_peaks(left_in, right_in, left_out, right_out);
+  apply_output_gain(left_out, right_out);
 
-    if (send_notifications) {
-      notify();
-    }
+  if (post_messages && send_notifications) {
+    notify();
   }
 }
 
+auto StereoTools::can_process_in_place() const -> bool {
+  return false;  // the dry signal is mixed after the plugin runs
+}
+
 auto StereoTools::get_latency_seconds() -> float {
   return 0.0F;
 }
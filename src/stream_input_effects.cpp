@@ -91,6 +91,18 @@ StreamInputEffects::StreamInputEffects(PipeManager* pipe_manager)
                                           }),
                                           this));
 
+  gconnections_global.push_back(g_signal_connect(global_settings, "changed::use-fused-pipeline",
+                                                 G_CALLBACK(+[](GSettings* settings, char* key, gpointer user_data) {
+                                                   auto* self = static_cast<StreamInputEffects*>(user_data);
+
+                                                   if (g_settings_get_boolean(self->global_settings, "bypass") != 0) {
+                                                     return;  // the new mode is used when bypass is disabled
+                                                   }
+
+                                                   self->set_bypass(false);
+                                                 }),
+                                                 this));
+
   gconnections.push_back(g_signal_connect(settings, "changed::plugins",
                                           G_CALLBACK(+[](GSettings* settings, char* key, gpointer user_data) {
                                             auto* self = static_cast<StreamInputEffects*>(user_data);
@@ -101,7 +113,7 @@ StreamInputEffects::StreamInputEffects(PipeManager* pipe_manager)
                                               return;  // filter connected through update_bypass_state
                                             }
 
-                                            self->set_bypass(false);
+                                            self->update_chain();
                                           }),
                                           this));
 }
@@ -125,9 +137,8 @@ void StreamInputEffects::on_app_added(const NodeInfo node_info) {
 }
 
 auto StreamInputEffects::apps_want_to_play() -> bool {
-  return std::ranges::any_of(pm->list_links, [&](const auto& link) {
-    return (link.output_node_id == pm->ee_source_node.id) && (link.state == PW_LINK_STATE_ACTIVE);
-  });
+  return std::ranges::any_of(pm->links_from_node(pm->ee_source_node.id),
+                             [](const auto& link) { return link.state == PW_LINK_STATE_ACTIVE; });
 
   return false;
 }
@@ -152,7 +163,7 @@ void StreamInputEffects::on_link_changed(const LinkInfo link_info) {
   }
 
   if (apps_want_to_play()) {
-    if (list_proxies.empty()) {
+    if (chain_links.empty()) {
       util::debug("At least one app linked to our device wants to play. Linking our filters.");
 
       connect_filters();
@@ -164,7 +175,7 @@ void StreamInputEffects::on_link_changed(const LinkInfo link_info) {
       // if the timer is enabled, wait for the timeout, then unlink plugin pipeline
       int inactivity_timeout = g_settings_get_int(global_settings, "inactivity-timeout");
       g_timeout_add_seconds(inactivity_timeout, GSourceFunc(+[](StreamInputEffects* self) {
-                              if (!self->apps_want_to_play() && !self->list_proxies.empty()) {
+                              if (!self->apps_want_to_play() && !self->chain_links.empty()) {
                                 util::debug("No app linked to our device wants to play. Unlinking our filters.");
 
                                 self->disconnect_filters();
@@ -176,7 +187,7 @@ void StreamInputEffects::on_link_changed(const LinkInfo link_info) {
 
     } else {
       // otherwise, do nothing
-      if (!list_proxies.empty()) {
+      if (!chain_links.empty()) {
         util::debug("No app linked to our device wants to play, but the inactivity timer is disabled. Leaving filters linked.");
       };
     };
@@ -216,56 +227,24 @@ void StreamInputEffects::connect_filters(const bool& bypass) {
   const auto list =
       (bypass) ? std::vector<std::string>() : util::gchar_array_to_vector(g_settings_get_strv(settings, "plugins"));
 
-  auto mic_linked = false;
-
   // waiting for the input device ports information to be available.
 
-  int timeout = 0;
-
-  while (pm->count_node_ports(pm->input_device.id) < 1) {
-    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  const auto device_id = pm->input_device.id;
 
-    timeout++;
+  if (!pm->wait_for_graph([&] { return pm->ports.count(device_id) >= 1U; }, std::chrono::seconds(10))) {
+    util::warning("Information about the ports of the input device " + pm->input_device.name + " with id " +
+                  util::to_string(device_id) + " are taking to long to be available. Aborting the link");
 
-    if (timeout > 10000) {
-      util::warning("Information about the ports of the input device " + pm->input_device.name + " with id " +
-                    util::to_string(pm->input_device.id) + " are taking to long to be available. Aborting the link");
-
-      return;
-    }
+    return;
   }
 
-  uint prev_node_id = pm->input_device.id;
-  uint next_node_id = 0U;
+  std::vector<uint> node_ids = {pm->input_device.id};
+  std::vector<LinkEdge> probe_edges;
 
-  // link plugins
+  // plugins
 
   if (!list.empty()) {
-    for (const auto& name : list) {
-      if (!plugins.contains(name)) {
-        continue;
-      }
-
-      if (!plugins[name]->connected_to_pw ? plugins[name]->connect_to_pw() : true) {
-        next_node_id = plugins[name]->get_node_id();
-
-        const auto links = pm->link_nodes(prev_node_id, next_node_id);
-
-        for (auto* link : links) {
-          list_proxies.push_back(link);
-        }
-
-        if (mic_linked && (links.size() == 2U)) {
-          prev_node_id = next_node_id;
-        } else if (!mic_linked && (!links.empty())) {
-          prev_node_id = next_node_id;
-          mic_linked = true;
-        } else {
-          util::warning(" link from node " + util::to_string(prev_node_id) + " to node " +
-                        util::to_string(next_node_id) + " failed");
-        }
-      }
-    }
+    std::ranges::copy(prepare_chain_nodes(list), std::back_inserter(node_ids));
 
     // checking if we have to link the echo_canceller probe to the output device
 
@@ -276,9 +255,9 @@ void StreamInputEffects::connect_filters(const bool& bypass) {
 
       if (name.starts_with(tags::plugin_name::echo_canceller)) {
         if (plugins[name]->connected_to_pw) {
-          for (const auto& link : pm->link_nodes(pm->output_device.id, plugins[name]->get_node_id(), true)) {
-            list_proxies.push_back(link);
-          }
+          probe_edges.push_back({.output_node_id = pm->output_device.id,
+                                 .input_node_id = plugins[name]->get_node_id(),
+                                 .probe_link = true});
         }
       }
 
@@ -286,55 +265,44 @@ void StreamInputEffects::connect_filters(const bool& bypass) {
     }
   }
 
-  // link spectrum, output level meter and source node
+  // spectrum, output level meter and source node
 
-  for (const auto node_id : {spectrum->get_node_id(), output_level->get_node_id(), pm->ee_source_node.id}) {
-    next_node_id = node_id;
+  node_ids.push_back(spectrum->get_node_id());
+  node_ids.push_back(output_level->get_node_id());
+  node_ids.push_back(pm->ee_source_node.id);
 
-    const auto links = pm->link_nodes(prev_node_id, next_node_id);
+  // microphones may have a single channel
 
-    for (auto* link : links) {
-      list_proxies.push_back(link);
-    }
+  link_chain(node_ids, probe_edges, true);
 
-    if (mic_linked && (links.size() == 2U)) {
-      prev_node_id = next_node_id;
-    } else if (!mic_linked && (!links.empty())) {
-      prev_node_id = next_node_id;
-      mic_linked = true;
-    } else {
-      util::warning(" link from node " + util::to_string(prev_node_id) + " to node " + util::to_string(next_node_id) +
-                    " failed");
-    }
-  }
+  update_quantum_request(list);
 }
 
 void StreamInputEffects::disconnect_filters() {
   std::set<uint> link_id_list;
 
-  const auto selected_plugins_list =
-      (bypass) ? std::vector<std::string>() : util::gchar_array_to_vector(g_settings_get_strv(settings, "plugins"));
+  const auto list = util::gchar_array_to_vector(g_settings_get_strv(settings, "plugins"));
 
   for (const auto& plugin : plugins | std::views::values) {
-    for (const auto& link : pm->list_links) {
-      if (link.input_node_id == plugin->get_node_id() || link.output_node_id == plugin->get_node_id()) {
-        link_id_list.insert(link.id);
-      }
-    }
+    insert_node_links(link_id_list, plugin->get_node_id());
 
-    if (plugin->connected_to_pw) {
-      if (std::ranges::find(selected_plugins_list, plugin->name) == selected_plugins_list.end()) {
-        util::debug("disconnecting the " + plugin->name + " filter from PipeWire");
+    // the plugins that are not in the list anymore go to the instance pool below. They stay connected there
 
-        plugin->disconnect_from_pw();
-      }
+    const auto pooled = std::ranges::find(list, plugin->name) == list.end();
+
+    if (plugin->connected_to_pw && bypass && !pooled) {
+      util::debug("disconnecting the " + plugin->name + " filter from PipeWire");
+
+      plugin->disconnect_from_pw();
     }
   }
 
-  for (const auto& link : pm->list_links) {
-    if (link.input_node_id == spectrum->get_node_id() || link.output_node_id == spectrum->get_node_id() ||
-        link.input_node_id == output_level->get_node_id() || link.output_node_id == output_level->get_node_id()) {
-      link_id_list.insert(link.id);
+  insert_node_links(link_id_list, spectrum->get_node_id());
+  insert_node_links(link_id_list, output_level->get_node_id());
+
+  for (const auto& chain : fused_chains) {
+    if (chain->connected_to_pw) {
+      insert_node_links(link_id_list, chain->get_node_id());
     }
   }
 
@@ -342,11 +310,11 @@ void StreamInputEffects::disconnect_filters() {
     pm->destroy_object(static_cast<int>(id));
   }
 
-  pm->destroy_links(list_proxies);
+  unlink_chain();
 
-  list_proxies.clear();
+  // the plugins removed from the list are deactivated and kept connected in the instance pool
 
-  // remove_unused_filters();
+  release_unused_plugins();
 }
 
 void StreamInputEffects::set_bypass(const bool& state) {
@@ -357,6 +325,18 @@ void StreamInputEffects::set_bypass(const bool& state) {
   connect_filters(state);
 }
 
+void StreamInputEffects::update_chain() {
+  if (bypass || chain_links.empty()) {
+    set_bypass(false);
+
+    return;
+  }
+
+  connect_filters();
+
+  release_unused_plugins();
+}
+
 void StreamInputEffects::set_listen_to_mic(const bool& state) {
   if (state) {
     for (const auto& link : pm->link_nodes(pm->ee_source_node.id, pm->output_device.id, false, false)) {
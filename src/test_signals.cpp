@@ -23,6 +23,26 @@ namespace {
 
 constexpr auto pi_x_2 = 2.0F * std::numbers::pi_v<float>;
 
+// one period of the maximum length sequence generated by the primitive polynomial x^14 + x^13 + x^12 + x^2 + 1
+
+auto make_probe_sequence() -> std::vector<float> {
+  constexpr uint length = (1U << TestSignals::probe_order) - 1U;
+
+  std::vector<float> sequence(length);
+
+  uint state = 1U;
+
+  for (auto& v : sequence) {
+    v = ((state & 1U) != 0U) ? TestSignals::probe_amplitude : -TestSignals::probe_amplitude;
+
+    const auto bit = ((state >> 13U) ^ (state >> 12U) ^ (state >> 11U) ^ (state >> 1U)) & 1U;
+
+    state = ((state << 1U) | bit) & length;
+  }
+
+  return sequence;
+}
+
 void on_process(void* userdata, spa_io_position* position) {
   auto* d = static_cast<TestSignals::data*>(userdata);
 
@@ -52,6 +72,31 @@ void on_process(void* userdata, spa_io_position* position) {
   std::span left_out(out_left, n_samples);
   std::span right_out(out_right, n_samples);
 
+  if (d->ts->measuring) {
+    std::ranges::fill(left_out, 0.0F);
+    std::ranges::fill(right_out, 0.0F);
+
+    // the sequence starts 200 ms after the measurement and may span several quanta
+
+    if (!d->ts->probe_sent && d->ts->measurement_frames >= rate / 5U) {
+      d->ts->probe_position = position->clock.position;
+      d->ts->probe_sent = true;
+    }
+
+    if (d->ts->probe_sent) {
+      const auto& sequence = d->ts->probe_sequence;
+
+      for (uint n = 0U; n < n_samples && d->ts->probe_index < sequence.size(); n++, d->ts->probe_index++) {
+        left_out[n] = sequence[d->ts->probe_index];
+        right_out[n] = sequence[d->ts->probe_index];
+      }
+    }
+
+    d->ts->measurement_frames += n_samples;
+
+    return;
+  }
+
   const auto phase_delta = pi_x_2 * d->ts->sine_frequency / static_cast<float>(rate);
 
   for (uint n = 0U; n < n_samples; n++) {
@@ -121,7 +166,8 @@ const struct pw_filter_events filter_events = {.state_changed = on_filter_state_
 
 }  // namespace
 
-TestSignals::TestSignals(PipeManager* pipe_manager) : pm(pipe_manager), random_generator(rd()) {
+TestSignals::TestSignals(PipeManager* pipe_manager)
+    : probe_sequence(make_probe_sequence()), pm(pipe_manager), random_generator(rd()) {
   pf_data.ts = this;
 
   const auto* filter_name = "ee_test_signals";
@@ -237,3 +283,39 @@ auto TestSignals::white_noise() -> float {
 
   return (v > 1.0F) ? 1.0F : ((v < -1.0F) ? -1.0F : v);
 }
+
+auto TestSignals::start_latency_measurement(const uint& target_node_id) -> bool {
+  if (measuring || !list_proxies.empty()) {
+    return false;
+  }
+
+  probe_sent = false;
+  probe_index = 0U;
+  measurement_frames = 0U;
+
+  measuring = true;
+
+  measurement_proxies = pm->link_nodes(node_id, target_node_id, false, false);
+
+  if (measurement_proxies.empty()) {
+    measuring = false;
+
+    return false;
+  }
+
+  return true;
+}
+
+auto TestSignals::stop_latency_measurement() -> std::optional<uint64_t> {
+  pm->destroy_links(measurement_proxies);
+
+  measurement_proxies.clear();
+
+  measuring = false;
+
+  if (!probe_sent) {
+    return std::nullopt;
+  }
+
+  return probe_position.load();
+}